@@ -26,3 +26,4 @@
 #include "emu/Macro.h"
 #include "emu/Ram.h"
 #include "emu/Rom.h"
+#include "emu/SelfProfiler.h"
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 #include "IMemory.h"
 
@@ -33,11 +34,20 @@ class Ram final
     Ram& operator=(Ram&&) = delete;
 
 public:
+    static const size_t DirtyPageSize = 4096;
+
     explicit Ram(size_t capacity);
     virtual ~Ram();
 
     void Copy(void* pOut, size_t size) const;
 
+    // Records pages written by Write() and LoadFile() after this call.
+    void EnableDirtyPageTracking();
+
+    // Returns offsets of pages written since the last ClearDirtyPages() in ascending order.
+    void GetDirtyPages(std::vector<uint64_t>* pOut) const;
+    void ClearDirtyPages();
+
     virtual size_t GetCapacity() const override;
     virtual void LoadFile(const char* path, int offset) override;
     virtual void Read(void* pOutBuffer, size_t size, uint64_t address) const override;
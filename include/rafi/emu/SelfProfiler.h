@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// Host time attribution of the emulator itself.
+// Enabled only if RAFI_EMU_SELF_PROFILE is defined; otherwise every macro below expands to nothing.
+
+#if defined(RAFI_EMU_SELF_PROFILE)
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+#include <rafi/common.h>
+
+namespace rafi { namespace emu {
+
+enum class SelfProfileCategory
+{
+    Fetch,
+    Decode,
+    Translate,
+    Bus,
+    Device,
+    Logger,
+};
+
+const int SelfProfileCategoryCount = static_cast<int>(SelfProfileCategory::Logger) + 1;
+const int SelfProfileOpCodeCount = 256;
+
+inline uint64_t ReadSelfProfileTimestamp()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+struct SelfProfileCounter
+{
+    uint64_t ticks;
+    uint64_t count;
+};
+
+extern SelfProfileCounter g_SelfProfileCategoryCounters[SelfProfileCategoryCount];
+extern SelfProfileCounter g_SelfProfileOpCodeCounters[SelfProfileOpCodeCount];
+
+// Accumulates exclusive time, i.e. time of nested scopes is attributed to the nested scopes only.
+class ScopedSelfProfileTimer final
+{
+    ScopedSelfProfileTimer(const ScopedSelfProfileTimer&) = delete;
+    ScopedSelfProfileTimer& operator=(const ScopedSelfProfileTimer&) = delete;
+
+public:
+    explicit ScopedSelfProfileTimer(SelfProfileCounter* pCounter)
+        : m_pCounter(pCounter)
+        , m_pParent(s_pCurrent)
+        , m_Start(ReadSelfProfileTimestamp())
+    {
+        s_pCurrent = this;
+    }
+
+    ~ScopedSelfProfileTimer()
+    {
+        const auto elapsed = ReadSelfProfileTimestamp() - m_Start;
+
+        m_pCounter->ticks += elapsed - m_ChildTicks;
+        m_pCounter->count++;
+
+        if (m_pParent != nullptr)
+        {
+            m_pParent->m_ChildTicks += elapsed;
+        }
+
+        s_pCurrent = m_pParent;
+    }
+
+private:
+    static ScopedSelfProfileTimer* s_pCurrent;
+
+    SelfProfileCounter* m_pCounter;
+    ScopedSelfProfileTimer* m_pParent;
+    uint64_t m_Start;
+    uint64_t m_ChildTicks {0};
+};
+
+// Time of Executor::ProcessOp is bucketed by OpCode instead of SelfProfileCategory.
+SelfProfileCounter* GetSelfProfileCounter(OpCode opCode);
+
+// Time before BeginSelfProfile() is excluded from the total time.
+void BeginSelfProfile();
+void PrintSelfProfile(uint64_t instructionCount);
+
+}}
+
+#define RAFI_EMU_SELF_PROFILE_SCOPE(category) \
+    ::rafi::emu::ScopedSelfProfileTimer _selfProfileTimer(&::rafi::emu::g_SelfProfileCategoryCounters[static_cast<int>(::rafi::emu::SelfProfileCategory::category)])
+
+#define RAFI_EMU_SELF_PROFILE_SCOPE_OP(opCode) \
+    ::rafi::emu::ScopedSelfProfileTimer _selfProfileOpTimer(::rafi::emu::GetSelfProfileCounter(opCode))
+
+#define RAFI_EMU_SELF_PROFILE_BEGIN() \
+    ::rafi::emu::BeginSelfProfile()
+
+#define RAFI_EMU_SELF_PROFILE_PRINT(instructionCount) \
+    ::rafi::emu::PrintSelfProfile(instructionCount)
+
+#else
+
+#define RAFI_EMU_SELF_PROFILE_SCOPE(category)
+#define RAFI_EMU_SELF_PROFILE_SCOPE_OP(opCode)
+#define RAFI_EMU_SELF_PROFILE_BEGIN()
+#define RAFI_EMU_SELF_PROFILE_PRINT(instructionCount)
+
+#endif
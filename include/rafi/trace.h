@@ -19,10 +19,13 @@
 #include <rafi/common.h>
 
 #include "trace/BinaryCycleBuilder.h"
+#include "trace/ColumnStore.h"
+#include "trace/CycleBatch.h"
 #include "trace/CycleTypes.h"
 #include "trace/EventTypes.h"
 #include "trace/Exception.h"
 #include "trace/GdbTraceReader.h"
+#include "trace/IBufferedTraceWriter.h"
 #include "trace/ICycle.h"
 #include "trace/ITracePrinter.h"
 #include "trace/ITraceReader.h"
@@ -30,10 +33,14 @@
 #include "trace/ILoggerTarget.h"
 #include "trace/Logger.h"
 #include "trace/LoggerConfig.h"
+#include "trace/StateDigest.h"
 #include "trace/TraceBinaryMemoryReader.h"
 #include "trace/TraceBinaryMemoryWriter.h"
 #include "trace/TraceBinaryReader.h"
 #include "trace/TraceBinaryWriter.h"
+#include "trace/TraceCompressedReader.h"
+#include "trace/TraceCompressedWriter.h"
+#include "trace/TraceIndexFile.h"
 #include "trace/TraceIndexReader.h"
 #include "trace/TraceIndexWriter.h"
 #include "trace/TraceTextReader.h"
@@ -25,12 +25,29 @@ namespace rafi { namespace trace {
 
 class BinaryCycleBuilderImpl;
 
+// Builds a cycle in the binary trace format.
+// A builder can be reused for many cycles by Reset() to avoid allocation per cycle.
+// Cycles are built in a buffer owned by the builder which grows as needed, or in a buffer given to Reset()
+// (e.g. space reserved in the output buffer of TraceIndexWriter) to avoid copying.
 class BinaryCycleBuilder final
 {
 public:
+    // Size of a node (NodeIntReg32, OpEvent, etc.) including its header in the binary trace format.
+    static constexpr size_t GetEncodedNodeSize(size_t nodeSize)
+    {
+        return sizeof(NodeHeader) + nodeSize;
+    }
+
+    BinaryCycleBuilder();
     BinaryCycleBuilder(uint32_t cycle, const XLEN& xlen, uint64_t pc);
     ~BinaryCycleBuilder();
 
+    // Discards current data and starts a new cycle in the buffer owned by the builder.
+    void Reset(uint32_t cycle, const XLEN& xlen, uint64_t pc);
+
+    // Discards current data and starts a new cycle in pBuffer. pBuffer is not grown, so throws TraceException on overflow.
+    void Reset(void* pBuffer, size_t bufferSize, uint32_t cycle, const XLEN& xlen, uint64_t pc);
+
     void Add(const NodeIntReg32& value);
     void Add(const NodeIntReg64& value);
     void Add(const NodeFpReg& value);
@@ -39,6 +56,12 @@ public:
     void Add(const TrapEvent& value);
     void Add(const MemoryEvent& value);
 
+    // Adds a delta node of registers which differ from base (i.e. registers of the previous cycle).
+    // Readers can reconstruct registers only if the previous cycle has registers, so the first cycle of a data file must have a full node.
+    void AddDelta(const NodeIntReg32& value, const NodeIntReg32& base);
+    void AddDelta(const NodeIntReg64& value, const NodeIntReg64& base);
+    void AddDelta(const NodeFpReg& value, const NodeFpReg& base);
+
     void Break();
 
     // Get pointer to raw data
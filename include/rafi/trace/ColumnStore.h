@@ -0,0 +1,177 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <rafi/common.h>
+#include <rafi/trace/CycleBatch.h>
+
+namespace rafi { namespace trace {
+
+// Layout of columnar trace store (.tcol)
+//   ColumnStoreHeader
+//   Blocks; each block has a compressed column for each ColumnId
+//   Posting lists of PC index and page index
+//   ColumnStoreIndexEntry[pcKeyCount] (sorted by key)
+//   ColumnStoreIndexEntry[pageKeyCount] (sorted by key)
+//   ColumnStoreBlockEntry[blockCount]
+//   ColumnStoreFooter
+// A row is the position of a cycle in the source trace, which is the same as the cycle given to ITraceReader::Next(cycle).
+// Posting lists of PC index are rows of cycles, and those of page index are rows of memory events.
+// A memory event which crosses a page boundary is in the posting lists of both pages.
+// A posting list is encoded as LEB128 of deltas between sorted rows.
+
+const char ColumnStoreMagic[8] = { 'R', 'A', 'F', 'I', 'T', 'C', 'L', '\0' };
+const uint32_t ColumnStoreVersion = 2;
+const uint32_t DefaultColumnStoreBlockCycleCount = 64 * 1024;
+const int ColumnStorePageShift = 12;
+
+enum ColumnId
+{
+    ColumnId_Cycle = 0,
+    ColumnId_Pc = 1, // Encoded as deltas from the previous pc in the block.
+    ColumnId_Insn = 2,
+    ColumnId_Priv = 3,
+    ColumnId_HostIo = 4,
+    ColumnId_Flags = 5, // CycleBatchFlag_*
+    ColumnId_MemCycleIndex = 6,
+    ColumnId_MemAccessType = 7,
+    ColumnId_MemSize = 8,
+    ColumnId_MemValue = 9,
+    ColumnId_MemVaddr = 10,
+    ColumnId_MemPaddr = 11,
+    ColumnId_Count = 12,
+};
+
+const uint32_t ColumnMask_All = (1u << ColumnId_Count) - 1;
+
+inline uint32_t GetColumnMask(ColumnId id)
+{
+    return 1u << id;
+}
+
+struct ColumnStoreHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t blockCycleCount;
+};
+
+struct ColumnStoreColumnEntry
+{
+    uint64_t offset;
+    uint32_t compressedSize;
+    uint32_t rawSize;
+};
+
+struct ColumnStoreBlockEntry
+{
+    uint64_t firstRow;
+    uint64_t firstMemoryEventRow;
+    uint32_t cycleCount;
+    uint32_t memoryEventCount;
+
+    // Zone maps. paddrMin and paddrMax are valid only if memoryEventCount > 0.
+    // paddrMax is the last byte accessed, so that accesses overlapping a range are not skipped.
+    uint64_t pcMin;
+    uint64_t pcMax;
+    uint64_t paddrMin;
+    uint64_t paddrMax;
+
+    ColumnStoreColumnEntry columns[ColumnId_Count];
+};
+
+struct ColumnStoreIndexEntry
+{
+    uint64_t key;
+    uint64_t offset;
+    uint32_t rowCount;
+    uint32_t size;
+};
+
+struct ColumnStoreFooter
+{
+    uint64_t rowCount;
+    uint64_t memoryEventRowCount;
+    uint64_t pcIndexOffset;
+    uint64_t pcKeyCount;
+    uint64_t pageIndexOffset;
+    uint64_t pageKeyCount;
+    uint64_t blockOffset;
+    uint64_t blockCount;
+    char magic[8];
+};
+
+class ColumnStoreWriterImpl;
+class ColumnStoreReaderImpl;
+
+// Converts cycle batches into columnar trace store. Indexes are kept in memory and written by Close().
+// On failure the incomplete store is removed. Destruction without Close() closes the store and prints errors.
+class ColumnStoreWriter final
+{
+    ColumnStoreWriter(const ColumnStoreWriter&) = delete;
+    ColumnStoreWriter& operator=(const ColumnStoreWriter&) = delete;
+
+public:
+    ColumnStoreWriter(const char* path, uint32_t blockCycleCount = DefaultColumnStoreBlockCycleCount);
+    ~ColumnStoreWriter();
+
+    void Write(const CycleBatch& batch);
+
+    // Writes indexes and footer. Throws TraceException if the store is not written completely.
+    void Close();
+
+private:
+    ColumnStoreWriterImpl* m_pImpl;
+};
+
+class ColumnStoreReader final
+{
+    ColumnStoreReader(const ColumnStoreReader&) = delete;
+    ColumnStoreReader& operator=(const ColumnStoreReader&) = delete;
+
+public:
+    explicit ColumnStoreReader(const char* path);
+    ~ColumnStoreReader();
+
+    uint64_t GetRowCount() const;
+    uint64_t GetMemoryEventRowCount() const;
+
+    size_t GetBlockCount() const;
+    const ColumnStoreBlockEntry& GetBlock(size_t index) const;
+
+    // Returns index of the block which contains the row (or the memory event row).
+    size_t FindBlock(uint64_t row) const;
+    size_t FindBlockByMemoryEventRow(uint64_t memoryEventRow) const;
+
+    // Decompresses columns specified by columnMask into pOutBatch. Columns not specified are left empty.
+    void ReadBlock(CycleBatch* pOutBatch, size_t index, uint32_t columnMask = ColumnMask_All) const;
+
+    // Appends rows of cycles whose pc is the specified value. Rows are in ascending order.
+    void FindPc(std::vector<uint64_t>* pOutRows, uint64_t pc) const;
+
+    // Appends rows of memory events which access the physical page (paddr >> ColumnStorePageShift). Rows are in ascending order.
+    void FindPage(std::vector<uint64_t>* pOutMemoryEventRows, uint64_t page) const;
+
+private:
+    ColumnStoreReaderImpl* m_pImpl;
+};
+
+}}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <rafi/common.h>
+
+#include <rafi/trace/CycleTypes.h>
+#include <rafi/trace/EventTypes.h>
+
+namespace rafi { namespace trace {
+
+const uint8_t CycleBatchFlag_Op = 0x01;
+const uint8_t CycleBatchFlag_Trap = 0x02;
+const uint8_t CycleBatchFlag_IntReg = 0x04;
+const uint8_t CycleBatchFlag_FpReg = 0x08;
+const uint8_t CycleBatchFlag_Io = 0x10;
+
+// Struct-of-arrays buffer of consecutive cycles, which is filled by ITraceReader::ReadBatch().
+// Columns are reused across batches by Clear(), which keeps their capacity.
+struct CycleBatch
+{
+    // Per cycle columns. insn and priv are of the first op event and valid only if CycleBatchFlag_Op is set.
+    // hostIo is valid only if CycleBatchFlag_Io is set.
+    std::vector<uint32_t> cycle;
+    std::vector<uint64_t> pc;
+    std::vector<uint32_t> insn;
+    std::vector<PrivilegeLevel> priv;
+    std::vector<uint32_t> hostIo;
+    std::vector<uint8_t> flags;
+
+    // Per memory event columns. memCycleIndex is index of the cycle in this batch.
+    std::vector<uint32_t> memCycleIndex;
+    std::vector<MemoryAccessType> memAccessType;
+    std::vector<uint32_t> memSize;
+    std::vector<uint64_t> memValue;
+    std::vector<uint64_t> memVaddr;
+    std::vector<uint64_t> memPaddr;
+
+    size_t GetCycleCount() const
+    {
+        return cycle.size();
+    }
+
+    size_t GetMemoryEventCount() const
+    {
+        return memCycleIndex.size();
+    }
+
+    void Clear();
+
+    // Appends a cycle. Returns index of the cycle in this batch.
+    size_t AddCycle(uint32_t cycleValue, uint64_t pcValue);
+    void SetOp(size_t index, const OpEvent& event);
+    void SetIo(size_t index, const NodeIo& io);
+    void SetFlag(size_t index, uint8_t flag);
+    void AddMemoryEvent(size_t index, const MemoryEvent& event);
+};
+
+}}
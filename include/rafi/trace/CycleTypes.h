@@ -31,6 +31,8 @@ const uint16_t NodeId_IO = 0x4f49; // IO
 const uint16_t NodeId_OP = 0x504f; // OP
 const uint16_t NodeId_TR = 0x5254; // TRAP
 const uint16_t NodeId_MA = 0x414d; // MA
+const uint16_t NodeId_ID = 0x4449; // INT DELTA
+const uint16_t NodeId_FD = 0x4446; // FP DELTA
 
 union FpRegUnion
 {
@@ -84,4 +86,13 @@ struct NodeIo
     uint32_t reserved;
 };
 
+// Header of INT DELTA and FP DELTA nodes, which hold only registers changed from the previous cycle.
+// Followed by values of registers whose bit is set in mask, in ascending order of register index.
+// Each value is 4 bytes for INT DELTA of XLEN32, and 8 bytes otherwise.
+struct NodeRegDelta
+{
+    uint32_t mask;
+    uint32_t reserved;
+};
+
 }}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <rafi/common.h>
+
+#include "ITraceWriter.h"
+
+namespace rafi { namespace trace {
+
+// ITraceWriter which lets callers build cycles in place in its write buffer.
+// Output is split into segments (e.g. data files, compressed blocks) which readers decode independently of each other.
+class IBufferedTraceWriter : public ITraceWriter
+{
+public:
+    virtual ~IBufferedTraceWriter(){}
+
+    // Returns space for a cycle of at most size bytes in the write buffer, which is valid until Commit().
+    // The cycle is built in place and then committed with its actual size, which saves a copy compared to Write().
+    virtual void* Reserve(size_t size) = 0;
+    virtual void Commit(size_t size) = 0;
+
+    // Returns true if no cycle is committed to current segment, i.e. a cycle reserved now is the first one of a segment.
+    virtual bool IsSegmentEmpty() const = 0;
+};
+
+}}
@@ -49,6 +49,23 @@ public:
     virtual void CopyOpEvent(OpEvent* pOutEvent, size_t index) const = 0;
     virtual void CopyMemoryEvent(MemoryEvent* pOutEvent, size_t index) const = 0;
     virtual void CopyTrapEvent(TrapEvent* pOutEvent, size_t index) const = 0;
+
+    // Copy all registers at once. Implementations which hold registers in an array override these with memcpy.
+    virtual void CopyIntRegs(uint64_t* pOutRegs) const
+    {
+        for (int i = 0; i < IntRegCount; i++)
+        {
+            pOutRegs[i] = GetIntReg(i);
+        }
+    }
+
+    virtual void CopyFpRegs(uint64_t* pOutRegs) const
+    {
+        for (int i = 0; i < FpRegCount; i++)
+        {
+            pOutRegs[i] = GetFpReg(i);
+        }
+    }
 };
 
 }}
@@ -20,6 +20,7 @@
 
 #include <rafi/common.h>
 
+#include <rafi/trace/CycleBatch.h>
 #include <rafi/trace/ICycle.h>
 
 namespace rafi { namespace trace {
@@ -35,6 +36,10 @@ public:
 
     virtual void Next() = 0;
     virtual void Next(uint32_t cycle) = 0;
+
+    // Appends up to maxCycleCount cycles from the current one to pBatch, and moves past them.
+    // Returns the number of cycles appended, which is less than maxCycleCount only at the end of trace.
+    virtual size_t ReadBatch(CycleBatch* pBatch, size_t maxCycleCount);
 };
 
 }}
@@ -16,10 +16,14 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 namespace rafi { namespace trace {
 
+const size_t DefaultLoggerBufferSize = 64 * 1024 * 1024;
+const int DefaultLoggerKeyframeInterval = 1024;
+
 struct LoggerConfig
 {
     bool enabled;
@@ -27,6 +31,16 @@ struct LoggerConfig
     bool enableDumpIntReg;
     bool enableDumpHostIo;
     std::string path;
+
+    // Upper bound of memory used by the logging pipeline (ring of pending cycles and file write buffers).
+    size_t bufferSize {DefaultLoggerBufferSize};
+
+    // Output only changed registers, with full registers every keyframeInterval cycles and at the beginning of segments (data files or compressed blocks).
+    bool enableRegDelta {false};
+    int keyframeInterval {DefaultLoggerKeyframeInterval};
+
+    // Output compressed trace (<path>.tcz) instead of index (<path>.tidx) and data files (<path>.<n>.tbin).
+    bool enableCompression {false};
 };
 
 }}
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <rafi/common.h>
+#include <rafi/trace/ILoggerTarget.h>
+
+namespace rafi { namespace trace {
+
+// Layout of state digest file (.tdig)
+//   StateDigestHeader
+//   StateDigestEntry (until end of file)
+// An entry is recorded at the beginning of cycle 0, interval, 2 * interval, ... and at the end of run.
+// Entries are written one by one, so that the file of a run which stopped abnormally is still readable.
+
+const char StateDigestMagic[8] = { 'R', 'A', 'F', 'I', 'T', 'D', 'G', '\0' };
+const uint32_t StateDigestVersion = 1;
+const uint32_t DefaultStateDigestInterval = 64 * 1024;
+
+struct StateDigestHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t interval;
+};
+
+struct StateDigestEntry
+{
+    uint64_t cycle;
+    uint64_t digest;
+};
+
+// 64-bit hash of pc, int and fp registers, and a running hash of memory pages written so far.
+class StateDigest final
+{
+public:
+    // Folds contents of a page which is written since the last digest into the running hash of memory.
+    // Pages must be given in the same order on both sides (e.g. in ascending order of address).
+    void UpdateMemory(uint64_t address, const void* pPage, size_t size);
+
+    uint64_t Compute(XLEN xlen, const ILoggerTarget& target) const;
+
+private:
+    uint64_t m_MemoryHash {0};
+};
+
+class StateDigestWriter final
+{
+    StateDigestWriter(const StateDigestWriter&) = delete;
+    StateDigestWriter& operator=(const StateDigestWriter&) = delete;
+
+public:
+    StateDigestWriter(const char* path, uint32_t interval);
+    ~StateDigestWriter();
+
+    void Write(uint64_t cycle, uint64_t digest);
+
+private:
+    std::FILE* m_pFile;
+};
+
+class StateDigestReader final
+{
+public:
+    explicit StateDigestReader(const char* path);
+
+    uint32_t GetInterval() const;
+    size_t GetCount() const;
+    const StateDigestEntry& Get(size_t index) const;
+
+private:
+    uint32_t m_Interval {0};
+    std::vector<StateDigestEntry> m_Entries;
+};
+
+}}
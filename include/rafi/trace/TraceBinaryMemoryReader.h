@@ -39,6 +39,12 @@ public:
     virtual void Next();
     virtual void Next(uint32_t cycle);
 
+    virtual size_t ReadBatch(CycleBatch* pBatch, size_t maxCycleCount);
+
+    // Moves to the cycle which begins at offset bytes from the beginning of buffer.
+    // The cycle must not have delta nodes, which can not be decoded without the previous cycle.
+    void MoveToOffset(size_t offset);
+
 private:
     TraceBinaryMemoryReaderImpl* m_pImpl;
 };
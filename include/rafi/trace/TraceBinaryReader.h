@@ -38,6 +38,11 @@ public:
     virtual void Next();
     virtual void Next(uint32_t cycle);
 
+    virtual size_t ReadBatch(CycleBatch* pBatch, size_t maxCycleCount);
+
+    // See TraceBinaryMemoryReader::MoveToOffset().
+    void MoveToOffset(size_t offset);
+
 private:
     TraceBinaryReaderImpl* m_pImpl;
 };
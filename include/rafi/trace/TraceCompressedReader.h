@@ -0,0 +1,48 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <rafi/common.h>
+
+#include "ITraceReader.h"
+
+namespace rafi { namespace trace {
+
+class TraceCompressedReaderImpl;
+
+// Reads compressed trace file (.tcz). Blocks following the current one are decompressed ahead by worker threads.
+// Next(cycle) jumps to the block which contains the target cycle by the block index.
+class TraceCompressedReader : public ITraceReader
+{
+public:
+    TraceCompressedReader(const char* path);
+    virtual ~TraceCompressedReader();
+
+    virtual const ICycle* GetCycle() const;
+
+    virtual bool IsEnd() const;
+
+    virtual void Next();
+    virtual void Next(uint32_t cycle);
+
+    virtual size_t ReadBatch(CycleBatch* pBatch, size_t maxCycleCount);
+
+private:
+    TraceCompressedReaderImpl* m_pImpl;
+};
+
+}}
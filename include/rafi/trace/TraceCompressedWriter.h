@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <rafi/common.h>
+
+#include "IBufferedTraceWriter.h"
+
+namespace rafi { namespace trace {
+
+class TraceCompressedWriterImpl;
+
+// Writes compressed trace file (.tcz), which consists of independently compressed blocks of cycles and a block index.
+// Blocks are compressed by worker threads while the next block is being filled.
+// Memory usage is bounded by about (threadCount + 1) x 2 x blockSize.
+class TraceCompressedWriter : public IBufferedTraceWriter
+{
+public:
+    static constexpr size_t DefaultBlockSize = 1024 * 1024;
+
+    TraceCompressedWriter(const char* path);
+    TraceCompressedWriter(const char* path, size_t blockSize, int threadCount);
+    virtual ~TraceCompressedWriter();
+
+    virtual void Write(void* buffer, int64_t size);
+
+    // Segments of TraceCompressedWriter are compressed blocks.
+    virtual void* Reserve(size_t size);
+    virtual void Commit(size_t size);
+    virtual bool IsSegmentEmpty() const;
+
+private:
+    TraceCompressedWriterImpl* m_pImpl;
+};
+
+}}
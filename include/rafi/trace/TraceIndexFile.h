@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <rafi/common.h>
+
+namespace rafi { namespace trace {
+
+// Line of index file (.tidx) for a data file (.tbin)
+//   <path> <cycle count> op=<n> trap=<n> mem=<n> cycle=<first>-<last> pc=<min>-<max> [paddr=<min>-<max>] [io=<value>]
+// Numbers in ranges and io are hexadecimal. Fields after the cycle count are the summary of the data file,
+// which is written when the data file is closed. Index files written by older versions have no summary.
+
+// cycle range is the positions of the first and last cycles of the data file in the whole trace, counted from 0.
+// paddr range covers all bytes accessed by memory events, and is valid only if memoryEventCount > 0.
+// hostIo is the value of the last io node in the data file, and is valid only if hasHostIo is true.
+struct TraceFileSummary
+{
+    uint64_t firstCycle{ 0 };
+    uint64_t lastCycle{ 0 };
+    uint64_t opCount{ 0 };
+    uint64_t trapCount{ 0 };
+    uint64_t memoryEventCount{ 0 };
+    uint64_t pcMin{ UINT64_MAX };
+    uint64_t pcMax{ 0 };
+    uint64_t paddrMin{ UINT64_MAX };
+    uint64_t paddrMax{ 0 };
+    uint32_t hostIo{ 0 };
+    bool hasHostIo{ false };
+};
+
+struct TraceIndexEntry
+{
+    std::string path;
+    uint64_t cycleCount{ 0 };
+    bool hasSummary{ false };
+    TraceFileSummary summary;
+};
+
+std::vector<TraceIndexEntry> ReadTraceIndexFile(const char* path);
+void WriteTraceIndexEntry(std::FILE* pFile, const TraceIndexEntry& entry);
+
+}}
@@ -25,10 +25,15 @@ namespace rafi { namespace trace {
 
 class TraceIndexReaderImpl;
 
+// Data files following the current one are opened ahead by worker threads, up to prefetchDepth files.
+// Prefetch is disabled if prefetchDepth is 0.
 class TraceIndexReader : public ITraceReader
 {
 public:
+    static const int DefaultPrefetchDepth = 1;
+
     TraceIndexReader(const char* path);
+    TraceIndexReader(const char* path, int prefetchDepth);
     virtual ~TraceIndexReader();
 
     virtual const ICycle* GetCycle() const;
@@ -38,6 +43,8 @@ public:
     virtual void Next();
     virtual void Next(uint32_t cycle);
 
+    virtual size_t ReadBatch(CycleBatch* pBatch, size_t maxCycleCount);
+
 private:
     TraceIndexReaderImpl* m_pImpl;
 };
@@ -18,20 +18,30 @@
 
 #include <rafi/common.h>
 
-#include "ITraceWriter.h"
+#include "IBufferedTraceWriter.h"
 
 namespace rafi { namespace trace {
 
 class TraceIndexWriterImpl;
 
-class TraceIndexWriter : public ITraceWriter
+// Data files are written by a background thread while the next chunk of cycles is being filled.
+// bufferSize is the total size of the two chunk buffers, which bounds memory usage of the writer.
+class TraceIndexWriter : public IBufferedTraceWriter
 {
 public:
+    static const size_t DefaultBufferSize = 32 * 1024 * 1024;
+
     TraceIndexWriter(const char* pathBase);
+    TraceIndexWriter(const char* pathBase, size_t bufferSize);
     virtual ~TraceIndexWriter();
 
     virtual void Write(void* buffer, int64_t size);
 
+    // Segments of TraceIndexWriter are data files.
+    virtual void* Reserve(size_t size);
+    virtual void Commit(size_t size);
+    virtual bool IsSegmentEmpty() const;
+
 private:
     TraceIndexWriterImpl* m_pImpl;
 };
@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <rafi/trace.h>
 
@@ -33,4 +35,22 @@ enum class PrinterType
 std::unique_ptr<trace::ITraceReader> MakeTraceReader(const std::string& path);
 std::unique_ptr<trace::ITracePrinter> MakeTracePrinter(PrinterType printerType, XLEN xlen);
 
+// Returns true if path is an index trace (.tidx), which consists of data files listed in the index file.
+bool IsTraceIndexPath(const std::string& path);
+
+// Builds seek index of an index trace if it does not exist yet.
+// Readers opened on worker threads after this seek without building the index by themselves.
+void EnsureSeekIndex(const std::string& path);
+
+struct CycleRange
+{
+    uint64_t begin;
+    uint64_t end;
+};
+
+// Splits [begin, end) into ranges of at most maxCycleCount cycles which do not cross any of boundaries,
+// so that ranges processed in parallel are balanced and each of them is in a single data file.
+// Boundaries must be in ascending order.
+std::vector<CycleRange> SplitCycleRange(uint64_t begin, uint64_t end, const std::vector<uint64_t>& boundaries, uint64_t maxCycleCount);
+
 }}
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rafi/emu.h>
+
+#include "ProgramBuilder.h"
+#include "Workload.h"
+
+namespace rafi { namespace bench {
+
+namespace {
+
+// Memory map of generated kernels
+const paddr_t CodeAddress = 0x80000000;
+const paddr_t DataAddress = 0x80010000;
+const paddr_t HostIoAddress = 0x80080000;
+const paddr_t PageTableAddress = 0x80100000;
+const paddr_t PageAddress = 0x80200000;
+
+// Virtual address of the 4KB pages mapped by MakePageTableKernel()
+const uint64_t PageVirtualAddress = 0x40000000;
+const int PageCount = 512;
+const int PageSize = 4096;
+
+// Upper bound of cycles; every kernel stops by host io far before this.
+const int MaxCycle = 200 * 1000 * 1000;
+
+const int IntegerKernelIteration = 10000;
+const int PageTableKernelIteration = 1000;
+const int FpKernelIteration = 200000;
+
+const int ListNodeCount = 32;
+const int ListNodeSize = 16;
+const int32_t ListOffset = 0x100;
+const int32_t StringDestinationOffset = 0x80;
+
+// PTE flags
+const uint64_t PteV = 1 << 0;
+const uint64_t PteR = 1 << 1;
+const uint64_t PteW = 1 << 2;
+const uint64_t PteX = 1 << 3;
+const uint64_t PteA = 1 << 6;
+const uint64_t PteD = 1 << 7;
+
+const uint64_t SatpModeSv39 = 8;
+
+const uint64_t MstatusMppSupervisor = 1 << 11;
+const uint64_t MstatusFsInitial = 1 << 13;
+
+void StoreUInt64(std::vector<uint8_t>* pOut, size_t offset, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        (*pOut)[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+MemoryImage MakeCodeImage(ProgramBuilder* pBuilder)
+{
+    const auto& code = pBuilder->GetCode();
+
+    MemoryImage image { CodeAddress, std::vector<uint8_t>(code.size() * 4) };
+
+    for (size_t i = 0; i < code.size(); i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            image.data[i * 4 + j] = static_cast<uint8_t>(code[i] >> (j * 8));
+        }
+    }
+
+    return image;
+}
+
+std::vector<std::string> MakeArguments()
+{
+    return std::vector<std::string> {
+        "--cycle", std::to_string(MaxCycle),
+        "--xlen", "64",
+        "--pc", "80000000",
+        "--host-io-addr", "80080000",
+    };
+}
+
+void EmitExit(ProgramBuilder* pBuilder)
+{
+    auto& b = *pBuilder;
+
+    b.Li(IntReg::t0, HostIoAddress);
+    b.Addi(IntReg::t1, IntReg::zero, 1);
+    b.Sw(IntReg::t1, IntReg::t0, 0);
+
+    const auto halt = b.MakeLabel();
+    b.Bind(halt);
+    b.J(halt);
+}
+
+}
+
+// Dhrystone-like mix of string copy, integer multiply / divide and pointer chasing over a linked list.
+GuestRun MakeIntegerKernel()
+{
+    ProgramBuilder b;
+
+    const auto loop = b.MakeLabel();
+    const auto strcpy = b.MakeLabel();
+    const auto arith = b.MakeLabel();
+    const auto sumList = b.MakeLabel();
+
+    b.Li(IntReg::s0, DataAddress);
+    b.Li(IntReg::s1, 0);
+    b.Li(IntReg::s2, IntegerKernelIteration);
+
+    b.Bind(loop);
+    b.Addi(IntReg::a0, IntReg::s0, StringDestinationOffset);
+    b.Addi(IntReg::a1, IntReg::s0, 0);
+    b.Call(strcpy);
+    b.Add(IntReg::s1, IntReg::s1, IntReg::a0);
+    b.Addi(IntReg::a0, IntReg::s2, 0);
+    b.Call(arith);
+    b.Xor(IntReg::s1, IntReg::s1, IntReg::a0);
+    b.Addi(IntReg::a0, IntReg::s0, ListOffset);
+    b.Call(sumList);
+    b.Add(IntReg::s1, IntReg::s1, IntReg::a0);
+    b.Addi(IntReg::s2, IntReg::s2, -1);
+    b.Bne(IntReg::s2, IntReg::zero, loop);
+    EmitExit(&b);
+
+    // a0 = strcpy(a0 = dst, a1 = src) returns length including terminator
+    const auto copy = b.MakeLabel();
+    b.Bind(strcpy);
+    b.Addi(IntReg::a2, IntReg::a0, 0);
+    b.Bind(copy);
+    b.Lbu(IntReg::t0, IntReg::a1, 0);
+    b.Sb(IntReg::t0, IntReg::a2, 0);
+    b.Addi(IntReg::a1, IntReg::a1, 1);
+    b.Addi(IntReg::a2, IntReg::a2, 1);
+    b.Bne(IntReg::t0, IntReg::zero, copy);
+    b.Sub(IntReg::a0, IntReg::a2, IntReg::a0);
+    b.Ret();
+
+    // a0 = arith(a0 = n)
+    b.Bind(arith);
+    b.Addi(IntReg::t1, IntReg::zero, 7);
+    b.Mul(IntReg::t0, IntReg::a0, IntReg::a0);
+    b.Ori(IntReg::t0, IntReg::t0, 1);
+    b.Div(IntReg::t2, IntReg::t0, IntReg::t1);
+    b.Rem(IntReg::t3, IntReg::t0, IntReg::t1);
+    b.Xor(IntReg::a0, IntReg::t2, IntReg::t3);
+    b.Ret();
+
+    // a0 = sumList(a0 = head)
+    const auto walk = b.MakeLabel();
+    b.Bind(sumList);
+    b.Addi(IntReg::t0, IntReg::zero, 0);
+    b.Bind(walk);
+    b.Ld(IntReg::t1, IntReg::a0, 8);
+    b.Add(IntReg::t0, IntReg::t0, IntReg::t1);
+    b.Ld(IntReg::a0, IntReg::a0, 0);
+    b.Bne(IntReg::a0, IntReg::zero, walk);
+    b.Addi(IntReg::a0, IntReg::t0, 0);
+    b.Ret();
+
+    // Data: source string and linked list whose nodes are scattered by a fixed permutation.
+    std::vector<uint8_t> data(ListOffset + ListNodeCount * ListNodeSize);
+
+    const std::string str = "DHRYSTONE PROGRAM, SOME STRING";
+    std::copy(str.begin(), str.end(), data.begin());
+
+    int slots[ListNodeCount];
+    for (int i = 0; i < ListNodeCount; i++)
+    {
+        // 13 is coprime to ListNodeCount.
+        slots[i] = (i * 13) % ListNodeCount;
+    }
+    for (int i = 0; i < ListNodeCount; i++)
+    {
+        const size_t offset = ListOffset + slots[i] * ListNodeSize;
+        const uint64_t next = i + 1 < ListNodeCount
+            ? DataAddress + ListOffset + slots[i + 1] * ListNodeSize
+            : 0;
+
+        StoreUInt64(&data, offset, next);
+        StoreUInt64(&data, offset + 8, i * 3 + 1);
+    }
+
+    // Head of the list must be at ListOffset.
+    assert(slots[0] == 0);
+
+    return GuestRun { MakeArguments(), { MakeCodeImage(&b), MemoryImage { DataAddress, data } } };
+}
+
+// Sv39 stress which touches a different 4KB page on every load / store.
+// Code and data are mapped by an identity gigapage, and the pages are mapped by 4KB leaf PTEs.
+GuestRun MakePageTableKernel()
+{
+    ProgramBuilder b;
+
+    const auto outer = b.MakeLabel();
+    const auto inner = b.MakeLabel();
+
+    // Machine mode: enable Sv39 and enter supervisor mode.
+    b.Li(IntReg::t0, (SatpModeSv39 << 60) | (PageTableAddress >> 12));
+    b.Csrw(csr_addr_t::satp, IntReg::t0);
+    b.Li(IntReg::t0, MstatusMppSupervisor);
+    b.Csrs(csr_addr_t::mstatus, IntReg::t0);
+    b.Auipc(IntReg::t0, 0);
+    b.Addi(IntReg::t0, IntReg::t0, 16);
+    b.Csrw(csr_addr_t::mepc, IntReg::t0);
+    b.Mret();
+
+    // Supervisor mode (mepc points here)
+    b.Li(IntReg::s2, PageTableKernelIteration);
+    b.Li(IntReg::a2, PageSize);
+    b.Bind(outer);
+    b.Li(IntReg::a0, PageVirtualAddress);
+    b.Li(IntReg::a1, PageCount);
+    b.Bind(inner);
+    b.Ld(IntReg::t0, IntReg::a0, 0);
+    b.Addi(IntReg::t0, IntReg::t0, 1);
+    b.Sd(IntReg::t0, IntReg::a0, 0);
+    b.Add(IntReg::a0, IntReg::a0, IntReg::a2);
+    b.Addi(IntReg::a1, IntReg::a1, -1);
+    b.Bne(IntReg::a1, IntReg::zero, inner);
+    b.Addi(IntReg::s2, IntReg::s2, -1);
+    b.Bne(IntReg::s2, IntReg::zero, outer);
+    EmitExit(&b);
+
+    // Page tables: root, level 1 and level 0
+    std::vector<uint8_t> tables(PageSize * 3);
+
+    const auto makePte = [](paddr_t address, uint64_t flags)
+    {
+        return ((address >> 12) << 10) | flags;
+    };
+
+    StoreUInt64(&tables, (CodeAddress >> 30) * 8, makePte(CodeAddress, PteV | PteR | PteW | PteX | PteA | PteD));
+    StoreUInt64(&tables, (PageVirtualAddress >> 30) * 8, makePte(PageTableAddress + PageSize, PteV));
+    StoreUInt64(&tables, PageSize, makePte(PageTableAddress + PageSize * 2, PteV));
+
+    for (int i = 0; i < PageCount; i++)
+    {
+        StoreUInt64(&tables, PageSize * 2 + i * 8, makePte(PageAddress + i * PageSize, PteV | PteR | PteW | PteA | PteD));
+    }
+
+    return GuestRun { MakeArguments(), { MakeCodeImage(&b), MemoryImage { PageTableAddress, tables } } };
+}
+
+// Double precision kernel of fused multiply-add, division, square root and fp load / store.
+GuestRun MakeFpKernel()
+{
+    ProgramBuilder b;
+
+    const auto loop = b.MakeLabel();
+
+    b.Li(IntReg::t0, MstatusFsInitial);
+    b.Csrs(csr_addr_t::mstatus, IntReg::t0);
+
+    // fa0 = 3.0, fa1 = 1.0, fa2 = 2.0, fa3 = 0.5, fa4 = 1.0, fa5 = 0.0
+    b.Li(IntReg::t0, 3);
+    b.FcvtDL(FpReg::fa0, IntReg::t0);
+    b.Li(IntReg::t0, 1);
+    b.FcvtDL(FpReg::fa1, IntReg::t0);
+    b.Li(IntReg::t0, 2);
+    b.FcvtDL(FpReg::fa2, IntReg::t0);
+    b.FdivD(FpReg::fa3, FpReg::fa1, FpReg::fa2);
+    b.FcvtDL(FpReg::fa4, IntReg::zero);
+    b.FaddD(FpReg::fa4, FpReg::fa4, FpReg::fa1);
+    b.FcvtDL(FpReg::fa5, IntReg::zero);
+
+    b.Li(IntReg::s0, DataAddress);
+    b.Li(IntReg::s2, FpKernelIteration);
+
+    b.Bind(loop);
+    b.FmaddD(FpReg::fa4, FpReg::fa4, FpReg::fa3, FpReg::fa1);
+    b.FdivD(FpReg::ft0, FpReg::fa0, FpReg::fa4);
+    b.FsqrtD(FpReg::ft1, FpReg::ft0);
+    b.FaddD(FpReg::ft2, FpReg::ft1, FpReg::fa4);
+    b.FmulD(FpReg::ft3, FpReg::ft2, FpReg::fa3);
+    b.Fsd(FpReg::ft3, IntReg::s0, 0);
+    b.Fld(FpReg::ft4, IntReg::s0, 0);
+    b.FaddD(FpReg::fa5, FpReg::fa5, FpReg::ft4);
+    b.Addi(IntReg::s2, IntReg::s2, -1);
+    b.Bne(IntReg::s2, IntReg::zero, loop);
+    EmitExit(&b);
+
+    return GuestRun { MakeArguments(), { MakeCodeImage(&b) } };
+}
+
+}}
@@ -0,0 +1,387 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <boost/program_options.hpp>
+
+#include <rafi/emu.h>
+
+#include "../rafi-emu/CommandLineOption.h"
+#include "../rafi-emu/Emulator.h"
+
+#include "Workload.h"
+
+namespace po = boost::program_options;
+
+namespace rafi { namespace bench {
+
+namespace {
+
+const int DefaultRepeat = 5;
+const int DefaultWarmup = 1;
+const int DefaultLinuxCycle = 5 * 1000 * 1000;
+
+// Value written to host io by riscv-tests and kernels on success, the same as rafi-check-io expects.
+const uint32_t ExpectedHostIoValue = 1;
+
+struct Measurement
+{
+    uint64_t instructions;
+    uint64_t nanoseconds;
+};
+
+struct Result
+{
+    std::string name;
+    std::string skipReason;
+    std::string error;
+    std::vector<Measurement> measurements;
+};
+
+// Peak resident set size of this process in bytes
+uint64_t GetPeakRss()
+{
+#if defined(WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    // ru_maxrss is KiB on Linux.
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+// Returns false if the guest stops by host io with a value other than ExpectedHostIoValue or does not stop by host io.
+bool Run(Measurement* pOutMeasurement, std::string* pOutError, const GuestRun& run)
+{
+    std::vector<std::string> arguments { "rafi-emu" };
+    arguments.insert(arguments.end(), run.arguments.begin(), run.arguments.end());
+
+    std::vector<char*> argv;
+    for (auto& argument: arguments)
+    {
+        argv.push_back(&argument[0]);
+    }
+    argv.push_back(nullptr);
+
+    emu::CommandLineOption option(static_cast<int>(arguments.size()), argv.data());
+    emu::Emulator emulator(option);
+
+    for (const auto& image: run.images)
+    {
+        emulator.WriteMemory(image.data.data(), image.data.size(), image.address);
+    }
+
+    const auto condition = option.IsHostIoEnabled()
+        ? emu::EmulationStop_HostIo
+        : emu::EmulationStop_None;
+
+    // Only the emulation loop is measured; construction of System and loading images are excluded.
+    const auto begin = std::chrono::steady_clock::now();
+    emulator.Process(condition, option.GetCycle());
+    const auto end = std::chrono::steady_clock::now();
+
+    *pOutMeasurement = Measurement {
+        static_cast<uint64_t>(emulator.GetCycle()),
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()),
+    };
+
+    if (option.IsHostIoEnabled() && emulator.GetHostIoValue() != ExpectedHostIoValue)
+    {
+        char buffer[64];
+
+        if (emulator.GetHostIoValue() == 0)
+        {
+            std::snprintf(buffer, sizeof(buffer), "no host io within %d cycles", option.GetCycle());
+        }
+        else
+        {
+            std::snprintf(buffer, sizeof(buffer), "host io value 0x%" PRIx32, emulator.GetHostIoValue());
+        }
+
+        *pOutError = buffer;
+        return false;
+    }
+
+    return true;
+}
+
+bool RunWorkload(Measurement* pOutMeasurement, std::string* pOutError, const Workload& workload)
+{
+    Measurement total { 0, 0 };
+
+    for (const auto& run: workload.runs)
+    {
+        Measurement measurement;
+
+        if (!Run(&measurement, pOutError, run))
+        {
+            return false;
+        }
+
+        total.instructions += measurement.instructions;
+        total.nanoseconds += measurement.nanoseconds;
+    }
+
+    *pOutMeasurement = total;
+    return true;
+}
+
+double GetNsPerInstruction(const Measurement& measurement)
+{
+    return measurement.instructions == 0 ? 0.0 : static_cast<double>(measurement.nanoseconds) / measurement.instructions;
+}
+
+// Median of ns per instruction (upper median if the number of measurements is even)
+double GetMedianNsPerInstruction(const std::vector<Measurement>& measurements)
+{
+    std::vector<double> values;
+    for (const auto& measurement: measurements)
+    {
+        values.push_back(GetNsPerInstruction(measurement));
+    }
+
+    std::sort(values.begin(), values.end());
+
+    return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+double GetMinNsPerInstruction(const std::vector<Measurement>& measurements)
+{
+    double value = 0.0;
+    for (const auto& measurement: measurements)
+    {
+        const auto ns = GetNsPerInstruction(measurement);
+        if (value == 0.0 || ns < value)
+        {
+            value = ns;
+        }
+    }
+    return value;
+}
+
+double GetMips(double nsPerInstruction)
+{
+    return nsPerInstruction == 0.0 ? 0.0 : 1000.0 / nsPerInstruction;
+}
+
+void WriteJsonReport(const std::string& path, const std::vector<Result>& results, int repeat, int warmup, uint64_t peakRss)
+{
+    auto fp = std::fopen(path.c_str(), "w");
+    if (fp == nullptr)
+    {
+        throw FileOpenFailureException(path.c_str());
+    }
+
+    std::fprintf(fp, "{\n");
+    std::fprintf(fp, "  \"repeat\": %d,\n", repeat);
+    std::fprintf(fp, "  \"warmup\": %d,\n", warmup);
+    std::fprintf(fp, "  \"peak_rss\": %" PRIu64 ",\n", peakRss);
+    std::fprintf(fp, "  \"workloads\": [");
+
+    bool first = true;
+    for (const auto& result: results)
+    {
+        std::fprintf(fp, "%s\n    {\"name\": \"%s\", ", first ? "" : ",", result.name.c_str());
+        first = false;
+
+        if (!result.skipReason.empty())
+        {
+            std::fprintf(fp, "\"status\": \"skipped\", \"reason\": \"%s\"}", result.skipReason.c_str());
+            continue;
+        }
+        if (!result.error.empty())
+        {
+            std::fprintf(fp, "\"status\": \"error\", \"reason\": \"%s\"}", result.error.c_str());
+            continue;
+        }
+
+        const auto medianNs = GetMedianNsPerInstruction(result.measurements);
+
+        std::fprintf(fp, "\"status\": \"ok\", \"instructions\": %" PRIu64 ", \"ns_per_instruction\": %.4f, \"min_ns_per_instruction\": %.4f, \"mips\": %.3f, \"samples_ns\": [",
+            result.measurements.front().instructions,
+            medianNs,
+            GetMinNsPerInstruction(result.measurements),
+            GetMips(medianNs));
+
+        for (size_t i = 0; i < result.measurements.size(); i++)
+        {
+            std::fprintf(fp, "%s%" PRIu64, i == 0 ? "" : ", ", result.measurements[i].nanoseconds);
+        }
+        std::fprintf(fp, "]}");
+    }
+
+    std::fprintf(fp, "\n  ]\n");
+    std::fprintf(fp, "}\n");
+
+    std::fclose(fp);
+}
+
+void PrintSummary(const std::vector<Result>& results, uint64_t peakRss)
+{
+    std::printf("%-12s %14s %12s %10s\n", "Workload", "Instructions", "ns/instr", "MIPS");
+
+    for (const auto& result: results)
+    {
+        if (!result.skipReason.empty())
+        {
+            std::printf("%-12s skipped (%s)\n", result.name.c_str(), result.skipReason.c_str());
+            continue;
+        }
+        if (!result.error.empty())
+        {
+            std::printf("%-12s error (%s)\n", result.name.c_str(), result.error.c_str());
+            continue;
+        }
+
+        const auto medianNs = GetMedianNsPerInstruction(result.measurements);
+
+        std::printf("%-12s %14" PRIu64 " %12.2f %10.2f\n",
+            result.name.c_str(),
+            result.measurements.front().instructions,
+            medianNs,
+            GetMips(medianNs));
+    }
+
+    std::printf("Peak RSS of all workloads: %.1f MB\n", peakRss / (1024.0 * 1024.0));
+}
+
+}
+
+}}
+
+int main(int argc, char** argv)
+{
+    int repeat;
+    int warmup;
+    rafi::bench::WorkloadConfig config;
+
+    po::options_description desc("options");
+    desc.add_options()
+        ("binary-dir", po::value<std::string>(&config.binaryDirPath)->default_value("./third_party/rafi-prebuilt-binary"), "directory of prebuilt riscv-tests and linux binaries")
+        ("filter", po::value<std::string>(), "run only workloads whose name contains this string")
+        ("help", "show help")
+        ("linux-cycle", po::value<int>(&config.linuxCycle)->default_value(rafi::bench::DefaultLinuxCycle), "number of cycles of linux boot workload")
+        ("output", po::value<std::string>()->default_value("rafi-bench.json"), "path of JSON report")
+        ("repeat", po::value<int>(&repeat)->default_value(rafi::bench::DefaultRepeat), "number of measured repetitions")
+        ("warmup", po::value<int>(&warmup)->default_value(rafi::bench::DefaultWarmup), "number of repetitions before measurement");
+
+    po::variables_map variables;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), variables);
+        po::notify(variables);
+    }
+    catch (const po::error& e)
+    {
+        std::cout << e.what() << std::endl;
+        std::exit(1);
+    }
+
+    if (variables.count("help"))
+    {
+        std::cout << desc << std::endl;
+        std::exit(0);
+    }
+
+    if (repeat <= 0 || warmup < 0)
+    {
+        std::cout << "--repeat must be positive and --warmup must not be negative." << std::endl;
+        std::exit(1);
+    }
+
+    const auto filter = variables.count("filter") ? variables["filter"].as<std::string>() : "";
+
+    std::vector<rafi::bench::Result> results;
+
+    for (const auto& workload: rafi::bench::MakeWorkloads(config))
+    {
+        if (workload.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        rafi::bench::Result result { workload.name, workload.skipReason, "", {} };
+
+        if (result.skipReason.empty())
+        {
+            try
+            {
+                // Warmup runs are checked as well, so that a failing guest is not measured.
+                for (int i = 0; i < warmup + repeat && result.error.empty(); i++)
+                {
+                    rafi::bench::Measurement measurement;
+
+                    if (rafi::bench::RunWorkload(&measurement, &result.error, workload) && i >= warmup)
+                    {
+                        result.measurements.push_back(measurement);
+                    }
+                }
+            }
+            catch (const rafi::emu::RafiEmuException&)
+            {
+                result.error = "emulation stopped by exception";
+            }
+
+            if (!result.error.empty())
+            {
+                result.measurements.clear();
+            }
+        }
+
+        results.push_back(result);
+    }
+
+    // Peak RSS is of the whole process, so it is reported once for all workloads rather than per workload.
+    const auto peakRss = rafi::bench::GetPeakRss();
+
+    rafi::bench::PrintSummary(results, peakRss);
+
+    try
+    {
+        rafi::bench::WriteJsonReport(variables["output"].as<std::string>(), results, repeat, warmup, peakRss);
+    }
+    catch (const rafi::FileOpenFailureException& e)
+    {
+        e.PrintMessage();
+        std::exit(1);
+    }
+
+    return 0;
+}
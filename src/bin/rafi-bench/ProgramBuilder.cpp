@@ -0,0 +1,416 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cassert>
+
+#include <rafi/common.h>
+
+#include "ProgramBuilder.h"
+
+namespace rafi { namespace bench {
+
+namespace {
+
+const uint32_t OpcodeLoad = 0b0000011;
+const uint32_t OpcodeLoadFp = 0b0000111;
+const uint32_t OpcodeAuipc = 0b0010111;
+const uint32_t OpcodeOpImm = 0b0010011;
+const uint32_t OpcodeOpImm32 = 0b0011011;
+const uint32_t OpcodeStore = 0b0100011;
+const uint32_t OpcodeStoreFp = 0b0100111;
+const uint32_t OpcodeOp = 0b0110011;
+const uint32_t OpcodeLui = 0b0110111;
+const uint32_t OpcodeMadd = 0b1000011;
+const uint32_t OpcodeOpFp = 0b1010011;
+const uint32_t OpcodeBranch = 0b1100011;
+const uint32_t OpcodeJalr = 0b1100111;
+const uint32_t OpcodeJal = 0b1101111;
+const uint32_t OpcodeSystem = 0b1110011;
+
+// Dynamic rounding mode
+const uint32_t RoundingModeDynamic = 0b111;
+
+uint32_t ToUInt32(IntReg reg)
+{
+    return static_cast<uint32_t>(reg);
+}
+
+uint32_t ToUInt32(FpReg reg)
+{
+    return static_cast<uint32_t>(reg);
+}
+
+int64_t SignExtend12(int64_t value)
+{
+    return ((value & 0xfff) ^ 0x800) - 0x800;
+}
+
+uint32_t EncodeBranchOffset(int64_t offset)
+{
+    assert(-4096 <= offset && offset < 4096);
+
+    const auto imm = static_cast<uint32_t>(offset);
+
+    return (((imm >> 12) & 0x1) << 31) |
+        (((imm >> 5) & 0x3f) << 25) |
+        (((imm >> 1) & 0xf) << 8) |
+        (((imm >> 11) & 0x1) << 7);
+}
+
+uint32_t EncodeJalOffset(int64_t offset)
+{
+    assert(-(1 << 20) <= offset && offset < (1 << 20));
+
+    const auto imm = static_cast<uint32_t>(offset);
+
+    return (((imm >> 20) & 0x1) << 31) |
+        (((imm >> 1) & 0x3ff) << 21) |
+        (((imm >> 11) & 0x1) << 20) |
+        (((imm >> 12) & 0xff) << 12);
+}
+
+}
+
+ProgramBuilder::Label ProgramBuilder::MakeLabel()
+{
+    m_LabelIndices.push_back(-1);
+
+    return static_cast<Label>(m_LabelIndices.size() - 1);
+}
+
+void ProgramBuilder::Bind(Label label)
+{
+    m_LabelIndices[label] = static_cast<int64_t>(m_Code.size());
+}
+
+void ProgramBuilder::Li(IntReg rd, int64_t value)
+{
+    if (INT32_MIN <= value && value <= INT32_MAX)
+    {
+        const auto lo12 = SignExtend12(value);
+        const auto hi20 = (value - lo12) >> 12;
+
+        if (hi20 == 0)
+        {
+            Addi(rd, IntReg::zero, static_cast<int32_t>(lo12));
+        }
+        else
+        {
+            Lui(rd, static_cast<int32_t>(hi20));
+            if (lo12 != 0)
+            {
+                Addiw(rd, rd, static_cast<int32_t>(lo12));
+            }
+        }
+        return;
+    }
+
+    const auto lo12 = SignExtend12(value);
+    auto hi = (value - lo12) >> 12;
+    uint32_t shift = 12;
+
+    while ((hi & 1) == 0)
+    {
+        hi >>= 1;
+        shift++;
+    }
+
+    Li(rd, hi);
+    Slli(rd, rd, shift);
+    if (lo12 != 0)
+    {
+        Addi(rd, rd, static_cast<int32_t>(lo12));
+    }
+}
+
+void ProgramBuilder::Add(IntReg rd, IntReg rs1, IntReg rs2)
+{
+    EmitR(OpcodeOp, 0b000, 0b0000000, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::Sub(IntReg rd, IntReg rs1, IntReg rs2)
+{
+    EmitR(OpcodeOp, 0b000, 0b0100000, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::And(IntReg rd, IntReg rs1, IntReg rs2)
+{
+    EmitR(OpcodeOp, 0b111, 0b0000000, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::Or(IntReg rd, IntReg rs1, IntReg rs2)
+{
+    EmitR(OpcodeOp, 0b110, 0b0000000, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::Xor(IntReg rd, IntReg rs1, IntReg rs2)
+{
+    EmitR(OpcodeOp, 0b100, 0b0000000, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::Sltu(IntReg rd, IntReg rs1, IntReg rs2)
+{
+    EmitR(OpcodeOp, 0b011, 0b0000000, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::Addi(IntReg rd, IntReg rs1, int32_t imm)
+{
+    EmitI(OpcodeOpImm, 0b000, ToUInt32(rd), ToUInt32(rs1), imm);
+}
+
+void ProgramBuilder::Addiw(IntReg rd, IntReg rs1, int32_t imm)
+{
+    EmitI(OpcodeOpImm32, 0b000, ToUInt32(rd), ToUInt32(rs1), imm);
+}
+
+void ProgramBuilder::Andi(IntReg rd, IntReg rs1, int32_t imm)
+{
+    EmitI(OpcodeOpImm, 0b111, ToUInt32(rd), ToUInt32(rs1), imm);
+}
+
+void ProgramBuilder::Ori(IntReg rd, IntReg rs1, int32_t imm)
+{
+    EmitI(OpcodeOpImm, 0b110, ToUInt32(rd), ToUInt32(rs1), imm);
+}
+
+void ProgramBuilder::Slli(IntReg rd, IntReg rs1, uint32_t shamt)
+{
+    assert(shamt < 64);
+
+    EmitI(OpcodeOpImm, 0b001, ToUInt32(rd), ToUInt32(rs1), static_cast<int32_t>(shamt));
+}
+
+void ProgramBuilder::Srli(IntReg rd, IntReg rs1, uint32_t shamt)
+{
+    assert(shamt < 64);
+
+    EmitI(OpcodeOpImm, 0b101, ToUInt32(rd), ToUInt32(rs1), static_cast<int32_t>(shamt));
+}
+
+void ProgramBuilder::Lui(IntReg rd, int32_t imm)
+{
+    m_Code.push_back(((static_cast<uint32_t>(imm) & 0xfffff) << 12) | (ToUInt32(rd) << 7) | OpcodeLui);
+}
+
+void ProgramBuilder::Auipc(IntReg rd, int32_t imm)
+{
+    m_Code.push_back(((static_cast<uint32_t>(imm) & 0xfffff) << 12) | (ToUInt32(rd) << 7) | OpcodeAuipc);
+}
+
+void ProgramBuilder::Lbu(IntReg rd, IntReg rs1, int32_t imm)
+{
+    EmitI(OpcodeLoad, 0b100, ToUInt32(rd), ToUInt32(rs1), imm);
+}
+
+void ProgramBuilder::Lw(IntReg rd, IntReg rs1, int32_t imm)
+{
+    EmitI(OpcodeLoad, 0b010, ToUInt32(rd), ToUInt32(rs1), imm);
+}
+
+void ProgramBuilder::Ld(IntReg rd, IntReg rs1, int32_t imm)
+{
+    EmitI(OpcodeLoad, 0b011, ToUInt32(rd), ToUInt32(rs1), imm);
+}
+
+void ProgramBuilder::Sb(IntReg rs2, IntReg rs1, int32_t imm)
+{
+    EmitS(OpcodeStore, 0b000, ToUInt32(rs1), ToUInt32(rs2), imm);
+}
+
+void ProgramBuilder::Sw(IntReg rs2, IntReg rs1, int32_t imm)
+{
+    EmitS(OpcodeStore, 0b010, ToUInt32(rs1), ToUInt32(rs2), imm);
+}
+
+void ProgramBuilder::Sd(IntReg rs2, IntReg rs1, int32_t imm)
+{
+    EmitS(OpcodeStore, 0b011, ToUInt32(rs1), ToUInt32(rs2), imm);
+}
+
+void ProgramBuilder::Beq(IntReg rs1, IntReg rs2, Label target)
+{
+    EmitBranch(0b000, rs1, rs2, target);
+}
+
+void ProgramBuilder::Bne(IntReg rs1, IntReg rs2, Label target)
+{
+    EmitBranch(0b001, rs1, rs2, target);
+}
+
+void ProgramBuilder::Blt(IntReg rs1, IntReg rs2, Label target)
+{
+    EmitBranch(0b100, rs1, rs2, target);
+}
+
+void ProgramBuilder::Bltu(IntReg rs1, IntReg rs2, Label target)
+{
+    EmitBranch(0b110, rs1, rs2, target);
+}
+
+void ProgramBuilder::Jal(IntReg rd, Label target)
+{
+    m_Fixups.push_back(Fixup { m_Code.size(), target, FixupType::Jal });
+    m_Code.push_back((ToUInt32(rd) << 7) | OpcodeJal);
+}
+
+void ProgramBuilder::Jalr(IntReg rd, IntReg rs1, int32_t imm)
+{
+    EmitI(OpcodeJalr, 0b000, ToUInt32(rd), ToUInt32(rs1), imm);
+}
+
+void ProgramBuilder::Mul(IntReg rd, IntReg rs1, IntReg rs2)
+{
+    EmitR(OpcodeOp, 0b000, 0b0000001, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::Div(IntReg rd, IntReg rs1, IntReg rs2)
+{
+    EmitR(OpcodeOp, 0b100, 0b0000001, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::Rem(IntReg rd, IntReg rs1, IntReg rs2)
+{
+    EmitR(OpcodeOp, 0b110, 0b0000001, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::Fld(FpReg rd, IntReg rs1, int32_t imm)
+{
+    EmitI(OpcodeLoadFp, 0b011, ToUInt32(rd), ToUInt32(rs1), imm);
+}
+
+void ProgramBuilder::Fsd(FpReg rs2, IntReg rs1, int32_t imm)
+{
+    EmitS(OpcodeStoreFp, 0b011, ToUInt32(rs1), ToUInt32(rs2), imm);
+}
+
+void ProgramBuilder::FaddD(FpReg rd, FpReg rs1, FpReg rs2)
+{
+    EmitR(OpcodeOpFp, RoundingModeDynamic, 0b0000001, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::FmulD(FpReg rd, FpReg rs1, FpReg rs2)
+{
+    EmitR(OpcodeOpFp, RoundingModeDynamic, 0b0001001, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::FdivD(FpReg rd, FpReg rs1, FpReg rs2)
+{
+    EmitR(OpcodeOpFp, RoundingModeDynamic, 0b0001101, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::FsqrtD(FpReg rd, FpReg rs1)
+{
+    EmitR(OpcodeOpFp, RoundingModeDynamic, 0b0101101, ToUInt32(rd), ToUInt32(rs1), 0);
+}
+
+void ProgramBuilder::FmaddD(FpReg rd, FpReg rs1, FpReg rs2, FpReg rs3)
+{
+    // fmt = D (0b01)
+    EmitR(OpcodeMadd, RoundingModeDynamic, (ToUInt32(rs3) << 2) | 0b01, ToUInt32(rd), ToUInt32(rs1), ToUInt32(rs2));
+}
+
+void ProgramBuilder::FcvtDL(FpReg rd, IntReg rs1)
+{
+    // rs2 = 2 means signed 64-bit integer source.
+    EmitR(OpcodeOpFp, RoundingModeDynamic, 0b1101001, ToUInt32(rd), ToUInt32(rs1), 2);
+}
+
+void ProgramBuilder::Csrw(csr_addr_t csr, IntReg rs1)
+{
+    // csrrw x0, csr, rs1
+    EmitI(OpcodeSystem, 0b001, 0, ToUInt32(rs1), static_cast<int32_t>(csr));
+}
+
+void ProgramBuilder::Csrs(csr_addr_t csr, IntReg rs1)
+{
+    // csrrs x0, csr, rs1
+    EmitI(OpcodeSystem, 0b010, 0, ToUInt32(rs1), static_cast<int32_t>(csr));
+}
+
+void ProgramBuilder::Mret()
+{
+    m_Code.push_back(0x30200073);
+}
+
+void ProgramBuilder::J(Label target)
+{
+    Jal(IntReg::zero, target);
+}
+
+void ProgramBuilder::Call(Label target)
+{
+    Jal(IntReg::ra, target);
+}
+
+void ProgramBuilder::Ret()
+{
+    Jalr(IntReg::zero, IntReg::ra, 0);
+}
+
+const std::vector<uint32_t>& ProgramBuilder::GetCode()
+{
+    for (const auto& fixup: m_Fixups)
+    {
+        assert(m_LabelIndices[fixup.label] >= 0);
+
+        const auto offset = (m_LabelIndices[fixup.label] - static_cast<int64_t>(fixup.index)) * 4;
+
+        switch (fixup.type)
+        {
+        case FixupType::Branch:
+            m_Code[fixup.index] |= EncodeBranchOffset(offset);
+            break;
+        case FixupType::Jal:
+            m_Code[fixup.index] |= EncodeJalOffset(offset);
+            break;
+        default:
+            RAFI_NOT_IMPLEMENTED;
+        }
+    }
+
+    m_Fixups.clear();
+
+    return m_Code;
+}
+
+void ProgramBuilder::EmitR(uint32_t opcode, uint32_t funct3, uint32_t funct7, uint32_t rd, uint32_t rs1, uint32_t rs2)
+{
+    m_Code.push_back((funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode);
+}
+
+void ProgramBuilder::EmitI(uint32_t opcode, uint32_t funct3, uint32_t rd, uint32_t rs1, int32_t imm)
+{
+    assert(-2048 <= imm && imm < 4096);
+
+    m_Code.push_back(((static_cast<uint32_t>(imm) & 0xfff) << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode);
+}
+
+void ProgramBuilder::EmitS(uint32_t opcode, uint32_t funct3, uint32_t rs1, uint32_t rs2, int32_t imm)
+{
+    assert(-2048 <= imm && imm < 2048);
+
+    const auto value = static_cast<uint32_t>(imm);
+
+    m_Code.push_back((((value >> 5) & 0x7f) << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | ((value & 0x1f) << 7) | opcode);
+}
+
+void ProgramBuilder::EmitBranch(uint32_t funct3, IntReg rs1, IntReg rs2, Label target)
+{
+    m_Fixups.push_back(Fixup { m_Code.size(), target, FixupType::Branch });
+    m_Code.push_back((ToUInt32(rs2) << 20) | (ToUInt32(rs1) << 15) | (funct3 << 12) | OpcodeBranch);
+}
+
+}}
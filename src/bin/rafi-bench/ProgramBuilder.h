@@ -0,0 +1,135 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <rafi/common.h>
+
+namespace rafi { namespace bench {
+
+enum class IntReg : uint32_t
+{
+    zero = 0, ra = 1, sp = 2, gp = 3, tp = 4,
+    t0 = 5, t1 = 6, t2 = 7,
+    s0 = 8, s1 = 9,
+    a0 = 10, a1 = 11, a2 = 12, a3 = 13, a4 = 14, a5 = 15, a6 = 16, a7 = 17,
+    s2 = 18, s3 = 19, s4 = 20, s5 = 21, s6 = 22, s7 = 23, s8 = 24, s9 = 25, s10 = 26, s11 = 27,
+    t3 = 28, t4 = 29, t5 = 30, t6 = 31,
+};
+
+enum class FpReg : uint32_t
+{
+    ft0 = 0, ft1 = 1, ft2 = 2, ft3 = 3, ft4 = 4, ft5 = 5, ft6 = 6, ft7 = 7,
+    fs0 = 8, fs1 = 9,
+    fa0 = 10, fa1 = 11, fa2 = 12, fa3 = 13, fa4 = 14, fa5 = 15, fa6 = 16, fa7 = 17,
+};
+
+// Minimal assembler to build guest benchmark programs without a RISC-V toolchain.
+// Branch and jump targets are labels which are resolved by GetCode().
+class ProgramBuilder
+{
+public:
+    using Label = int;
+
+    Label MakeLabel();
+    void Bind(Label label);
+
+    // Loads any 64-bit constant with lui/addi(w)/slli sequence.
+    void Li(IntReg rd, int64_t value);
+
+    // RV64I (lui and auipc take imm[31:12])
+    void Add(IntReg rd, IntReg rs1, IntReg rs2);
+    void Sub(IntReg rd, IntReg rs1, IntReg rs2);
+    void And(IntReg rd, IntReg rs1, IntReg rs2);
+    void Or(IntReg rd, IntReg rs1, IntReg rs2);
+    void Xor(IntReg rd, IntReg rs1, IntReg rs2);
+    void Sltu(IntReg rd, IntReg rs1, IntReg rs2);
+    void Addi(IntReg rd, IntReg rs1, int32_t imm);
+    void Addiw(IntReg rd, IntReg rs1, int32_t imm);
+    void Andi(IntReg rd, IntReg rs1, int32_t imm);
+    void Ori(IntReg rd, IntReg rs1, int32_t imm);
+    void Slli(IntReg rd, IntReg rs1, uint32_t shamt);
+    void Srli(IntReg rd, IntReg rs1, uint32_t shamt);
+    void Lui(IntReg rd, int32_t imm);
+    void Auipc(IntReg rd, int32_t imm);
+    void Lbu(IntReg rd, IntReg rs1, int32_t imm);
+    void Lw(IntReg rd, IntReg rs1, int32_t imm);
+    void Ld(IntReg rd, IntReg rs1, int32_t imm);
+    void Sb(IntReg rs2, IntReg rs1, int32_t imm);
+    void Sw(IntReg rs2, IntReg rs1, int32_t imm);
+    void Sd(IntReg rs2, IntReg rs1, int32_t imm);
+    void Beq(IntReg rs1, IntReg rs2, Label target);
+    void Bne(IntReg rs1, IntReg rs2, Label target);
+    void Blt(IntReg rs1, IntReg rs2, Label target);
+    void Bltu(IntReg rs1, IntReg rs2, Label target);
+    void Jal(IntReg rd, Label target);
+    void Jalr(IntReg rd, IntReg rs1, int32_t imm);
+
+    // RV64M
+    void Mul(IntReg rd, IntReg rs1, IntReg rs2);
+    void Div(IntReg rd, IntReg rs1, IntReg rs2);
+    void Rem(IntReg rd, IntReg rs1, IntReg rs2);
+
+    // RV64D
+    void Fld(FpReg rd, IntReg rs1, int32_t imm);
+    void Fsd(FpReg rs2, IntReg rs1, int32_t imm);
+    void FaddD(FpReg rd, FpReg rs1, FpReg rs2);
+    void FmulD(FpReg rd, FpReg rs1, FpReg rs2);
+    void FdivD(FpReg rd, FpReg rs1, FpReg rs2);
+    void FsqrtD(FpReg rd, FpReg rs1);
+    void FmaddD(FpReg rd, FpReg rs1, FpReg rs2, FpReg rs3);
+    void FcvtDL(FpReg rd, IntReg rs1);
+
+    // Zicsr and privileged
+    void Csrw(csr_addr_t csr, IntReg rs1);
+    void Csrs(csr_addr_t csr, IntReg rs1);
+    void Mret();
+
+    // Pseudo instructions
+    void J(Label target);
+    void Call(Label target);
+    void Ret();
+
+    const std::vector<uint32_t>& GetCode();
+
+private:
+    enum class FixupType
+    {
+        Branch,
+        Jal,
+    };
+
+    struct Fixup
+    {
+        size_t index;
+        Label label;
+        FixupType type;
+    };
+
+    void EmitR(uint32_t opcode, uint32_t funct3, uint32_t funct7, uint32_t rd, uint32_t rs1, uint32_t rs2);
+    void EmitI(uint32_t opcode, uint32_t funct3, uint32_t rd, uint32_t rs1, int32_t imm);
+    void EmitS(uint32_t opcode, uint32_t funct3, uint32_t rs1, uint32_t rs2, int32_t imm);
+    void EmitBranch(uint32_t funct3, IntReg rs1, IntReg rs2, Label target);
+
+    std::vector<uint32_t> m_Code;
+    std::vector<int64_t> m_LabelIndices;
+    std::vector<Fixup> m_Fixups;
+};
+
+}}
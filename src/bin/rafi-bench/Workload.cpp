@@ -0,0 +1,161 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <string>
+#include <vector>
+
+#include <rafi/emu.h>
+
+#include "Workload.h"
+
+namespace rafi { namespace bench {
+
+namespace {
+
+// Subset of riscv-tests which covers integer, multiply, atomic, fp and virtual memory tests.
+const char* const RiscvTestNames[] = {
+    "rv32ui-p-add",
+    "rv32ui-p-lw",
+    "rv64ua-p-amoadd_d",
+    "rv64ua-p-lrsc",
+    "rv64ud-p-fadd",
+    "rv64ud-p-fdiv",
+    "rv64ud-p-fmadd",
+    "rv64ui-p-add",
+    "rv64ui-p-addi",
+    "rv64ui-p-and",
+    "rv64ui-p-beq",
+    "rv64ui-p-jal",
+    "rv64ui-p-ld",
+    "rv64ui-p-lw",
+    "rv64ui-p-sd",
+    "rv64ui-p-sll",
+    "rv64ui-p-sw",
+    "rv64ui-v-add",
+    "rv64ui-v-ld",
+    "rv64ui-v-sd",
+    "rv64um-p-div",
+    "rv64um-p-mul",
+    "rv64um-p-rem",
+};
+
+const int RiscvTestCycle = 256 * 1000;
+
+bool LoadImage(MemoryImage* pOut, const std::string& path, paddr_t address)
+{
+    std::ifstream f(path, std::ios::in | std::ios::binary);
+    if (!f.is_open())
+    {
+        return false;
+    }
+
+    pOut->address = address;
+    pOut->data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+
+    return true;
+}
+
+Workload MakeRiscvTestsWorkload(const WorkloadConfig& config)
+{
+    Workload workload { "riscv-tests", {}, "" };
+
+    for (const auto name: RiscvTestNames)
+    {
+        const auto path = config.binaryDirPath + "/riscv-tests/isa/" + name + ".bin";
+
+        MemoryImage image;
+        if (!LoadImage(&image, path, 0x80000000))
+        {
+            workload.runs.clear();
+            workload.skipReason = path + " is not found";
+            return workload;
+        }
+
+        const auto xlen = std::string(name).compare(0, 4, "rv32") == 0 ? "32" : "64";
+
+        workload.runs.push_back(GuestRun {
+            {
+                "--cycle", std::to_string(RiscvTestCycle),
+                "--xlen", xlen,
+                "--pc", "80000000",
+                "--host-io-addr", "80001000",
+            },
+            { image },
+        });
+    }
+
+    return workload;
+}
+
+Workload MakeLinuxWorkload(const WorkloadConfig& config)
+{
+    Workload workload { "linux-boot", {}, "" };
+
+    const std::pair<const char*, paddr_t> files[] = {
+        { "linux-boot-rom.bin", 0x1000 },
+        { "bbl.bin", 0x80000000 },
+        { "vmlinux.bin", 0x80200000 },
+        { "initramfs.cpio.gz", 0x84000000 },
+    };
+
+    GuestRun run {
+        {
+            "--cycle", std::to_string(config.linuxCycle),
+            "--ram-size", std::to_string(128 * 1024 * 1024),
+            "--pc", "1000",
+            "--xlen", "64",
+        },
+        {},
+    };
+
+    for (const auto& file: files)
+    {
+        const auto path = config.binaryDirPath + "/linux/" + file.first;
+
+        MemoryImage image;
+        if (!LoadImage(&image, path, file.second))
+        {
+            workload.skipReason = path + " is not found";
+            return workload;
+        }
+
+        run.images.push_back(image);
+    }
+
+    workload.runs.push_back(run);
+
+    return workload;
+}
+
+}
+
+std::vector<Workload> MakeWorkloads(const WorkloadConfig& config)
+{
+    std::vector<Workload> workloads;
+
+    workloads.push_back(MakeRiscvTestsWorkload(config));
+    workloads.push_back(Workload { "integer", { MakeIntegerKernel() }, "" });
+    workloads.push_back(Workload { "sv39", { MakePageTableKernel() }, "" });
+    workloads.push_back(Workload { "fp", { MakeFpKernel() }, "" });
+    workloads.push_back(MakeLinuxWorkload(config));
+
+    return workloads;
+}
+
+}}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rafi/emu.h>
+
+namespace rafi { namespace bench {
+
+struct MemoryImage
+{
+    paddr_t address;
+    std::vector<uint8_t> data;
+};
+
+// One invocation of the emulator. Arguments are passed to emu::CommandLineOption as they are.
+struct GuestRun
+{
+    std::vector<std::string> arguments;
+    std::vector<MemoryImage> images;
+};
+
+// Workload consists of one or more guest runs whose instruction count and time are summed up.
+// Workload with non-empty skipReason is reported but not run.
+struct Workload
+{
+    std::string name;
+    std::vector<GuestRun> runs;
+    std::string skipReason;
+};
+
+struct WorkloadConfig
+{
+    std::string binaryDirPath;
+    int linuxCycle;
+};
+
+// Kernels generated by ProgramBuilder (RV64, bare metal, stop by host io)
+GuestRun MakeIntegerKernel();
+GuestRun MakePageTableKernel();
+GuestRun MakeFpKernel();
+
+std::vector<Workload> MakeWorkloads(const WorkloadConfig& config);
+
+}}
@@ -28,33 +28,74 @@ namespace {
     const char* Pass = "[  PASS  ]";
     const char* Failed = "[ FAILED ]";
     uint32_t ExpectedHostIoValue = 1;
+    size_t BatchSize = 64 * 1024;
 }
 
 uint32_t GetLastHostIoValue(trace::ITraceReader* pReader)
 {
     uint32_t hostIoValue = 0;
 
+    trace::CycleBatch batch;
+
     while (!pReader->IsEnd())
     {
-        trace::NodeIo io;
-
-        pReader->GetCycle()->CopyIo(&io);
-        pReader->Next();
+        batch.Clear();
+        pReader->ReadBatch(&batch, BatchSize);
 
-        hostIoValue = io.hostIo;
+        if (batch.GetCycleCount() > 0)
+        {
+            hostIoValue = batch.hostIo.back();
+        }
     }
 
     return hostIoValue;
 }
 
+// Gets the last host io value from summaries in .tidx without reading data files.
+// Returns false if the trace is not .tidx or it is written by an older version without summaries.
+bool GetLastHostIoValueFromSummary(uint32_t* pOutValue, const std::string& path)
+{
+    if (!trace::IsTraceIndexPath(path))
+    {
+        return false;
+    }
+
+    const auto entries = trace::ReadTraceIndexFile(path.c_str());
+
+    for (const auto& entry : entries)
+    {
+        if (!entry.hasSummary)
+        {
+            return false;
+        }
+    }
+
+    *pOutValue = 0;
+
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+    {
+        if (it->summary.hasHostIo)
+        {
+            *pOutValue = it->summary.hostIo;
+            break;
+        }
+    }
+
+    return true;
+}
+
 bool CheckIo(const char* name, const char* path)
 {
     try
     {
-        auto reader = trace::MakeTraceReader(path);
+        uint32_t hostIoValue;
 
         // Find IoNode
-        const auto hostIoValue = GetLastHostIoValue(reader.get());
+        if (!GetLastHostIoValueFromSummary(&hostIoValue, path))
+        {
+            auto reader = trace::MakeTraceReader(path);
+            hostIoValue = GetLastHostIoValue(reader.get());
+        }
 
         // Check IoValue
         if (hostIoValue != ExpectedHostIoValue)
@@ -17,6 +17,8 @@
 #include <iostream>
 #include <memory>
 
+#include <boost/algorithm/string.hpp>
+
 #include <rafi/trace.h>
 
 namespace rafi {
@@ -26,7 +28,18 @@ void Convert(const char* inPath, const char* outPathBase)
     try
     {
         auto reader = trace::MakeTraceReader(inPath);
-        auto writer = std::make_unique<trace::TraceIndexWriter>(outPathBase);
+        // Output compressed trace if the output path has its extension, and index and data files otherwise.
+        std::unique_ptr<trace::ITraceWriter> writer;
+        if (boost::algorithm::ends_with(outPathBase, ".tcz"))
+        {
+            writer = std::make_unique<trace::TraceCompressedWriter>(outPathBase);
+        }
+        else
+        {
+            writer = std::make_unique<trace::TraceIndexWriter>(outPathBase);
+        }
+
+        trace::BinaryCycleBuilder cycleBuilder;
 
         while (!reader->IsEnd())
         {
@@ -34,7 +47,7 @@ void Convert(const char* inPath, const char* outPathBase)
             const auto xlen = reader->GetCycle()->GetXLEN();
             const auto pc = reader->GetCycle()->GetPc();
 
-            trace::BinaryCycleBuilder cycleBuilder(cycle, xlen, pc);
+            cycleBuilder.Reset(cycle, xlen, pc);
 
             if (reader->GetCycle()->IsIntRegExist())
             {
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <rafi/trace.h>
+
+#include "Bisector.h"
+
+namespace rafi {
+
+Bisector::Bisector(const CommandLineOption& option)
+    : m_Option(option)
+{
+}
+
+bool Bisector::Run(int* pOutStartCycle)
+{
+    const auto expectBase = GetPathBase(m_Option.GetExpectPath());
+    const auto actualBase = GetPathBase(m_Option.GetActualPath());
+    const auto expectDigestPath = expectBase + ".tdig";
+    const auto actualDigestPath = actualBase + ".tdig";
+
+    const auto interval = m_Option.GetDigestInterval();
+
+    std::cout << "Record state digests every " << std::dec << interval << " cycles." << std::endl;
+
+    std::ostringstream digestArgs;
+    digestArgs << " --cycle " << m_Option.GetCycleCount() << " --digest-interval " << interval;
+
+    RunCommand(m_Option.GetExpectCommand() + digestArgs.str() + " --digest-path \"" + expectDigestPath + "\"");
+    RunCommand(m_Option.GetActualCommand() + digestArgs.str() + " --digest-path \"" + actualDigestPath + "\"");
+
+    const trace::StateDigestReader expect(expectDigestPath.c_str());
+    const trace::StateDigestReader actual(actualDigestPath.c_str());
+
+    const auto count = std::min(expect.GetCount(), actual.GetCount());
+
+    size_t index = 0;
+    while (index < count && expect.Get(index).cycle == actual.Get(index).cycle && expect.Get(index).digest == actual.Get(index).digest)
+    {
+        index++;
+    }
+
+    if (index == count && expect.GetCount() == actual.GetCount())
+    {
+        std::cout << "State digests matched." << std::endl;
+        std::cout << "    - expect: " << std::dec << expect.GetCount() << " digests." << std::endl;
+        std::cout << "    - actual: " << std::dec << actual.GetCount() << " digests." << std::endl;
+        return false;
+    }
+
+    // The previous digest is matched, so the cause is between the previous digest and this one.
+    // If a run stopped earlier, the other run has the entry at index.
+    uint64_t lastCycle = 0;
+    if (index < expect.GetCount())
+    {
+        lastCycle = std::max(lastCycle, expect.Get(index).cycle);
+    }
+    if (index < actual.GetCount())
+    {
+        lastCycle = std::max(lastCycle, actual.Get(index).cycle);
+    }
+
+    const auto startCycle = index > 0 ? expect.Get(index - 1).cycle : 0;
+
+    std::cout << "Detect mismatched state digest." << std::endl;
+    std::cout << "    - window: 0x" << std::hex << startCycle << " (" << std::dec << startCycle << ") - 0x"
+        << std::hex << lastCycle << " (" << std::dec << lastCycle << ") cycle." << std::endl;
+
+    std::ostringstream dumpArgs;
+    dumpArgs << " --cycle " << (lastCycle + 1) << " --dump-skip-cycle " << startCycle;
+
+    RunCommand(m_Option.GetExpectCommand() + dumpArgs.str() + " --dump-path \"" + expectBase + "\"");
+    RunCommand(m_Option.GetActualCommand() + dumpArgs.str() + " --dump-path \"" + actualBase + "\"");
+
+    *pOutStartCycle = static_cast<int>(startCycle);
+    return true;
+}
+
+std::string Bisector::GetPathBase(const std::string& tracePath)
+{
+    assert(trace::IsTraceIndexPath(tracePath));
+
+    return tracePath.substr(0, tracePath.size() - std::strlen(".tidx"));
+}
+
+void Bisector::RunCommand(const std::string& command)
+{
+    std::cout << "Run: " << command << std::endl;
+
+    // A run which stopped by exception is still worth comparing, so only report the status.
+    const auto status = std::system(command.c_str());
+    if (status != 0)
+    {
+        std::cout << "Command exited with status " << std::dec << status << "." << std::endl;
+    }
+}
+
+}
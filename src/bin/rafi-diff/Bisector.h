@@ -0,0 +1,46 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "CommandLineOption.h"
+
+namespace rafi {
+
+// Finds the first window whose state digests differ by running expect and actual commands with --digest-path,
+// and then re-runs both commands with full trace only for the window.
+// Commands are rafi-emu command lines without --cycle, --digest-*, --dump-path and --dump-skip-cycle options.
+class Bisector final
+{
+public:
+    explicit Bisector(const CommandLineOption& option);
+
+    // Returns false if all digests are matched.
+    // Otherwise writes traces of the window to expect and actual paths and returns the first cycle of the window.
+    bool Run(int* pOutStartCycle);
+
+private:
+    // Returns path of dump (or digest) file without .tidx suffix.
+    static std::string GetPathBase(const std::string& tracePath);
+
+    static void RunCommand(const std::string& command);
+
+    const CommandLineOption& m_Option;
+};
+
+}
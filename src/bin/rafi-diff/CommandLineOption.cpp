@@ -30,6 +30,9 @@ namespace rafi {
 namespace {
     static const int DefaultCycleCount = 1000 * 1000 * 1000;
     static const int DefaultThreshold = 10;
+    static const int DefaultJobCount = 1;
+    static const int DefaultRealignWindow = 32;
+    static const int DefaultRealignRange = 1024 * 1024;
 }
 
 CommandLineOption::CommandLineOption(int argc, char** argv)
@@ -39,8 +42,18 @@ CommandLineOption::CommandLineOption(int argc, char** argv)
         ("expect,e", po::value<std::string>(&m_ExpectPath)->required(), "expect trace binary")
         ("actual,a", po::value<std::string>(&m_ActualPath)->required(), "actual trace binary")
         ("check-physical-pc,p", "enable comparing physical PC")
+        ("check-fp-reg", "enable comparing FP registers")
+        ("check-memory-event", "enable comparing memory access events")
         ("count,c", po::value<int>(&m_CycleCount)->default_value(DefaultCycleCount), "number of cycles to print")
         ("threshold,t", po::value<int>(&m_Threshold)->default_value(DefaultThreshold), "threshold to stop somparation")
+        ("realign", "realign traces after control flow diverged instead of proceeding actual cycle by cycle")
+        ("realign-window", po::value<int>(&m_RealignWindow)->default_value(DefaultRealignWindow), "number of cycles with the same (pc, insn) to realign traces")
+        ("realign-range", po::value<int>(&m_RealignRange)->default_value(DefaultRealignRange), "number of cycles to search for realignment")
+        ("bisect", "run expect and actual commands with state digests, and compare full traces (.tidx) of the first mismatched window only")
+        ("expect-command", po::value<std::string>(&m_ExpectCommand), "rafi-emu command line to produce expect trace (for --bisect)")
+        ("actual-command", po::value<std::string>(&m_ActualCommand), "rafi-emu command line to produce actual trace (for --bisect)")
+        ("digest-interval", po::value<int>(&m_DigestInterval)->default_value(trace::DefaultStateDigestInterval), "number of cycles between state digests (for --bisect)")
+        ("jobs,j", po::value<int>(&m_JobCount)->default_value(DefaultJobCount), "number of threads to find the first mismatch of .tidx traces (0: number of cores)")
         ("help,h", "show help");
 
     po::positional_options_description posOptDesc;
@@ -64,6 +77,31 @@ CommandLineOption::CommandLineOption(int argc, char** argv)
         std::cout << desc << std::endl;
         std::exit(0);
     }
+
+    m_CheckFpReg = variables.count("check-fp-reg") > 0;
+    m_CheckMemoryEvent = variables.count("check-memory-event") > 0;
+    m_RealignEnabled = variables.count("realign") > 0;
+    m_BisectEnabled = variables.count("bisect") > 0;
+
+    if (m_BisectEnabled)
+    {
+        if (m_ExpectCommand.empty() || m_ActualCommand.empty())
+        {
+            std::cout << "--bisect requires --expect-command and --actual-command." << std::endl;
+            std::exit(1);
+        }
+        if (!trace::IsTraceIndexPath(m_ExpectPath) || !trace::IsTraceIndexPath(m_ActualPath))
+        {
+            // rafi-emu writes <path base>.tidx for --dump-path, so other traces can not be regenerated at the same paths.
+            std::cout << "--bisect requires .tidx for expect and actual traces." << std::endl;
+            std::exit(1);
+        }
+        if (m_DigestInterval <= 0)
+        {
+            std::cout << "--digest-interval must be positive." << std::endl;
+            std::exit(1);
+        }
+    }
 }
 
 const std::string& CommandLineOption::GetExpectPath() const
@@ -86,4 +124,54 @@ int CommandLineOption::GetThreshold() const
     return m_Threshold;
 }
 
+int CommandLineOption::GetJobCount() const
+{
+    return m_JobCount;
+}
+
+bool CommandLineOption::IsFpRegCheckEnabled() const
+{
+    return m_CheckFpReg;
+}
+
+bool CommandLineOption::IsMemoryEventCheckEnabled() const
+{
+    return m_CheckMemoryEvent;
+}
+
+bool CommandLineOption::IsBisectEnabled() const
+{
+    return m_BisectEnabled;
+}
+
+const std::string& CommandLineOption::GetExpectCommand() const
+{
+    return m_ExpectCommand;
+}
+
+const std::string& CommandLineOption::GetActualCommand() const
+{
+    return m_ActualCommand;
+}
+
+int CommandLineOption::GetDigestInterval() const
+{
+    return m_DigestInterval;
+}
+
+bool CommandLineOption::IsRealignEnabled() const
+{
+    return m_RealignEnabled;
+}
+
+int CommandLineOption::GetRealignWindow() const
+{
+    return m_RealignWindow;
+}
+
+int CommandLineOption::GetRealignRange() const
+{
+    return m_RealignRange;
+}
+
 }
@@ -32,6 +32,19 @@ public:
 
     int GetCycleCount() const;
     int GetThreshold() const;
+    int GetJobCount() const;
+
+    bool IsFpRegCheckEnabled() const;
+    bool IsMemoryEventCheckEnabled() const;
+
+    bool IsBisectEnabled() const;
+    const std::string& GetExpectCommand() const;
+    const std::string& GetActualCommand() const;
+    int GetDigestInterval() const;
+
+    bool IsRealignEnabled() const;
+    int GetRealignWindow() const;
+    int GetRealignRange() const;
 
 private:
     std::string m_ExpectPath;
@@ -39,6 +52,19 @@ private:
 
     int m_CycleCount{ 0 };
     int m_Threshold{ 0 };
+    int m_JobCount{ 0 };
+
+    bool m_CheckFpReg{ false };
+    bool m_CheckMemoryEvent{ false };
+
+    bool m_BisectEnabled{ false };
+    std::string m_ExpectCommand;
+    std::string m_ActualCommand;
+    int m_DigestInterval{ 0 };
+
+    bool m_RealignEnabled{ false };
+    int m_RealignWindow{ 0 };
+    int m_RealignRange{ 0 };
 };
 
 }
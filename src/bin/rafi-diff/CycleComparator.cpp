@@ -26,6 +26,19 @@
 
 namespace rafi {
 
+namespace {
+    bool IsSameMemoryEvent(const trace::MemoryEvent& a, const trace::MemoryEvent& b)
+    {
+        return a.accessType == b.accessType && a.size == b.size && a.value == b.value && a.vaddr == b.vaddr && a.paddr == b.paddr;
+    }
+}
+
+CycleComparator::CycleComparator(bool checkFpReg, bool checkMemoryEvent)
+    : m_CheckFpReg(checkFpReg)
+    , m_CheckMemoryEvent(checkMemoryEvent)
+{
+}
+
 bool CycleComparator::IsPcMatched(const trace::ICycle* expect, const trace::ICycle* actual) const
 {
     return expect->GetPc() == actual->GetPc();
@@ -38,9 +51,49 @@ bool CycleComparator::IsIntRegMatched(const trace::ICycle* expect, const trace::
         return false;
     }
 
-    for (int i = 0; i < IntRegCount; i++)
+    uint64_t expectRegs[IntRegCount];
+    uint64_t actualRegs[IntRegCount];
+
+    expect->CopyIntRegs(expectRegs);
+    actual->CopyIntRegs(actualRegs);
+
+    return std::memcmp(expectRegs, actualRegs, sizeof(expectRegs)) == 0;
+}
+
+bool CycleComparator::IsFpRegMatched(const trace::ICycle* expect, const trace::ICycle* actual) const
+{
+    if (!expect->IsFpRegExist() || !actual->IsFpRegExist())
     {
-        if (expect->GetIntReg(i) != actual->GetIntReg(i))
+        return false;
+    }
+
+    uint64_t expectRegs[FpRegCount];
+    uint64_t actualRegs[FpRegCount];
+
+    expect->CopyFpRegs(expectRegs);
+    actual->CopyFpRegs(actualRegs);
+
+    return std::memcmp(expectRegs, actualRegs, sizeof(expectRegs)) == 0;
+}
+
+bool CycleComparator::IsMemoryEventMatched(const trace::ICycle* expect, const trace::ICycle* actual) const
+{
+    const auto count = expect->GetMemoryEventCount();
+
+    if (count != actual->GetMemoryEventCount())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        trace::MemoryEvent expectEvent;
+        trace::MemoryEvent actualEvent;
+
+        expect->CopyMemoryEvent(&expectEvent, i);
+        actual->CopyMemoryEvent(&actualEvent, i);
+
+        if (!IsSameMemoryEvent(expectEvent, actualEvent))
         {
             return false;
         }
@@ -61,6 +114,16 @@ bool CycleComparator::IsMatched(const trace::ICycle* expect, const trace::ICycle
         return false;
     }
 
+    if (m_CheckFpReg && !IsFpRegMatched(expect, actual))
+    {
+        return false;
+    }
+
+    if (m_CheckMemoryEvent && !IsMemoryEventMatched(expect, actual))
+    {
+        return false;
+    }
+
     return true;
 }
 
@@ -96,6 +159,58 @@ void CycleComparator::PrintDiffIntReg(const trace::ICycle* expect, const trace::
     }
 }
 
+void CycleComparator::PrintDiffFpReg(const trace::ICycle* expect, const trace::ICycle* actual) const
+{
+    if (!expect->IsFpRegExist())
+    {
+        printf("    - expect has no FpRegNode.\n");
+    }
+
+    if (!actual->IsFpRegExist())
+    {
+        printf("    - actual has no FpRegNode.\n");
+    }
+
+    if (expect->IsFpRegExist() && actual->IsFpRegExist())
+    {
+        for (int i = 0; i < FpRegCount; i++)
+        {
+            if (expect->GetFpReg(i) != actual->GetFpReg(i))
+            {
+                printf("    - f%d not matched (expect:0x%" PRIx64 ", actual:0x%" PRIx64 ")\n", i, expect->GetFpReg(i), actual->GetFpReg(i));
+            }
+        }
+    }
+}
+
+void CycleComparator::PrintDiffMemoryEvent(const trace::ICycle* expect, const trace::ICycle* actual) const
+{
+    const auto expectCount = expect->GetMemoryEventCount();
+    const auto actualCount = actual->GetMemoryEventCount();
+
+    if (expectCount != actualCount)
+    {
+        printf("    - number of memory events not matched (expect:%zu, actual:%zu)\n", expectCount, actualCount);
+    }
+
+    for (size_t i = 0; i < expectCount && i < actualCount; i++)
+    {
+        trace::MemoryEvent e;
+        trace::MemoryEvent a;
+
+        expect->CopyMemoryEvent(&e, i);
+        actual->CopyMemoryEvent(&a, i);
+
+        if (!IsSameMemoryEvent(e, a))
+        {
+            printf("    - memory event %zu not matched (expect:%s size:%" PRIu32 " value:0x%" PRIx64 " vaddr:0x%" PRIx64 " paddr:0x%" PRIx64 ", actual:%s size:%" PRIu32 " value:0x%" PRIx64 " vaddr:0x%" PRIx64 " paddr:0x%" PRIx64 ")\n",
+                i,
+                GetString(e.accessType), e.size, e.value, e.vaddr, e.paddr,
+                GetString(a.accessType), a.size, a.value, a.vaddr, a.paddr);
+        }
+    }
+}
+
 void CycleComparator::PrintDiff(const trace::ICycle* expect, const trace::ICycle* actual) const
 {
     if (!IsPcMatched(expect, actual))
@@ -108,6 +223,16 @@ void CycleComparator::PrintDiff(const trace::ICycle* expect, const trace::ICycle
     {
         PrintDiffIntReg(expect, actual);
     }
+
+    if (m_CheckFpReg && !IsFpRegMatched(expect, actual))
+    {
+        PrintDiffFpReg(expect, actual);
+    }
+
+    if (m_CheckMemoryEvent && !IsMemoryEventMatched(expect, actual))
+    {
+        PrintDiffMemoryEvent(expect, actual);
+    }
 }
 
 }
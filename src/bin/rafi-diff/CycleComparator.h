@@ -22,20 +22,31 @@
 
 namespace rafi {
 
+// Registers are compared as whole arrays with memcmp. Per register getters are used only to print diff.
 class CycleComparator final
 {
 public:
+    CycleComparator(bool checkFpReg, bool checkMemoryEvent);
+
     // compare
     bool IsPcMatched(const trace::ICycle* expect, const trace::ICycle* actual) const;
     bool IsIntRegMatched(const trace::ICycle* expect, const trace::ICycle* actual) const;
+    bool IsFpRegMatched(const trace::ICycle* expect, const trace::ICycle* actual) const;
+    bool IsMemoryEventMatched(const trace::ICycle* expect, const trace::ICycle* actual) const;
 
     bool IsMatched(const trace::ICycle* expect, const trace::ICycle* actual) const;
 
     // print diff
     void PrintDiffPc(const trace::ICycle* expect, const trace::ICycle* actual) const;
     void PrintDiffIntReg(const trace::ICycle* expect, const trace::ICycle* actual) const;
+    void PrintDiffFpReg(const trace::ICycle* expect, const trace::ICycle* actual) const;
+    void PrintDiffMemoryEvent(const trace::ICycle* expect, const trace::ICycle* actual) const;
 
     void PrintDiff(const trace::ICycle* expect, const trace::ICycle* actual) const;
+
+private:
+    bool m_CheckFpReg;
+    bool m_CheckMemoryEvent;
 };
 
 }
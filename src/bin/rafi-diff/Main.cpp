@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
@@ -22,26 +23,72 @@
 
 #include <rafi/trace.h>
 
+#include "Bisector.h"
 #include "CommandLineOption.h"
 #include "CycleComparator.h"
+#include "ParallelComparator.h"
+#include "Realigner.h"
 
 using namespace rafi::trace;
 
 namespace rafi {
 
-void CompareTrace(ITraceReader* expect, ITraceReader* actual, const CommandLineOption& option)
+namespace {
+    const int ProgressInterval = 100000;
+
+    // Stretches of cycles skipped by realignment
+    struct Divergence
+    {
+        int expectBegin;
+        int expectCount;
+        int actualBegin;
+        int actualCount;
+    };
+
+    void PrintDivergence(const Divergence& divergence)
+    {
+        std::cout << "    - expect: skip " << std::dec << divergence.expectCount << " cycles from 0x" << std::hex << divergence.expectBegin << " (" << std::dec << divergence.expectBegin << ")." << std::endl;
+        std::cout << "    - actual: skip " << std::dec << divergence.actualCount << " cycles from 0x" << std::hex << divergence.actualBegin << " (" << std::dec << divergence.actualBegin << ")." << std::endl;
+    }
+}
+
+// Moves both readers to the first mismatched cycle found by ParallelComparator.
+// Output is the same as comparing from the beginning, because cycles before startCycle are all matched.
+void SkipMatchedCycles(ITraceReader* expect, ITraceReader* actual, int startCycle)
+{
+    if (startCycle > 0)
+    {
+        // Next(cycle) can not move to the end of trace, so the last cycle is skipped by Next().
+        expect->Next(startCycle - 1);
+        expect->Next();
+        actual->Next(startCycle - 1);
+        actual->Next();
+    }
+
+    for (int i = ProgressInterval; i < startCycle; i += ProgressInterval)
+    {
+        std::cout << "Compare " << std::dec << i << " cycles." << std::endl;
+    }
+}
+
+// startCycle is the cycle number of the current position of readers.
+// firstCycle is the cycle number of the first cycle in traces, which is not 0 for traces of a bisected window.
+void CompareTrace(ITraceReader* expect, ITraceReader* actual, const CommandLineOption& option, int startCycle, int firstCycle)
 {
     const int StopComparationThreshold = option.GetThreshold();
 
-    CycleComparator comparator;
+    CycleComparator comparator(option.IsFpRegCheckEnabled(), option.IsMemoryEventCheckEnabled());
+
+    Realigner realigner(option.GetExpectPath(), option.GetActualPath(), option.GetRealignWindow(), option.GetRealignRange());
+    std::vector<Divergence> divergences;
 
     int continuousUnmatchCount = 0;
 
-    int checkOpCount = 0;
-    int expectOpCount = 0;
-    int actualOpCount = 0;
+    int checkOpCount = startCycle;
+    int expectOpCount = startCycle;
+    int actualOpCount = startCycle;
 
-    for (int i = 0; i < option.GetCycleCount(); i++)
+    for (int i = startCycle; i < option.GetCycleCount(); i++)
     {
         if (expect->IsEnd() || actual->IsEnd())
         {
@@ -62,6 +109,64 @@ void CompareTrace(ITraceReader* expect, ITraceReader* actual, const CommandLineO
             expectOpCount++;
             actualOpCount++;
         }
+        else if (option.IsRealignEnabled())
+        {
+            std::cout << "Detect mismatched cycle." << std::endl;
+            std::cout << "    - expect: 0x" << std::hex << expectOpCount << " (" << std::dec << expectOpCount << ") cycle." << std::endl;
+            std::cout << "    - actual: 0x" << std::hex << actualOpCount << " (" << std::dec << actualOpCount << ") cycle." << std::endl;
+
+            comparator.PrintDiff(expectCycle, actualCycle);
+
+            uint64_t expectSkip;
+            uint64_t actualSkip;
+
+            if (comparator.IsPcMatched(expectCycle, actualCycle))
+            {
+                // Control flow is the same but data is not, so realignment does not help.
+                std::cout << "Proceed both." << std::endl;
+
+                if (++continuousUnmatchCount == StopComparationThreshold)
+                {
+                    std::cout << "==========================================" << std::endl;
+                    std::cout << "STOP: detect " << std::dec << StopComparationThreshold << " contiguous unmatced cycles" << std::endl;
+                    break;
+                }
+
+                expect->Next();
+                actual->Next();
+                expectOpCount++;
+                actualOpCount++;
+            }
+            else if (realigner.FindAnchor(expectOpCount - firstCycle, actualOpCount - firstCycle, &expectSkip, &actualSkip))
+            {
+                const Divergence divergence { expectOpCount, static_cast<int>(expectSkip), actualOpCount, static_cast<int>(actualSkip) };
+
+                std::cout << "Realign traces." << std::endl;
+                PrintDivergence(divergence);
+
+                divergences.push_back(divergence);
+                continuousUnmatchCount = 0;
+
+                // The anchor is followed by windowSize cycles, so skipping never reaches the end of trace.
+                if (expectSkip > 0)
+                {
+                    expect->Next(static_cast<uint32_t>(expectSkip));
+                }
+                if (actualSkip > 0)
+                {
+                    actual->Next(static_cast<uint32_t>(actualSkip));
+                }
+
+                expectOpCount += divergence.expectCount;
+                actualOpCount += divergence.actualCount;
+            }
+            else
+            {
+                std::cout << "==========================================" << std::endl;
+                std::cout << "STOP: failed to realign traces in " << std::dec << option.GetRealignRange() << " cycles" << std::endl;
+                break;
+            }
+        }
         else
         {
             std::cout << "Detect mismatched cycle." << std::endl;
@@ -82,12 +187,22 @@ void CompareTrace(ITraceReader* expect, ITraceReader* actual, const CommandLineO
             actualOpCount++;
         }
 
-        if (i > 0 && i % 100000 == 0)
+        if (i > 0 && i % ProgressInterval == 0)
         {
             std::cout << "Compare " << std::dec << i << " cycles." << std::endl;
         }
     }
 
+    if (!divergences.empty())
+    {
+        std::cout << "Realigned " << std::dec << divergences.size() << " divergences." << std::endl;
+
+        for (const auto& divergence: divergences)
+        {
+            PrintDivergence(divergence);
+        }
+    }
+
     std::cout << "Comparation finished." << std::endl;
     std::cout << "    - expect: 0x" << std::hex << expectOpCount << " (" << std::dec << expectOpCount << ") ops." << std::endl;
     std::cout << "    - actual: 0x" << std::hex << actualOpCount << " (" << std::dec << actualOpCount << ") ops." << std::endl;
@@ -99,18 +214,57 @@ int main(int argc, char** argv)
 {
     rafi::CommandLineOption option(argc, argv);
 
-    auto expect = rafi::trace::MakeTraceReader(option.GetExpectPath());
-    auto actual = rafi::trace::MakeTraceReader(option.GetActualPath());
-
     try
     {
-        rafi::CompareTrace(expect.get(), actual.get(), option);
+        int startCycle = 0;
+
+        if (option.IsBisectEnabled())
+        {
+            rafi::Bisector bisector(option);
+
+            if (!bisector.Run(&startCycle))
+            {
+                return 0;
+            }
+
+            // Traces of the window begin at startCycle.
+            auto expect = rafi::trace::MakeTraceReader(option.GetExpectPath());
+            auto actual = rafi::trace::MakeTraceReader(option.GetActualPath());
+
+            rafi::CompareTrace(expect.get(), actual.get(), option, startCycle, startCycle);
+            return 0;
+        }
+
+        auto expect = rafi::trace::MakeTraceReader(option.GetExpectPath());
+        auto actual = rafi::trace::MakeTraceReader(option.GetActualPath());
+
+        if (option.GetJobCount() != 1)
+        {
+            if (rafi::trace::IsTraceIndexPath(option.GetExpectPath()) && rafi::trace::IsTraceIndexPath(option.GetActualPath()))
+            {
+                rafi::ParallelComparator comparator(option);
+
+                startCycle = static_cast<int>(comparator.FindFirstMismatch(std::max(option.GetCycleCount(), 0)));
+            }
+            else
+            {
+                std::cout << "Parallel comparison is supported only for .tidx traces. Compare sequentially." << std::endl;
+            }
+        }
+
+        rafi::SkipMatchedCycles(expect.get(), actual.get(), startCycle);
+        rafi::CompareTrace(expect.get(), actual.get(), option, startCycle, 0);
     }
     catch (const TraceException& e)
     {
         e.PrintMessage();
         return 1;
     }
+    catch (const rafi::FileOpenFailureException& e)
+    {
+        e.PrintMessage();
+        return 1;
+    }
 
     return 0;
 }
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include <rafi/trace.h>
+
+#include "CycleComparator.h"
+#include "ParallelComparator.h"
+
+namespace rafi {
+
+namespace {
+    // Interval of cycles to check whether a mismatch is found before the current range by another worker.
+    const uint64_t CancelCheckInterval = 4096;
+}
+
+ParallelComparator::ParallelComparator(const CommandLineOption& option)
+    : m_Option(option)
+    , m_ExpectPath(option.GetExpectPath())
+    , m_ActualPath(option.GetActualPath())
+    , m_JobCount(option.GetJobCount() > 0 ? option.GetJobCount() : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1))
+{
+}
+
+uint64_t ParallelComparator::FindFirstMismatch(uint64_t maxCycleCount)
+{
+    const auto expectBoundaries = GetFileBoundaries(m_ExpectPath);
+    const auto actualBoundaries = GetFileBoundaries(m_ActualPath);
+
+    const auto limit = std::min({ expectBoundaries.back(), actualBoundaries.back(), maxCycleCount });
+
+    // Split at boundaries of both traces, so that a range is in a single data file of each trace.
+    std::vector<uint64_t> boundaries;
+    std::merge(expectBoundaries.begin(), expectBoundaries.end(), actualBoundaries.begin(), actualBoundaries.end(), std::back_inserter(boundaries));
+
+    m_Ranges = trace::SplitCycleRange(0, limit, boundaries, MaxRangeCycleCount);
+
+    if (limit > 0)
+    {
+        trace::EnsureSeekIndex(m_ExpectPath);
+        trace::EnsureSeekIndex(m_ActualPath);
+    }
+
+    m_NextRange = 0;
+    m_FirstMismatch = limit;
+    m_Exception = nullptr;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < m_JobCount; i++)
+    {
+        workers.emplace_back([this] { WorkerMain(); });
+    }
+
+    for (auto& worker: workers)
+    {
+        worker.join();
+    }
+
+    if (m_Exception)
+    {
+        std::rethrow_exception(m_Exception);
+    }
+
+    return m_FirstMismatch;
+}
+
+// Returns cycles at the beginning of data files and the total number of cycles.
+std::vector<uint64_t> ParallelComparator::GetFileBoundaries(const std::string& path)
+{
+    std::vector<uint64_t> boundaries { 0 };
+
+    for (const auto& entry : trace::ReadTraceIndexFile(path.c_str()))
+    {
+        boundaries.push_back(boundaries.back() + entry.cycleCount);
+    }
+
+    return boundaries;
+}
+
+void ParallelComparator::WorkerMain()
+{
+    try
+    {
+        CycleComparator comparator(m_Option.IsFpRegCheckEnabled(), m_Option.IsMemoryEventCheckEnabled());
+
+        std::unique_ptr<trace::ITraceReader> expect;
+        std::unique_ptr<trace::ITraceReader> actual;
+        uint64_t position = 0;
+
+        // Each worker takes ranges in ascending order, so readers only move forward.
+        for (;;)
+        {
+            const auto rangeIndex = m_NextRange++;
+            if (rangeIndex >= m_Ranges.size())
+            {
+                return;
+            }
+
+            const auto& range = m_Ranges[rangeIndex];
+            if (range.begin >= m_FirstMismatch)
+            {
+                return;
+            }
+
+            if (!expect)
+            {
+                expect = trace::MakeTraceReader(m_ExpectPath);
+                actual = trace::MakeTraceReader(m_ActualPath);
+            }
+
+            if (position < range.begin)
+            {
+                expect->Next(static_cast<uint32_t>(range.begin - position));
+                actual->Next(static_cast<uint32_t>(range.begin - position));
+                position = range.begin;
+            }
+
+            for (; position < range.end; position++)
+            {
+                if (position % CancelCheckInterval == 0 && position >= m_FirstMismatch)
+                {
+                    return;
+                }
+
+                if (!comparator.IsMatched(expect->GetCycle(), actual->GetCycle()))
+                {
+                    // Ranges taken later by this worker are all after the mismatch.
+                    UpdateFirstMismatch(position);
+                    return;
+                }
+
+                expect->Next();
+                actual->Next();
+            }
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (!m_Exception)
+        {
+            m_Exception = std::current_exception();
+        }
+
+        // Stop other workers.
+        m_FirstMismatch = 0;
+    }
+}
+
+void ParallelComparator::UpdateFirstMismatch(uint64_t cycle)
+{
+    auto current = m_FirstMismatch.load();
+
+    while (cycle < current && !m_FirstMismatch.compare_exchange_weak(current, cycle))
+    {
+    }
+}
+
+}
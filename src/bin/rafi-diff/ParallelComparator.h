@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <rafi/trace.h>
+
+#include "CommandLineOption.h"
+
+namespace rafi {
+
+// Finds the first cycle where expect and actual traces are not matched when they are compared in lockstep.
+// Both traces are split at data file boundaries of .tidx, and the ranges are compared on worker threads.
+class ParallelComparator final
+{
+public:
+    explicit ParallelComparator(const CommandLineOption& option);
+
+    // Returns index of the first mismatched cycle, or the number of cycles compared if all cycles are matched.
+    // Cycles are compared up to the end of the shorter trace or maxCycleCount.
+    uint64_t FindFirstMismatch(uint64_t maxCycleCount);
+
+private:
+    static constexpr uint64_t MaxRangeCycleCount = 1024 * 1024;
+
+    static std::vector<uint64_t> GetFileBoundaries(const std::string& path);
+
+    void WorkerMain();
+    void UpdateFirstMismatch(uint64_t cycle);
+
+    const CommandLineOption& m_Option;
+    std::string m_ExpectPath;
+    std::string m_ActualPath;
+    int m_JobCount;
+
+    std::vector<trace::CycleRange> m_Ranges;
+    std::atomic<size_t> m_NextRange{ 0 };
+    std::atomic<uint64_t> m_FirstMismatch{ 0 };
+
+    std::mutex m_Mutex;
+    std::exception_ptr m_Exception;
+};
+
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+#include <rafi/trace.h>
+
+#include "Realigner.h"
+
+namespace rafi {
+
+namespace {
+    const uint64_t HashBase = 0x100000001b3;
+
+    uint64_t MakeKey(uint64_t pc, uint32_t insn)
+    {
+        return (pc ^ (static_cast<uint64_t>(insn) << 17)) * 0x9e3779b97f4a7c15;
+    }
+}
+
+Realigner::Realigner(const std::string& expectPath, const std::string& actualPath, int windowSize, int searchRange)
+    : m_ExpectPath(expectPath)
+    , m_ActualPath(actualPath)
+    , m_WindowSize(static_cast<size_t>(std::max(windowSize, 1)))
+    , m_SearchRange(static_cast<size_t>(std::max(searchRange, windowSize)))
+{
+}
+
+bool Realigner::FindAnchor(uint64_t expectCycle, uint64_t actualCycle, uint64_t* pOutExpectSkip, uint64_t* pOutActualSkip)
+{
+    Open(&m_Expect, m_ExpectPath, expectCycle);
+    Open(&m_Actual, m_ActualPath, actualCycle);
+
+    for (auto range = std::min(InitialSearchRange, m_SearchRange);; range = std::min(range * 2, m_SearchRange))
+    {
+        Extend(&m_Expect, range);
+        Extend(&m_Actual, range);
+
+        uint64_t expectSkip = 0;
+        uint64_t actualSkip = 0;
+
+        const auto found = Search(&expectSkip, &actualSkip);
+
+        // A better anchor skips less than the found one in both traces. It is in the current range
+        // if windows from every cycle before the found skip sum are loaded, so a larger range gives the same anchor.
+        if (range == m_SearchRange || (found && expectSkip + actualSkip + m_WindowSize <= range))
+        {
+            *pOutExpectSkip = expectSkip;
+            *pOutActualSkip = actualSkip;
+            return found;
+        }
+    }
+}
+
+bool Realigner::Search(uint64_t* pOutExpectSkip, uint64_t* pOutActualSkip) const
+{
+    // Earliest window of actual for each hash
+    std::unordered_map<uint64_t, size_t> actualWindows;
+    actualWindows.reserve(m_Actual.hash.size());
+
+    for (size_t j = 0; j < m_Actual.hash.size(); j++)
+    {
+        actualWindows.emplace(m_Actual.hash[j], j);
+    }
+
+    auto bestSum = SIZE_MAX;
+
+    // For each window of expect, the earliest window of actual gives the least skip. Stop when expect skip alone exceeds the best.
+    for (size_t i = 0; i < m_Expect.hash.size() && i < bestSum; i++)
+    {
+        const auto it = actualWindows.find(m_Expect.hash[i]);
+        if (it == actualWindows.end())
+        {
+            continue;
+        }
+
+        const auto j = it->second;
+
+        if (i + j < bestSum && IsSameWindow(i, j))
+        {
+            bestSum = i + j;
+            *pOutExpectSkip = i;
+            *pOutActualSkip = j;
+        }
+    }
+
+    return bestSum != SIZE_MAX;
+}
+
+void Realigner::Open(Stream* pOut, const std::string& path, uint64_t cycle)
+{
+    pOut->reader = trace::MakeTraceReader(path);
+    pOut->reader->Next(static_cast<uint32_t>(cycle));
+
+    pOut->pc.clear();
+    pOut->insn.clear();
+    pOut->hash.clear();
+}
+
+// Loads (pc, insn) of cycles up to cycleCount from the position given to Open(), and hashes of windows beginning at each cycle.
+// Cycles loaded by previous calls are kept, so growing the search range decodes each cycle once.
+void Realigner::Extend(Stream* pStream, size_t cycleCount)
+{
+    const auto oldCount = pStream->pc.size();
+
+    if (oldCount < cycleCount && !pStream->reader->IsEnd())
+    {
+        m_Batch.Clear();
+        pStream->reader->ReadBatch(&m_Batch, cycleCount - oldCount);
+
+        for (size_t i = 0; i < m_Batch.GetCycleCount(); i++)
+        {
+            pStream->pc.push_back(m_Batch.pc[i]);
+            pStream->insn.push_back((m_Batch.flags[i] & trace::CycleBatchFlag_Op) != 0 ? m_Batch.insn[i] : 0);
+        }
+    }
+
+    const auto count = pStream->pc.size();
+    if (count < m_WindowSize)
+    {
+        return;
+    }
+
+    // Polynomial rolling hash: hash of window [i, i + w) is key[i] * B^(w-1) + ... + key[i + w - 1]
+    uint64_t power = 1;
+    for (size_t i = 1; i < m_WindowSize; i++)
+    {
+        power *= HashBase;
+    }
+
+    uint64_t hash;
+
+    if (pStream->hash.empty())
+    {
+        hash = 0;
+        for (size_t i = 0; i < m_WindowSize; i++)
+        {
+            hash = hash * HashBase + MakeKey(pStream->pc[i], pStream->insn[i]);
+        }
+
+        pStream->hash.push_back(hash);
+    }
+    else
+    {
+        hash = pStream->hash.back();
+    }
+
+    // Window beginning at hash.size() ends at hash.size() + w - 1.
+    for (size_t i = pStream->hash.size() + m_WindowSize - 1; i < count; i++)
+    {
+        const auto removed = i - m_WindowSize;
+
+        hash = (hash - MakeKey(pStream->pc[removed], pStream->insn[removed]) * power) * HashBase + MakeKey(pStream->pc[i], pStream->insn[i]);
+        pStream->hash.push_back(hash);
+    }
+}
+
+bool Realigner::IsSameWindow(size_t expectIndex, size_t actualIndex) const
+{
+    return std::equal(&m_Expect.pc[expectIndex], &m_Expect.pc[expectIndex] + m_WindowSize, &m_Actual.pc[actualIndex])
+        && std::equal(&m_Expect.insn[expectIndex], &m_Expect.insn[expectIndex] + m_WindowSize, &m_Actual.insn[actualIndex]);
+}
+
+}
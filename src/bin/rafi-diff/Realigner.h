@@ -0,0 +1,66 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <rafi/trace.h>
+
+namespace rafi {
+
+// Finds where expect and actual traces are aligned again after control flow diverged (e.g. an interrupt inserted in actual).
+// Windows of (pc, insn) are hashed with a rolling hash, so the search is near-linear in the search range.
+// The search range starts small and is doubled up to searchRange, so a short divergence does not decode searchRange cycles.
+class Realigner final
+{
+public:
+    Realigner(const std::string& expectPath, const std::string& actualPath, int windowSize, int searchRange);
+
+    // Finds the anchor, i.e. the pair of cycles from which windowSize cycles have the same (pc, insn) in both traces,
+    // minimizing the sum of skipped cycles. Returns false if no anchor is found in searchRange cycles from both positions.
+    bool FindAnchor(uint64_t expectCycle, uint64_t actualCycle, uint64_t* pOutExpectSkip, uint64_t* pOutActualSkip);
+
+private:
+    static constexpr size_t InitialSearchRange = 4 * 1024;
+
+    struct Stream
+    {
+        std::unique_ptr<trace::ITraceReader> reader;
+        std::vector<uint64_t> pc;
+        std::vector<uint32_t> insn;
+        std::vector<uint64_t> hash;
+    };
+
+    void Open(Stream* pOut, const std::string& path, uint64_t cycle);
+    void Extend(Stream* pStream, size_t cycleCount);
+    bool Search(uint64_t* pOutExpectSkip, uint64_t* pOutActualSkip) const;
+    bool IsSameWindow(size_t expectIndex, size_t actualIndex) const;
+
+    std::string m_ExpectPath;
+    std::string m_ActualPath;
+    size_t m_WindowSize;
+    size_t m_SearchRange;
+
+    Stream m_Expect;
+    Stream m_Actual;
+    trace::CycleBatch m_Batch;
+};
+
+}
@@ -30,6 +30,7 @@ namespace rafi { namespace dump {
 namespace {
     static const int DefaultCycleCount = 1000 * 1000 * 1000;
     static const int DefaultCycleEnd = DefaultCycleCount;
+    static const int DefaultJobCount = 1;
 }
 
 CommandLineOption::CommandLineOption(int argc, char** argv)
@@ -41,8 +42,9 @@ CommandLineOption::CommandLineOption(int argc, char** argv)
         ("begin,b", po::value<int>(&m_CycleBegin)->default_value(0), "cycle to begin printing")
         ("count,c", po::value<int>(&m_CycleCount)->default_value(DefaultCycleCount), "number of cycles to print")
         ("end,e", po::value<int>(&m_CycleEnd)->default_value(DefaultCycleEnd), "cycle to end printing")
-        ("filter,f", po::value<std::string>(&m_FilterDescription), "description of cycle print filter")
+        ("filter,f", po::value<std::string>(&m_FilterDescription), "cycle print filter, <command>:<address> or expression (e.g. \"pc >= 0x80200000 && store && paddr in [0x80000000, 0x80001000) && priv == S\")")
         ("input,i", po::value<std::string>(&m_Path), "input trace binary path")
+        ("jobs,j", po::value<int>(&m_JobCount)->default_value(DefaultJobCount), "number of threads to scan .tidx trace with filter (0: number of cores)")
         ("mode,m", po::value<std::string>(&mode), "output mode (text, json or pc)")
         ("help,h", "show help");
 
@@ -116,4 +118,9 @@ const int CommandLineOption::GetCycleEnd() const
     return m_CycleEnd;
 }
 
+const int CommandLineOption::GetJobCount() const
+{
+    return m_JobCount;
+}
+
 }}
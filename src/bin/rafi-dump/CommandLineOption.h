@@ -35,6 +35,7 @@ public:
     const int GetCycleBegin() const;
     const int GetCycleCount() const;
     const int GetCycleEnd() const;
+    const int GetJobCount() const;
 
 private:
     trace::PrinterType m_PrinterType;
@@ -45,6 +46,7 @@ private:
     int m_CycleBegin;
     int m_CycleCount;
     int m_CycleEnd;
+    int m_JobCount;
 };
 
 }}
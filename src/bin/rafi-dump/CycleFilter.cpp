@@ -29,6 +29,20 @@ bool DefaultFilter::Apply(const trace::ICycle* pCycle) const
     return true;
 }
 
+void DefaultFilter::Apply(const trace::CycleBatch& batch, std::vector<size_t>* pOutIndices) const
+{
+    for (size_t i = 0; i < batch.GetCycleCount(); i++)
+    {
+        pOutIndices->push_back(i);
+    }
+}
+
+bool DefaultFilter::MayMatch(const trace::TraceFileSummary& summary) const
+{
+    (void)summary;
+    return true;
+}
+
 PcFilter::PcFilter(uint64_t address, bool isPhysical)
     : m_Address(address)
     , m_IsPhysical(isPhysical)
@@ -42,6 +56,24 @@ bool PcFilter::Apply(const trace::ICycle* pCycle) const
     return pCycle->GetPc() == m_Address;
 }
 
+void PcFilter::Apply(const trace::CycleBatch& batch, std::vector<size_t>* pOutIndices) const
+{
+    assert(!m_IsPhysical);
+
+    for (size_t i = 0; i < batch.GetCycleCount(); i++)
+    {
+        if (batch.pc[i] == m_Address)
+        {
+            pOutIndices->push_back(i);
+        }
+    }
+}
+
+bool PcFilter::MayMatch(const trace::TraceFileSummary& summary) const
+{
+    return summary.pcMin <= m_Address && m_Address <= summary.pcMax;
+}
+
 MemoryAccessFilter::MemoryAccessFilter(uint64_t address, bool isPhysical, bool checkLoad, bool checkStore)
     : m_Address(address)
     , m_IsPhysical(isPhysical)
@@ -59,30 +91,177 @@ bool MemoryAccessFilter::Apply(const trace::ICycle* pCycle) const
         trace::MemoryEvent e;
         pCycle->CopyMemoryEvent(&e, i);
 
-        const auto address = m_IsPhysical ? e.paddr : e.vaddr;
-        const bool addressIncluded = (address <= m_Address && m_Address < address + e.size);
+        if (IsMatched(e.accessType, e.size, e.vaddr, e.paddr))
+        {
+            return true;
+        }
+    }
 
-        switch (e.accessType)
+    return false;
+}
+
+void MemoryAccessFilter::Apply(const trace::CycleBatch& batch, std::vector<size_t>* pOutIndices) const
+{
+    // Memory events are stored in ascending order of cycle index, so a cycle is matched by its first matched event only.
+    bool matched = false;
+    size_t lastIndex = 0;
+
+    for (size_t i = 0; i < batch.GetMemoryEventCount(); i++)
+    {
+        const size_t index = batch.memCycleIndex[i];
+
+        if (matched && index == lastIndex)
         {
-        case MemoryAccessType::Instruction:
-        case MemoryAccessType::Load:
-            if (m_CheckLoad && addressIncluded)
-            {
-                return true;
-            }
-            break;
-        case MemoryAccessType::Store:
-            if (m_CheckStore && addressIncluded)
+            continue;
+        }
+
+        if (IsMatched(batch.memAccessType[i], batch.memSize[i], batch.memVaddr[i], batch.memPaddr[i]))
+        {
+            pOutIndices->push_back(index);
+
+            matched = true;
+            lastIndex = index;
+        }
+    }
+}
+
+bool MemoryAccessFilter::MayMatch(const trace::TraceFileSummary& summary) const
+{
+    if (summary.memoryEventCount == 0)
+    {
+        return false;
+    }
+
+    // Summary has the range of physical addresses only.
+    return !m_IsPhysical || (summary.paddrMin <= m_Address && m_Address <= summary.paddrMax);
+}
+
+bool MemoryAccessFilter::IsMatched(MemoryAccessType accessType, uint32_t size, uint64_t vaddr, uint64_t paddr) const
+{
+    const auto address = m_IsPhysical ? paddr : vaddr;
+    const bool addressIncluded = (address <= m_Address && m_Address < address + size);
+
+    switch (accessType)
+    {
+    case MemoryAccessType::Instruction:
+    case MemoryAccessType::Load:
+        return m_CheckLoad && addressIncluded;
+    case MemoryAccessType::Store:
+        return m_CheckStore && addressIncluded;
+    default:
+        return false;
+    }
+}
+
+ExpressionFilter::ExpressionFilter(const std::string& expression)
+    : m_Program(expression)
+{
+}
+
+bool ExpressionFilter::Apply(const trace::ICycle* pCycle) const
+{
+    FilterContext context {};
+
+    context.pc = pCycle->GetPc();
+    context.hasOp = pCycle->GetOpEventCount() > 0;
+    context.hasTrap = pCycle->GetTrapEventCount() > 0;
+
+    if (context.hasOp)
+    {
+        trace::OpEvent e;
+        pCycle->CopyOpEvent(&e, 0);
+
+        context.insn = e.insn;
+        context.priv = static_cast<uint64_t>(e.priv);
+    }
+
+    const auto count = m_Program.IsMemoryEventReferred() ? pCycle->GetMemoryEventCount() : 0;
+
+    if (count == 0)
+    {
+        return m_Program.Evaluate(context);
+    }
+
+    context.hasMemory = true;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        trace::MemoryEvent e;
+        pCycle->CopyMemoryEvent(&e, i);
+
+        context.accessType = e.accessType;
+        context.size = e.size;
+        context.value = e.value;
+        context.vaddr = e.vaddr;
+        context.paddr = e.paddr;
+
+        if (m_Program.Evaluate(context))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ExpressionFilter::Apply(const trace::CycleBatch& batch, std::vector<size_t>* pOutIndices) const
+{
+    const bool memoryEventReferred = m_Program.IsMemoryEventReferred();
+
+    FilterContext context {};
+
+    // Memory events are stored in ascending order of cycle index.
+    size_t event = 0;
+
+    for (size_t i = 0; i < batch.GetCycleCount(); i++)
+    {
+        context.pc = batch.pc[i];
+        context.hasOp = (batch.flags[i] & trace::CycleBatchFlag_Op) != 0;
+        context.hasTrap = (batch.flags[i] & trace::CycleBatchFlag_Trap) != 0;
+        context.insn = batch.insn[i];
+        context.priv = static_cast<uint64_t>(batch.priv[i]);
+        context.hasMemory = false;
+
+        const auto eventBegin = event;
+        while (event < batch.GetMemoryEventCount() && batch.memCycleIndex[event] == i)
+        {
+            event++;
+        }
+
+        bool matched = false;
+
+        if (!memoryEventReferred || eventBegin == event)
+        {
+            matched = m_Program.Evaluate(context);
+        }
+        else
+        {
+            context.hasMemory = true;
+
+            for (auto j = eventBegin; j < event && !matched; j++)
             {
-                return true;
+                context.accessType = batch.memAccessType[j];
+                context.size = batch.memSize[j];
+                context.value = batch.memValue[j];
+                context.vaddr = batch.memVaddr[j];
+                context.paddr = batch.memPaddr[j];
+
+                matched = m_Program.Evaluate(context);
             }
-            break;
-        default:
-            break;
+        }
+
+        if (matched)
+        {
+            pOutIndices->push_back(i);
         }
     }
+}
 
-    return false;
+bool ExpressionFilter::MayMatch(const trace::TraceFileSummary& summary) const
+{
+    // Compiled program can not be evaluated on ranges, so data files are never skipped.
+    (void)summary;
+    return true;
 }
 
 std::unique_ptr<IFilter> MakeFilter(const std::string& description)
@@ -92,6 +271,19 @@ std::unique_ptr<IFilter> MakeFilter(const std::string& description)
         return std::unique_ptr<IFilter>(new DefaultFilter());
     }
 
+    if (description.find(':') == std::string::npos)
+    {
+        try
+        {
+            return std::unique_ptr<IFilter>(new ExpressionFilter(description));
+        }
+        catch (const FilterSyntaxException& e)
+        {
+            e.PrintMessage(description);
+            std::exit(1);
+        }
+    }
+
     // Parse description as <command>:<value>
     const char delimiter = ':';
 
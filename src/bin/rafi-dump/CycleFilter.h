@@ -18,9 +18,12 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <rafi/trace.h>
 
+#include "FilterExpression.h"
+
 namespace rafi { namespace dump {
 
 class IFilter
@@ -28,12 +31,20 @@ class IFilter
 public:
     virtual ~IFilter(){}
     virtual bool Apply(const trace::ICycle* pCycle) const = 0;
+
+    // Appends indices of matched cycles in the batch in ascending order.
+    virtual void Apply(const trace::CycleBatch& batch, std::vector<size_t>* pOutIndices) const = 0;
+
+    // Returns false if no cycle in the data file of the summary can be matched, i.e. the data file can be skipped.
+    virtual bool MayMatch(const trace::TraceFileSummary& summary) const = 0;
 };
 
 class DefaultFilter : public IFilter
 {
 public:
     virtual bool Apply(const trace::ICycle* pCycle) const override;
+    virtual void Apply(const trace::CycleBatch& batch, std::vector<size_t>* pOutIndices) const override;
+    virtual bool MayMatch(const trace::TraceFileSummary& summary) const override;
 };
 
 class PcFilter : public IFilter
@@ -42,6 +53,8 @@ public:
     PcFilter(uint64_t address, bool isPhysical);
 
     virtual bool Apply(const trace::ICycle* pCycle) const override;
+    virtual void Apply(const trace::CycleBatch& batch, std::vector<size_t>* pOutIndices) const override;
+    virtual bool MayMatch(const trace::TraceFileSummary& summary) const override;
 
 private:
     uint64_t m_Address;
@@ -54,14 +67,32 @@ public:
     MemoryAccessFilter(uint64_t address, bool isPhysical, bool checkLoad, bool checkStore);
 
     virtual bool Apply(const trace::ICycle* pCycle) const override;
+    virtual void Apply(const trace::CycleBatch& batch, std::vector<size_t>* pOutIndices) const override;
+    virtual bool MayMatch(const trace::TraceFileSummary& summary) const override;
 
 private:
+    bool IsMatched(MemoryAccessType accessType, uint32_t size, uint64_t vaddr, uint64_t paddr) const;
+
     uint64_t m_Address{ 0 };
     bool m_IsPhysical{ false };
     bool m_CheckLoad{ false };
     bool m_CheckStore{ false };
 };
 
+class ExpressionFilter : public IFilter
+{
+public:
+    explicit ExpressionFilter(const std::string& expression);
+
+    virtual bool Apply(const trace::ICycle* pCycle) const override;
+    virtual void Apply(const trace::CycleBatch& batch, std::vector<size_t>* pOutIndices) const override;
+    virtual bool MayMatch(const trace::TraceFileSummary& summary) const override;
+
+private:
+    FilterProgram m_Program;
+};
+
+// description is either <command>:<address> (e.g. "SP:80001000") or a filter expression (see FilterProgram).
 std::unique_ptr<IFilter> MakeFilter(const std::string& description);
 
 }}
@@ -0,0 +1,494 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include "FilterExpression.h"
+
+namespace rafi { namespace dump {
+
+void FilterSyntaxException::PrintMessage(const std::string& expression) const
+{
+    std::cerr << "[FilterSyntaxException] " << m_pMessage << std::endl;
+    std::cerr << "    " << expression << std::endl;
+    std::cerr << "    " << std::string(m_Position, ' ') << "^" << std::endl;
+}
+
+struct FilterProgram::Node
+{
+    enum class Kind
+    {
+        Test,
+        Not,
+        And,
+        Or,
+    };
+
+    Kind kind;
+    Instruction test;
+    std::vector<std::unique_ptr<Node>> children;
+
+    // Tests of memory event fields cost more, since they are evaluated for every memory event.
+    int GetCost() const
+    {
+        if (kind == Kind::Test)
+        {
+            return IsMemoryField(test.field) ? 2 : 1;
+        }
+
+        int cost = 0;
+        for (const auto& child: children)
+        {
+            cost += child->GetCost();
+        }
+        return cost;
+    }
+};
+
+class FilterProgram::Parser final
+{
+public:
+    explicit Parser(const std::string& expression)
+        : m_Expression(expression)
+    {
+    }
+
+    std::unique_ptr<Node> Parse()
+    {
+        auto node = ParseOr();
+
+        SkipSpace();
+        if (m_Position != m_Expression.size())
+        {
+            throw FilterSyntaxException("Unexpected token.", m_Position);
+        }
+
+        return node;
+    }
+
+private:
+    std::unique_ptr<Node> ParseOr()
+    {
+        return ParseBinary(Node::Kind::Or, "||", [this] { return ParseAnd(); });
+    }
+
+    std::unique_ptr<Node> ParseAnd()
+    {
+        return ParseBinary(Node::Kind::And, "&&", [this] { return ParseUnary(); });
+    }
+
+    template <typename F>
+    std::unique_ptr<Node> ParseBinary(Node::Kind kind, const char* token, F parseOperand)
+    {
+        auto first = parseOperand();
+
+        if (!Accept(token))
+        {
+            return first;
+        }
+
+        auto node = MakeNode(kind);
+        node->children.push_back(std::move(first));
+
+        do
+        {
+            node->children.push_back(parseOperand());
+        } while (Accept(token));
+
+        // Operands have no side effects, so cheaper ones can be evaluated first.
+        std::stable_sort(node->children.begin(), node->children.end(),
+            [](const std::unique_ptr<Node>& a, const std::unique_ptr<Node>& b) { return a->GetCost() < b->GetCost(); });
+
+        return node;
+    }
+
+    std::unique_ptr<Node> ParseUnary()
+    {
+        if (Accept("!"))
+        {
+            auto node = MakeNode(Node::Kind::Not);
+            node->children.push_back(ParseUnary());
+            return node;
+        }
+
+        if (Accept("("))
+        {
+            auto node = ParseOr();
+            Expect(")");
+            return node;
+        }
+
+        const auto position = m_Position;
+        const auto name = ReadWord();
+
+        auto node = MakeNode(Node::Kind::Test);
+        auto& test = node->test;
+
+        test.opCode = OpCode::Test;
+
+        if (name == "op" || name == "trap" || name == "fetch" || name == "load" || name == "store")
+        {
+            test.field = name == "op" ? Field::Op
+                : name == "trap" ? Field::Trap
+                : name == "fetch" ? Field::Fetch
+                : name == "load" ? Field::Load
+                : Field::Store;
+            test.compare = Compare::Flag;
+            return node;
+        }
+
+        test.field = ParseField(name, position);
+
+        if (Accept("in"))
+        {
+            Expect("[");
+            test.value0 = ParseNumber();
+            Expect(",");
+            test.value1 = ParseNumber();
+
+            // [a, b] is not converted to [a, b + 1), which would be empty if b is the maximum value.
+            if (Accept("]"))
+            {
+                test.compare = Compare::InClosedRange;
+            }
+            else
+            {
+                Expect(")");
+                test.compare = Compare::InRange;
+            }
+            return node;
+        }
+
+        test.compare = Accept("==") ? Compare::Equal
+            : Accept("!=") ? Compare::NotEqual
+            : Accept("<=") ? Compare::LessEqual
+            : Accept(">=") ? Compare::GreaterEqual
+            : Accept("<") ? Compare::Less
+            : Accept(">") ? Compare::Greater
+            : throw FilterSyntaxException("Comparison operator or 'in' is expected.", m_Position);
+
+        test.value0 = ParseNumber();
+        return node;
+    }
+
+    Field ParseField(const std::string& name, size_t position)
+    {
+        if (name == "pc") return Field::Pc;
+        if (name == "insn") return Field::Insn;
+        if (name == "priv") return Field::Priv;
+        if (name == "size") return Field::Size;
+        if (name == "value") return Field::Value;
+        if (name == "vaddr") return Field::Vaddr;
+        if (name == "paddr") return Field::Paddr;
+
+        throw FilterSyntaxException("Unknown field or flag.", position);
+    }
+
+    uint64_t ParseNumber()
+    {
+        SkipSpace();
+
+        const auto position = m_Position;
+        const auto word = ReadWord();
+
+        if (word == "U")
+        {
+            return static_cast<uint64_t>(PrivilegeLevel::User);
+        }
+        else if (word == "S")
+        {
+            return static_cast<uint64_t>(PrivilegeLevel::Supervisor);
+        }
+        else if (word == "M")
+        {
+            return static_cast<uint64_t>(PrivilegeLevel::Machine);
+        }
+
+        char* end;
+        errno = 0;
+        const auto value = std::strtoull(word.c_str(), &end, 0);
+
+        if (word.empty() || *end != '\0')
+        {
+            throw FilterSyntaxException("Number is expected.", position);
+        }
+        if (errno == ERANGE)
+        {
+            throw FilterSyntaxException("Number is out of range.", position);
+        }
+
+        return value;
+    }
+
+    std::string ReadWord()
+    {
+        SkipSpace();
+
+        const auto begin = m_Position;
+        while (m_Position < m_Expression.size() && (std::isalnum(static_cast<unsigned char>(m_Expression[m_Position])) || m_Expression[m_Position] == '_'))
+        {
+            m_Position++;
+        }
+
+        if (begin == m_Position)
+        {
+            throw FilterSyntaxException("Field, flag or number is expected.", m_Position);
+        }
+
+        return m_Expression.substr(begin, m_Position - begin);
+    }
+
+    bool Accept(const char* token)
+    {
+        SkipSpace();
+
+        const std::string s(token);
+
+        if (m_Expression.compare(m_Position, s.size(), s) != 0)
+        {
+            return false;
+        }
+
+        // Keywords must not be a prefix of a longer word, and '!' must not be a part of '!='.
+        const auto next = m_Position + s.size();
+        if (std::isalpha(static_cast<unsigned char>(s[0])) && next < m_Expression.size() && std::isalnum(static_cast<unsigned char>(m_Expression[next])))
+        {
+            return false;
+        }
+        if (s == "!" && next < m_Expression.size() && m_Expression[next] == '=')
+        {
+            return false;
+        }
+
+        m_Position = next;
+        return true;
+    }
+
+    void Expect(const char* token)
+    {
+        if (!Accept(token))
+        {
+            throw FilterSyntaxException(token[0] == ')' ? "')' is expected." : token[0] == ']' ? "']' is expected." : token[0] == '[' ? "'[' is expected." : "',' is expected.", m_Position);
+        }
+    }
+
+    void SkipSpace()
+    {
+        while (m_Position < m_Expression.size() && std::isspace(static_cast<unsigned char>(m_Expression[m_Position])))
+        {
+            m_Position++;
+        }
+    }
+
+    static std::unique_ptr<Node> MakeNode(Node::Kind kind)
+    {
+        auto node = std::make_unique<Node>();
+        node->kind = kind;
+        node->test = Instruction {};
+        return node;
+    }
+
+    const std::string& m_Expression;
+    size_t m_Position {0};
+};
+
+FilterProgram::FilterProgram(const std::string& expression)
+{
+    Parser parser(expression);
+
+    const auto root = parser.Parse();
+
+    Emit(*root);
+}
+
+bool FilterProgram::IsMemoryEventReferred() const
+{
+    return m_MemoryEventReferred;
+}
+
+bool FilterProgram::Evaluate(const FilterContext& context) const
+{
+    bool result = false;
+
+    for (size_t i = 0; i < m_Code.size();)
+    {
+        const auto& instruction = m_Code[i];
+
+        switch (instruction.opCode)
+        {
+        case OpCode::Test:
+            result = Test(instruction, context);
+            i++;
+            break;
+        case OpCode::Not:
+            result = !result;
+            i++;
+            break;
+        case OpCode::JumpIfFalse:
+            i = result ? i + 1 : instruction.target;
+            break;
+        case OpCode::JumpIfTrue:
+            i = result ? instruction.target : i + 1;
+            break;
+        default:
+            RAFI_NOT_IMPLEMENTED;
+        }
+    }
+
+    return result;
+}
+
+bool FilterProgram::IsMemoryField(Field field)
+{
+    switch (field)
+    {
+    case Field::Size:
+    case Field::Value:
+    case Field::Vaddr:
+    case Field::Paddr:
+    case Field::Fetch:
+    case Field::Load:
+    case Field::Store:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool FilterProgram::Test(const Instruction& instruction, const FilterContext& context)
+{
+    uint64_t value;
+
+    switch (instruction.field)
+    {
+    case Field::Pc:
+        value = context.pc;
+        break;
+    case Field::Insn:
+        if (!context.hasOp)
+        {
+            return false;
+        }
+        value = context.insn;
+        break;
+    case Field::Priv:
+        if (!context.hasOp)
+        {
+            return false;
+        }
+        value = context.priv;
+        break;
+    case Field::Op:
+        return context.hasOp;
+    case Field::Trap:
+        return context.hasTrap;
+    case Field::Fetch:
+        return context.hasMemory && context.accessType == MemoryAccessType::Instruction;
+    case Field::Load:
+        return context.hasMemory && context.accessType == MemoryAccessType::Load;
+    case Field::Store:
+        return context.hasMemory && context.accessType == MemoryAccessType::Store;
+    default:
+        if (!context.hasMemory)
+        {
+            return false;
+        }
+        value = instruction.field == Field::Size ? context.size
+            : instruction.field == Field::Value ? context.value
+            : instruction.field == Field::Vaddr ? context.vaddr
+            : context.paddr;
+        break;
+    }
+
+    switch (instruction.compare)
+    {
+    case Compare::Equal:
+        return value == instruction.value0;
+    case Compare::NotEqual:
+        return value != instruction.value0;
+    case Compare::Less:
+        return value < instruction.value0;
+    case Compare::LessEqual:
+        return value <= instruction.value0;
+    case Compare::Greater:
+        return value > instruction.value0;
+    case Compare::GreaterEqual:
+        return value >= instruction.value0;
+    case Compare::InRange:
+        return instruction.value0 <= value && value < instruction.value1;
+    case Compare::InClosedRange:
+        return instruction.value0 <= value && value <= instruction.value1;
+    default:
+        RAFI_NOT_IMPLEMENTED;
+    }
+}
+
+void FilterProgram::Emit(const Node& node)
+{
+    switch (node.kind)
+    {
+    case Node::Kind::Test:
+        m_Code.push_back(node.test);
+        m_MemoryEventReferred |= IsMemoryField(node.test.field);
+        break;
+    case Node::Kind::Not:
+    {
+        Emit(*node.children[0]);
+
+        Instruction instruction;
+        instruction.opCode = OpCode::Not;
+        m_Code.push_back(instruction);
+        break;
+    }
+    case Node::Kind::And:
+    case Node::Kind::Or:
+    {
+        // The result of the operand which ends evaluation is the result of the whole node.
+        const auto jump = node.kind == Node::Kind::And ? OpCode::JumpIfFalse : OpCode::JumpIfTrue;
+
+        std::vector<size_t> jumps;
+
+        for (size_t i = 0; i < node.children.size(); i++)
+        {
+            Emit(*node.children[i]);
+
+            if (i + 1 < node.children.size())
+            {
+                Instruction instruction;
+                instruction.opCode = jump;
+
+                jumps.push_back(m_Code.size());
+                m_Code.push_back(instruction);
+            }
+        }
+
+        for (const auto index: jumps)
+        {
+            m_Code[index].target = static_cast<uint32_t>(m_Code.size());
+        }
+        break;
+    }
+    default:
+        RAFI_NOT_IMPLEMENTED;
+    }
+}
+
+}}
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rafi/common.h>
+
+namespace rafi { namespace dump {
+
+class FilterSyntaxException
+{
+public:
+    FilterSyntaxException(const char* pMessage, size_t position)
+        : m_pMessage(pMessage)
+        , m_Position(position)
+    {
+    }
+
+    void PrintMessage(const std::string& expression) const;
+
+    // Position of the error in the expression
+    size_t GetPosition() const
+    {
+        return m_Position;
+    }
+
+private:
+    const char* m_pMessage;
+    size_t m_Position;
+};
+
+// Values of a cycle, and of one of its memory events if hasMemory is true, which are referred by filter expressions.
+// insn and priv are valid only if hasOp is true.
+struct FilterContext
+{
+    uint64_t pc;
+    uint64_t insn;
+    uint64_t priv;
+    bool hasOp;
+    bool hasTrap;
+
+    bool hasMemory;
+    MemoryAccessType accessType;
+    uint64_t size;
+    uint64_t value;
+    uint64_t vaddr;
+    uint64_t paddr;
+};
+
+// Filter expression compiled into flat bytecode.
+//   expr    := and ('||' and)*
+//   and     := unary ('&&' unary)*
+//   unary   := '!' unary | '(' expr ')' | flag | field compare number | field 'in' '[' number ',' number (')' | ']')
+//   flag    := op | trap | fetch | load | store
+//   field   := pc | insn | priv | size | value | vaddr | paddr
+//   compare := '==' | '!=' | '<' | '<=' | '>' | '>='
+//   number  := decimal | 0x<hex> | U | S | M
+// Ranges of cycles are specified by --begin and --end rather than by expressions.
+// Memory event flags and fields refer to a single memory event. A cycle is matched if the expression is true for any of
+// its memory events, or for the cycle alone if it has no memory events.
+// Operands of && and || are reordered so that tests of cycle fields are evaluated before tests of memory event fields.
+class FilterProgram final
+{
+public:
+    explicit FilterProgram(const std::string& expression);
+
+    bool IsMemoryEventReferred() const;
+    bool Evaluate(const FilterContext& context) const;
+
+private:
+    enum class OpCode : uint8_t
+    {
+        Test,
+        Not,
+        JumpIfFalse,
+        JumpIfTrue,
+    };
+
+    enum class Field : uint8_t
+    {
+        Pc,
+        Insn,
+        Priv,
+        Size,
+        Value,
+        Vaddr,
+        Paddr,
+        Op,
+        Trap,
+        Fetch,
+        Load,
+        Store,
+    };
+
+    enum class Compare : uint8_t
+    {
+        Flag,
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        InRange, // [value0, value1)
+        InClosedRange, // [value0, value1]
+    };
+
+    // Test sets the result register, Not inverts it, and jumps keep it so that && and || are short-circuited.
+    struct Instruction
+    {
+        OpCode opCode {OpCode::Test};
+        Field field {Field::Pc};
+        Compare compare {Compare::Flag};
+        uint32_t target {0};
+        uint64_t value0 {0};
+        uint64_t value1 {0};
+    };
+
+    struct Node;
+    class Parser;
+
+    static bool IsMemoryField(Field field);
+    static bool Test(const Instruction& instruction, const FilterContext& context);
+
+    void Emit(const Node& node);
+
+    std::vector<Instruction> m_Code;
+    bool m_MemoryEventReferred {false};
+};
+
+}}
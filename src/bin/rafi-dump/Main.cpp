@@ -26,6 +26,7 @@
 
 #include "CommandLineOption.h"
 #include "CycleFilter.h"
+#include "ParallelScanner.h"
 
 namespace rafi { namespace dump {
 
@@ -46,6 +47,50 @@ XLEN GetXLEN(const std::string& path)
     }
 }
 
+struct SkippedRange
+{
+    uint64_t begin;
+    uint64_t end;
+};
+
+// Returns ranges of cycles in data files which the filter never matches, by summaries in .tidx.
+// Adjacent ranges are merged. pOutCycleCount is set to the number of cycles in the trace if it is .tidx.
+std::vector<SkippedRange> GetSkippedRanges(uint64_t* pOutCycleCount, const std::string& path, const IFilter* filter)
+{
+    std::vector<SkippedRange> ranges;
+    *pOutCycleCount = UINT64_MAX;
+
+    if (!rafi::trace::IsTraceIndexPath(path))
+    {
+        return ranges;
+    }
+
+    uint64_t fileBegin = 0;
+
+    for (const auto& entry : rafi::trace::ReadTraceIndexFile(path.c_str()))
+    {
+        const auto fileEnd = fileBegin + entry.cycleCount;
+
+        if (entry.hasSummary && !filter->MayMatch(entry.summary))
+        {
+            if (!ranges.empty() && ranges.back().end == fileBegin)
+            {
+                ranges.back().end = fileEnd;
+            }
+            else
+            {
+                ranges.push_back(SkippedRange { fileBegin, fileEnd });
+            }
+        }
+
+        fileBegin = fileEnd;
+    }
+
+    *pOutCycleCount = fileBegin;
+
+    return ranges;
+}
+
 void PrintTrace(const CommandLineOption& option, IFilter* filter)
 {
     auto reader = rafi::trace::MakeTraceReader(option.GetPath());
@@ -54,6 +99,10 @@ void PrintTrace(const CommandLineOption& option, IFilter* filter)
     const int begin = option.GetCycleBegin();
     const int end = std::min(option.GetCycleBegin() + option.GetCycleCount(), option.GetCycleEnd());
 
+    uint64_t cycleCount;
+    const auto skippedRanges = GetSkippedRanges(&cycleCount, option.GetPath(), filter);
+    size_t skippedIndex = 0;
+
     if (begin > 0)
     {
         reader->Next(static_cast<uint32_t>(begin));
@@ -66,6 +115,25 @@ void PrintTrace(const CommandLineOption& option, IFilter* filter)
             return;
         }
 
+        // Jump over data files which the filter never matches.
+        while (skippedIndex < skippedRanges.size() && skippedRanges[skippedIndex].end <= static_cast<uint64_t>(i))
+        {
+            skippedIndex++;
+        }
+
+        if (skippedIndex < skippedRanges.size() && skippedRanges[skippedIndex].begin <= static_cast<uint64_t>(i))
+        {
+            const auto skippedEnd = skippedRanges[skippedIndex].end;
+
+            if (skippedEnd >= static_cast<uint64_t>(end) || skippedEnd >= cycleCount)
+            {
+                return;
+            }
+
+            reader->Next(static_cast<uint32_t>(skippedEnd - i));
+            i = static_cast<int>(skippedEnd);
+        }
+
         if (i >= begin && filter->Apply(reader->GetCycle()))
         {
             printer->Print(reader->GetCycle());
@@ -75,6 +143,31 @@ void PrintTrace(const CommandLineOption& option, IFilter* filter)
     }
 }
 
+void PrintTraceParallel(const CommandLineOption& option, IFilter* filter)
+{
+    auto reader = rafi::trace::MakeTraceReader(option.GetPath());
+    auto printer = rafi::trace::MakeTracePrinter(option.GetPrinterType(), GetXLEN(option.GetPath()));
+
+    const int begin = option.GetCycleBegin();
+    const int end = std::min(option.GetCycleBegin() + option.GetCycleCount(), option.GetCycleEnd());
+
+    ParallelScanner scanner(option.GetPath(), filter, option.GetJobCount());
+
+    // Matched cycles come in ascending order, so the reader for printing only moves forward.
+    uint64_t position = 0;
+
+    scanner.Scan(static_cast<uint64_t>(std::max(begin, 0)), static_cast<uint64_t>(std::max(end, 0)), [&](uint64_t cycle)
+    {
+        if (position < cycle)
+        {
+            reader->Next(static_cast<uint32_t>(cycle - position));
+            position = cycle;
+        }
+
+        printer->Print(reader->GetCycle());
+    });
+}
+
 }}
 
 int main(int argc, char** argv)
@@ -85,7 +178,19 @@ int main(int argc, char** argv)
     {
         auto filter = rafi::dump::MakeFilter(option.GetFilterDescription());
 
-        PrintTrace(option, filter.get());
+        if (option.GetJobCount() != 1 && rafi::trace::IsTraceIndexPath(option.GetPath()))
+        {
+            PrintTraceParallel(option, filter.get());
+        }
+        else
+        {
+            if (option.GetJobCount() != 1)
+            {
+                std::cerr << "Parallel scan is supported only for .tidx traces. Scan sequentially." << std::endl;
+            }
+
+            PrintTrace(option, filter.get());
+        }
     }
     catch (rafi::trace::TraceException e)
     {
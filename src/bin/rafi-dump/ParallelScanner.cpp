@@ -0,0 +1,225 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include <rafi/trace.h>
+
+#include "ParallelScanner.h"
+
+namespace rafi { namespace dump {
+
+ParallelScanner::ParallelScanner(const std::string& path, const IFilter* pFilter, int jobCount)
+    : m_Path(path)
+    , m_pFilter(pFilter)
+    , m_JobCount(jobCount > 0 ? jobCount : std::max(static_cast<int>(std::thread::hardware_concurrency()), 1))
+{
+}
+
+void ParallelScanner::Scan(uint64_t begin, uint64_t end, const std::function<void(uint64_t)>& callback)
+{
+    m_Ranges.clear();
+
+    uint64_t fileBegin = 0;
+
+    for (const auto& entry : trace::ReadTraceIndexFile(m_Path.c_str()))
+    {
+        const auto fileEnd = fileBegin + entry.cycleCount;
+
+        // Data files which the filter never matches are skipped by their summaries.
+        if (!entry.hasSummary || m_pFilter->MayMatch(entry.summary))
+        {
+            for (const auto& range : trace::SplitCycleRange(std::max(fileBegin, begin), std::min(fileEnd, end), {}, MaxRangeCycleCount))
+            {
+                m_Ranges.push_back(Range { range.begin, range.end, {}, false });
+            }
+        }
+
+        fileBegin = fileEnd;
+    }
+
+    if (m_Ranges.empty())
+    {
+        return;
+    }
+
+    trace::EnsureSeekIndex(m_Path);
+
+    m_NextRange = 0;
+    m_Canceled = false;
+    m_ConsumedRangeCount = 0;
+    m_Exception = nullptr;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < m_JobCount; i++)
+    {
+        workers.emplace_back([this] { WorkerMain(); });
+    }
+
+    try
+    {
+        for (size_t i = 0; i < m_Ranges.size(); i++)
+        {
+            std::vector<uint64_t> matchedCycles;
+
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+
+                m_RangeDone.wait(lock, [&] { return m_Ranges[i].done || m_Exception; });
+
+                if (m_Exception)
+                {
+                    break;
+                }
+
+                matchedCycles.swap(m_Ranges[i].matchedCycles);
+
+                m_ConsumedRangeCount = i + 1;
+                m_RangeConsumed.notify_all();
+            }
+
+            for (const auto cycle: matchedCycles)
+            {
+                callback(cycle);
+            }
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (!m_Exception)
+        {
+            m_Exception = std::current_exception();
+        }
+    }
+
+    // Stop workers if the scan is stopped by an exception.
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        m_Canceled = true;
+        m_RangeConsumed.notify_all();
+    }
+
+    for (auto& worker: workers)
+    {
+        worker.join();
+    }
+
+    if (m_Exception)
+    {
+        std::rethrow_exception(m_Exception);
+    }
+}
+
+void ParallelScanner::WorkerMain()
+{
+    try
+    {
+        std::unique_ptr<trace::ITraceReader> reader;
+        uint64_t position = 0;
+
+        // Each worker takes ranges in ascending order, so the reader only moves forward.
+        while (!m_Canceled)
+        {
+            const auto rangeIndex = m_NextRange++;
+            if (rangeIndex >= m_Ranges.size())
+            {
+                return;
+            }
+
+            // Wait while the calling thread is behind, instead of buffering results of the whole trace.
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+
+                const auto maxRangesAhead = RangesAheadPerJob * static_cast<size_t>(m_JobCount);
+
+                m_RangeConsumed.wait(lock, [&] { return rangeIndex < m_ConsumedRangeCount + maxRangesAhead || m_Canceled; });
+
+                if (m_Canceled)
+                {
+                    return;
+                }
+            }
+
+            if (!reader)
+            {
+                reader = trace::MakeTraceReader(m_Path);
+            }
+
+            ScanRange(reader.get(), &position, &m_Ranges[rangeIndex]);
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (!m_Exception)
+        {
+            m_Exception = std::current_exception();
+        }
+
+        m_Canceled = true;
+        m_RangeDone.notify_all();
+        m_RangeConsumed.notify_all();
+    }
+}
+
+void ParallelScanner::ScanRange(trace::ITraceReader* pReader, uint64_t* pPosition, Range* pRange)
+{
+    if (*pPosition < pRange->begin)
+    {
+        pReader->Next(static_cast<uint32_t>(pRange->begin - *pPosition));
+        *pPosition = pRange->begin;
+    }
+
+    trace::CycleBatch batch;
+    std::vector<size_t> indices;
+    std::vector<uint64_t> matchedCycles;
+
+    while (*pPosition < pRange->end && !m_Canceled)
+    {
+        batch.Clear();
+        indices.clear();
+
+        const auto count = pReader->ReadBatch(&batch, static_cast<size_t>(std::min<uint64_t>(BatchSize, pRange->end - *pPosition)));
+        if (count == 0)
+        {
+            break;
+        }
+
+        m_pFilter->Apply(batch, &indices);
+
+        // Cycles are numbered by position in the trace, like PrintTrace() does.
+        for (const auto index: indices)
+        {
+            matchedCycles.push_back(*pPosition + index);
+        }
+
+        *pPosition += count;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    pRange->matchedCycles.swap(matchedCycles);
+    pRange->done = true;
+    m_RangeDone.notify_all();
+}
+
+}}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <rafi/trace.h>
+
+#include "CycleFilter.h"
+
+namespace rafi { namespace dump {
+
+// Finds cycles matched by the filter in a .tidx trace on worker threads.
+// The trace is split at data file boundaries, and each range is read by ReadBatch() and filtered on CycleBatch columns,
+// so that ICycle is built only for matched cycles when they are printed. Data files are skipped by summaries in .tidx.
+class ParallelScanner final
+{
+public:
+    ParallelScanner(const std::string& path, const IFilter* pFilter, int jobCount);
+
+    // Calls callback with matched cycles in [begin, end) in ascending order on the calling thread.
+    // Results of a range are passed as soon as the range and all ranges before it are scanned.
+    // Workers run ahead of the calling thread by at most 2 ranges per job, which bounds memory for buffered results.
+    void Scan(uint64_t begin, uint64_t end, const std::function<void(uint64_t)>& callback);
+
+private:
+    static constexpr uint64_t MaxRangeCycleCount = 256 * 1024;
+    static constexpr size_t BatchSize = 16 * 1024;
+    static constexpr size_t RangesAheadPerJob = 2;
+
+    struct Range
+    {
+        uint64_t begin;
+        uint64_t end;
+        std::vector<uint64_t> matchedCycles;
+        bool done;
+    };
+
+    void WorkerMain();
+    void ScanRange(trace::ITraceReader* pReader, uint64_t* pPosition, Range* pRange);
+
+    std::string m_Path;
+    const IFilter* m_pFilter;
+    int m_JobCount;
+
+    std::vector<Range> m_Ranges;
+    std::atomic<size_t> m_NextRange{ 0 };
+    std::atomic<bool> m_Canceled{ false };
+
+    std::mutex m_Mutex;
+    std::condition_variable m_RangeDone;
+    std::condition_variable m_RangeConsumed;
+    size_t m_ConsumedRangeCount{ 0 };
+    std::exception_ptr m_Exception;
+};
+
+}}
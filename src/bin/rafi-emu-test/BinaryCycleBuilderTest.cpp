@@ -0,0 +1,148 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#pragma warning(push)
+#pragma warning(disable : 4389)
+#include <gtest/gtest.h>
+#pragma warning(pop)
+
+#include <rafi/trace.h>
+
+namespace rafi { namespace trace {
+
+TEST(BinaryCycleBuilderTest, GrowAndReuse)
+{
+    BinaryCycleBuilder builder;
+
+    // Larger than the initial buffer of the builder
+    const int memoryEventCount = 300;
+
+    builder.Reset(1, XLEN::XLEN64, 0x80000000);
+    for (int i = 0; i < memoryEventCount; i++)
+    {
+        builder.Add(MemoryEvent { MemoryAccessType::Store, 8, static_cast<uint64_t>(i), 0x1000u + i * 8, 0x1000u + i * 8 });
+    }
+    builder.Break();
+
+    std::vector<char> first(static_cast<char*>(builder.GetData()), static_cast<char*>(builder.GetData()) + builder.GetDataSize());
+
+    builder.Reset(2, XLEN::XLEN64, 0x80000004);
+    builder.Add(OpEvent { 0x00000013, PrivilegeLevel::Machine });
+    builder.Break();
+
+    std::vector<char> second(static_cast<char*>(builder.GetData()), static_cast<char*>(builder.GetData()) + builder.GetDataSize());
+
+    {
+        TraceBinaryMemoryReader reader(first.data(), first.size());
+
+        const auto pCycle = reader.GetCycle();
+        ASSERT_EQ(1u, pCycle->GetCycle());
+        ASSERT_EQ(static_cast<size_t>(memoryEventCount), pCycle->GetMemoryEventCount());
+
+        MemoryEvent event;
+        pCycle->CopyMemoryEvent(&event, memoryEventCount - 1);
+        ASSERT_EQ(static_cast<uint64_t>(memoryEventCount - 1), event.value);
+    }
+    {
+        TraceBinaryMemoryReader reader(second.data(), second.size());
+
+        const auto pCycle = reader.GetCycle();
+        ASSERT_EQ(2u, pCycle->GetCycle());
+        ASSERT_EQ(0x80000004u, pCycle->GetPc());
+        ASSERT_EQ(0u, pCycle->GetMemoryEventCount());
+        ASSERT_EQ(1u, pCycle->GetOpEventCount());
+    }
+}
+
+TEST(BinaryCycleBuilderTest, ExternalBuffer)
+{
+    const auto size = BinaryCycleBuilder::GetEncodedNodeSize(sizeof(NodeBasic))
+        + BinaryCycleBuilder::GetEncodedNodeSize(sizeof(OpEvent))
+        + BinaryCycleBuilder::GetEncodedNodeSize(0);
+
+    std::vector<char> buffer(size);
+
+    BinaryCycleBuilder builder;
+    builder.Reset(buffer.data(), buffer.size(), 3, XLEN::XLEN32, 0x80000008);
+    builder.Add(OpEvent { 0x00000013, PrivilegeLevel::Machine });
+    builder.Break();
+
+    ASSERT_EQ(buffer.data(), builder.GetData());
+    ASSERT_EQ(size, builder.GetDataSize());
+
+    // External buffer is never grown.
+    builder.Reset(buffer.data(), buffer.size(), 4, XLEN::XLEN32, 0x8000000c);
+    builder.Add(OpEvent { 0x00000013, PrivilegeLevel::Machine });
+    ASSERT_THROW(builder.Add(OpEvent { 0x00000013, PrivilegeLevel::Machine }), TraceException);
+}
+
+TEST(BinaryCycleBuilderTest, RegDelta)
+{
+    NodeIntReg64 intReg0 {};
+    NodeFpReg fpReg0 {};
+    for (int i = 0; i < IntRegCount; i++)
+    {
+        intReg0.regs[i] = 0x100 + i;
+        fpReg0.regs[i].u64.value = 0x200 + i;
+    }
+
+    auto intReg1 = intReg0;
+    auto fpReg1 = fpReg0;
+    intReg1.regs[5] = 0x1234;
+    intReg1.regs[31] = 0x5678;
+
+    std::vector<char> buffer;
+    BinaryCycleBuilder builder;
+
+    builder.Reset(0, XLEN::XLEN64, 0x80000000);
+    builder.Add(intReg0);
+    builder.Add(fpReg0);
+    builder.Break();
+    buffer.insert(buffer.end(), static_cast<char*>(builder.GetData()), static_cast<char*>(builder.GetData()) + builder.GetDataSize());
+
+    builder.Reset(1, XLEN::XLEN64, 0x80000004);
+    builder.AddDelta(intReg1, intReg0);
+    builder.AddDelta(fpReg1, fpReg0);
+    builder.Break();
+
+    // Only 2 integer registers are stored.
+    ASSERT_EQ(BinaryCycleBuilder::GetEncodedNodeSize(sizeof(NodeBasic))
+        + BinaryCycleBuilder::GetEncodedNodeSize(sizeof(NodeRegDelta) + sizeof(uint64_t) * 2)
+        + BinaryCycleBuilder::GetEncodedNodeSize(sizeof(NodeRegDelta))
+        + BinaryCycleBuilder::GetEncodedNodeSize(0), builder.GetDataSize());
+
+    buffer.insert(buffer.end(), static_cast<char*>(builder.GetData()), static_cast<char*>(builder.GetData()) + builder.GetDataSize());
+
+    TraceBinaryMemoryReader reader(buffer.data(), buffer.size());
+    reader.Next();
+
+    const auto pCycle = reader.GetCycle();
+    ASSERT_TRUE(pCycle->IsIntRegExist());
+    ASSERT_TRUE(pCycle->IsFpRegExist());
+
+    for (int i = 0; i < IntRegCount; i++)
+    {
+        ASSERT_EQ(intReg1.regs[i], pCycle->GetIntReg(i));
+        ASSERT_EQ(fpReg1.regs[i].u64.value, pCycle->GetFpReg(i));
+    }
+
+    // Delta node can not be decoded without registers of the previous cycle.
+    ASSERT_THROW(TraceBinaryMemoryReader(static_cast<char*>(builder.GetData()), builder.GetDataSize()), TraceException);
+}
+
+}}
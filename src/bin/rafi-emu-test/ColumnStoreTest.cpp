@@ -0,0 +1,169 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <vector>
+
+#pragma warning(push)
+#pragma warning(disable : 4389)
+#include <gtest/gtest.h>
+#pragma warning(pop)
+
+#include <rafi/trace.h>
+
+namespace rafi { namespace trace {
+
+TEST(ColumnStoreTest, WriteAndQuery)
+{
+    const char* path = "ColumnStoreTest.tcol";
+    const uint32_t cycleCount = 1000;
+
+    {
+        // Small blocks to make many blocks
+        ColumnStoreWriter writer(path, 64);
+        CycleBatch batch;
+
+        // Loop of 10 instructions, and a store to page (i % 3) every 4 cycles.
+        for (uint32_t i = 0; i < cycleCount; i++)
+        {
+            const auto index = batch.AddCycle(i, 0x80000000 + (i % 10) * 4);
+            batch.SetOp(index, OpEvent { 0x00000013 + i, PrivilegeLevel::Supervisor });
+
+            if (i % 4 == 0)
+            {
+                batch.AddMemoryEvent(index, MemoryEvent { MemoryAccessType::Store, 8, i, 0x1000 * (i % 3), 0x80000000 + 0x1000 * (i % 3) });
+            }
+
+            // Write in batches which are not aligned with blocks.
+            if (batch.GetCycleCount() == 100)
+            {
+                writer.Write(batch);
+                batch.Clear();
+            }
+        }
+
+        writer.Close();
+        ASSERT_THROW(writer.Write(batch), TraceException);
+    }
+
+    ColumnStoreReader reader(path);
+
+    ASSERT_EQ(cycleCount, reader.GetRowCount());
+    ASSERT_EQ(cycleCount / 4, reader.GetMemoryEventRowCount());
+    ASSERT_EQ((cycleCount + 63) / 64, reader.GetBlockCount());
+
+    // Columns
+    CycleBatch batch;
+    reader.ReadBlock(&batch, 3);
+
+    const auto& block = reader.GetBlock(3);
+    ASSERT_EQ(192u, block.firstRow);
+    ASSERT_EQ(48u, block.firstMemoryEventRow);
+    ASSERT_EQ(64u, block.cycleCount);
+    ASSERT_EQ(16u, block.memoryEventCount);
+    ASSERT_EQ(0x80000000u, block.pcMin);
+    ASSERT_EQ(0x80000024u, block.pcMax);
+
+    for (uint32_t i = 0; i < block.cycleCount; i++)
+    {
+        ASSERT_EQ(192 + i, batch.cycle[i]);
+        ASSERT_EQ(0x80000000 + ((192 + i) % 10) * 4, batch.pc[i]);
+        ASSERT_EQ(0x00000013 + 192 + i, batch.insn[i]);
+        ASSERT_EQ(PrivilegeLevel::Supervisor, batch.priv[i]);
+        ASSERT_EQ(CycleBatchFlag_Op, batch.flags[i]);
+    }
+
+    ASSERT_EQ(16u, batch.GetMemoryEventCount());
+    ASSERT_EQ(4u, batch.memCycleIndex[1]);
+    ASSERT_EQ(196u, batch.memValue[1]);
+    ASSERT_EQ(0x80000000u + 0x1000 * (196 % 3), batch.memPaddr[1]);
+
+    // Only specified columns are decompressed.
+    reader.ReadBlock(&batch, 3, GetColumnMask(ColumnId_Pc));
+    ASSERT_EQ(64u, batch.pc.size());
+    ASSERT_TRUE(batch.insn.empty());
+
+    // PC index
+    std::vector<uint64_t> rows;
+    reader.FindPc(&rows, 0x8000000c);
+
+    ASSERT_EQ(cycleCount / 10, rows.size());
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        ASSERT_EQ(i * 10 + 3, rows[i]);
+    }
+
+    rows.clear();
+    reader.FindPc(&rows, 0x80000028);
+    ASSERT_TRUE(rows.empty());
+
+    // Page index
+    reader.FindPage(&rows, (0x80000000 + 0x2000) >> ColumnStorePageShift);
+
+    ASSERT_EQ(83u, rows.size());
+    for (const auto row : rows)
+    {
+        const auto blockIndex = reader.FindBlockByMemoryEventRow(row);
+        const auto cycle = reader.GetBlock(blockIndex).firstRow + (row - reader.GetBlock(blockIndex).firstMemoryEventRow) * 4;
+
+        ASSERT_EQ(cycle / 64, blockIndex);
+        ASSERT_EQ(2u, cycle % 3);
+    }
+
+    ASSERT_EQ(15u, reader.FindBlock(999));
+    ASSERT_THROW(reader.FindBlock(1000), TraceException);
+
+    std::remove(path);
+}
+
+TEST(ColumnStoreTest, PageCrossingAccess)
+{
+    const char* path = "ColumnStoreTestCrossing.tcol";
+
+    {
+        ColumnStoreWriter writer(path, 64);
+        CycleBatch batch;
+
+        // Misaligned load which crosses from page 0x80000 to 0x80001, then accesses within a page.
+        batch.AddMemoryEvent(batch.AddCycle(0, 0x80000000), MemoryEvent { MemoryAccessType::Load, 8, 0, 0xffc, 0x80000ffc });
+        batch.AddMemoryEvent(batch.AddCycle(1, 0x80000004), MemoryEvent { MemoryAccessType::Load, 4, 0, 0x1000, 0x80001000 });
+        batch.AddMemoryEvent(batch.AddCycle(2, 0x80000008), MemoryEvent { MemoryAccessType::Store, 2, 0, 0x1ffe, 0x80001ffe });
+
+        writer.Write(batch);
+    }
+
+    ColumnStoreReader reader(path);
+
+    std::vector<uint64_t> rows;
+    reader.FindPage(&rows, 0x80000);
+    ASSERT_EQ((std::vector<uint64_t> { 0 }), rows);
+
+    rows.clear();
+    reader.FindPage(&rows, 0x80001);
+    ASSERT_EQ((std::vector<uint64_t> { 0, 1, 2 }), rows);
+
+    rows.clear();
+    reader.FindPage(&rows, 0x80002);
+    ASSERT_TRUE(rows.empty());
+
+    // Zone map covers the last byte accessed.
+    ASSERT_EQ(0x80000ffcu, reader.GetBlock(0).paddrMin);
+    ASSERT_EQ(0x80001fffu, reader.GetBlock(0).paddrMax);
+
+    std::remove(path);
+}
+
+}}
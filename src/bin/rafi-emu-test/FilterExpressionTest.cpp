@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma warning(push)
+#pragma warning(disable : 4389)
+#include <gtest/gtest.h>
+#pragma warning(pop)
+
+#include "../rafi-dump/FilterExpression.h"
+
+using namespace rafi::dump;
+
+namespace rafi { namespace test {
+
+namespace {
+
+FilterContext MakeContext(uint64_t pc, bool hasOp, bool hasTrap)
+{
+    FilterContext context {};
+
+    context.pc = pc;
+    context.hasOp = hasOp;
+    context.hasTrap = hasTrap;
+    context.priv = static_cast<uint64_t>(PrivilegeLevel::Supervisor);
+
+    return context;
+}
+
+bool Evaluate(const char* expression, const FilterContext& context)
+{
+    return FilterProgram(expression).Evaluate(context);
+}
+
+size_t GetErrorPosition(const char* expression)
+{
+    try
+    {
+        FilterProgram program(expression);
+    }
+    catch (const FilterSyntaxException& e)
+    {
+        return e.GetPosition();
+    }
+
+    return SIZE_MAX;
+}
+
+}
+
+TEST(FilterExpressionTest, Precedence)
+{
+    // && binds tighter than ||.
+    ASSERT_TRUE(Evaluate("op || trap && pc == 1", MakeContext(0, true, false)));
+    ASSERT_TRUE(Evaluate("pc == 1 && op || trap", MakeContext(0, false, true)));
+    ASSERT_FALSE(Evaluate("(op || trap) && pc == 1", MakeContext(0, true, false)));
+
+    // ! binds tighter than && and ||.
+    ASSERT_TRUE(Evaluate("!op && trap", MakeContext(0, false, true)));
+    ASSERT_FALSE(Evaluate("!op && trap", MakeContext(0, true, true)));
+    ASSERT_TRUE(Evaluate("!!op", MakeContext(0, true, false)));
+
+    // !(a && b) || c
+    ASSERT_TRUE(Evaluate("!(op && trap) || pc == 5", MakeContext(0, true, false)));
+    ASSERT_TRUE(Evaluate("!(op && trap) || pc == 5", MakeContext(5, true, true)));
+    ASSERT_FALSE(Evaluate("!(op && trap) || pc == 5", MakeContext(0, true, true)));
+    ASSERT_TRUE(Evaluate("!(op && (trap || pc != 0)) || pc == 5", MakeContext(0, true, false)));
+    ASSERT_FALSE(Evaluate("!(op && (trap || pc != 0)) || pc == 5", MakeContext(1, true, false)));
+}
+
+TEST(FilterExpressionTest, MemoryEvent)
+{
+    auto context = MakeContext(0x80000000, true, false);
+
+    // Reordering operands does not change results.
+    const char* expression = "paddr == 0x1000 && store || pc == 0x80000004 && priv == S";
+    ASSERT_TRUE(FilterProgram(expression).IsMemoryEventReferred());
+    ASSERT_FALSE(FilterProgram("pc == 0 || op").IsMemoryEventReferred());
+
+    ASSERT_FALSE(Evaluate(expression, context));
+
+    context.pc = 0x80000004;
+    ASSERT_TRUE(Evaluate(expression, context));
+
+    context.pc = 0x80000000;
+    context.hasMemory = true;
+    context.accessType = MemoryAccessType::Store;
+    context.paddr = 0x1000;
+    ASSERT_TRUE(Evaluate(expression, context));
+
+    context.accessType = MemoryAccessType::Load;
+    ASSERT_FALSE(Evaluate(expression, context));
+    ASSERT_TRUE(Evaluate("load && !fetch", context));
+
+    // Fields of cycles without op never match.
+    ASSERT_FALSE(Evaluate("insn == 0", MakeContext(0, false, false)));
+}
+
+TEST(FilterExpressionTest, Range)
+{
+    const char* halfOpen = "pc in [0x10, 0x20)";
+    ASSERT_FALSE(Evaluate(halfOpen, MakeContext(0xf, true, false)));
+    ASSERT_TRUE(Evaluate(halfOpen, MakeContext(0x10, true, false)));
+    ASSERT_TRUE(Evaluate(halfOpen, MakeContext(0x1f, true, false)));
+    ASSERT_FALSE(Evaluate(halfOpen, MakeContext(0x20, true, false)));
+
+    const char* closed = "pc in [16, 32]";
+    ASSERT_TRUE(Evaluate(closed, MakeContext(0x20, true, false)));
+    ASSERT_FALSE(Evaluate(closed, MakeContext(0x21, true, false)));
+
+    // The upper bound must not wrap around.
+    const char* max = "pc in [0xfffffffffffffff0, 0xffffffffffffffff]";
+    ASSERT_TRUE(Evaluate(max, MakeContext(UINT64_MAX, true, false)));
+    ASSERT_TRUE(Evaluate(max, MakeContext(UINT64_MAX - 0xf, true, false)));
+    ASSERT_FALSE(Evaluate(max, MakeContext(0, true, false)));
+
+    ASSERT_TRUE(Evaluate("pc >= 0xffffffffffffffff", MakeContext(UINT64_MAX, true, false)));
+}
+
+TEST(FilterExpressionTest, SyntaxError)
+{
+    ASSERT_EQ(SIZE_MAX, GetErrorPosition("op && (trap || pc < 3)"));
+
+    ASSERT_EQ(0u, GetErrorPosition("foo == 1"));
+    ASSERT_EQ(3u, GetErrorPosition("pc = 1"));
+    ASSERT_EQ(5u, GetErrorPosition("pc =="));
+    ASSERT_EQ(6u, GetErrorPosition("pc == x1"));
+    ASSERT_EQ(3u, GetErrorPosition("op trap"));
+    ASSERT_EQ(8u, GetErrorPosition("(op && !)"));
+    ASSERT_EQ(11u, GetErrorPosition("(op || trap"));
+    ASSERT_EQ(6u, GetErrorPosition("pc in 1, 2"));
+    ASSERT_EQ(11u, GetErrorPosition("pc in [1, 2"));
+    ASSERT_EQ(6u, GetErrorPosition("pc == 0x10000000000000000"));
+    ASSERT_EQ(6u, GetErrorPosition("pc == 18446744073709551616"));
+}
+
+}}
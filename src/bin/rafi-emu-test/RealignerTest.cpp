@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#pragma warning(push)
+#pragma warning(disable : 4389)
+#include <gtest/gtest.h>
+#pragma warning(pop)
+
+#include <rafi/trace.h>
+
+#include "../rafi-diff/Realigner.h"
+
+namespace rafi {
+
+namespace {
+
+const uint64_t HandlerPc = 0x90000000;
+
+// Writes a trace whose (pc, insn) of each cycle is given. Every cycle is distinct unless pc is repeated.
+void WriteTrace(const char* pathBase, const std::vector<uint64_t>& pcs)
+{
+    trace::TraceIndexWriter writer(pathBase);
+    trace::BinaryCycleBuilder builder;
+
+    for (size_t i = 0; i < pcs.size(); i++)
+    {
+        builder.Reset(static_cast<uint32_t>(i), XLEN::XLEN64, pcs[i]);
+        builder.Add(trace::OpEvent { static_cast<uint32_t>(pcs[i] >> 2), PrivilegeLevel::Machine });
+        builder.Break();
+
+        writer.Write(builder.GetData(), static_cast<int64_t>(builder.GetDataSize()));
+    }
+}
+
+void RemoveTrace(const std::string& pathBase)
+{
+    std::remove((pathBase + ".tidx").c_str());
+    std::remove((pathBase + ".0.tbin").c_str());
+    std::remove((pathBase + ".tseek").c_str());
+}
+
+// Straight-line code of cycleCount instructions, with handlerCount cycles of a handler inserted at insertAt
+// and deleteCount cycles of the straight-line code deleted at deleteAt.
+std::vector<uint64_t> MakePcs(size_t cycleCount, size_t insertAt, size_t handlerCount, size_t deleteAt, size_t deleteCount)
+{
+    std::vector<uint64_t> pcs;
+
+    for (size_t i = 0; i < cycleCount; i++)
+    {
+        if (i == insertAt)
+        {
+            for (size_t j = 0; j < handlerCount; j++)
+            {
+                pcs.push_back(HandlerPc + j * 4);
+            }
+        }
+
+        if (deleteAt <= i && i < deleteAt + deleteCount)
+        {
+            continue;
+        }
+
+        pcs.push_back(0x80000000 + i * 4);
+    }
+
+    return pcs;
+}
+
+}
+
+TEST(RealignerTest, FindAnchor)
+{
+    const size_t cycleCount = 40000;
+
+    // actual has a handler of 50 cycles inserted at 1000, 30 cycles deleted at 2000, and a handler of 9000 cycles inserted at 3000.
+    auto actualPcs = MakePcs(cycleCount, 1000, 50, 2000, 30);
+    const auto insertAt = 3000 + 50 - 30;
+    for (size_t j = 0; j < 9000; j++)
+    {
+        actualPcs.insert(actualPcs.begin() + insertAt + j, HandlerPc + 0x100000 + j * 4);
+    }
+
+    WriteTrace("RealignerTestExpect", MakePcs(cycleCount, cycleCount, 0, cycleCount, 0));
+    WriteTrace("RealignerTestActual", actualPcs);
+
+    Realigner realigner("RealignerTestExpect.tidx", "RealignerTestActual.tidx", 32, 64 * 1024);
+
+    uint64_t expectSkip;
+    uint64_t actualSkip;
+
+    // Inserted stretch is skipped in actual.
+    ASSERT_TRUE(realigner.FindAnchor(1000, 1000, &expectSkip, &actualSkip));
+    ASSERT_EQ(0u, expectSkip);
+    ASSERT_EQ(50u, actualSkip);
+
+    // Deleted stretch is skipped in expect.
+    ASSERT_TRUE(realigner.FindAnchor(2000, 2050, &expectSkip, &actualSkip));
+    ASSERT_EQ(30u, expectSkip);
+    ASSERT_EQ(0u, actualSkip);
+
+    // Stretch longer than the initial search range is found by growing the range.
+    ASSERT_TRUE(realigner.FindAnchor(3000, 3020, &expectSkip, &actualSkip));
+    ASSERT_EQ(0u, expectSkip);
+    ASSERT_EQ(9000u, actualSkip);
+
+    // Stretch longer than the search range is not found.
+    {
+        Realigner shortRealigner("RealignerTestExpect.tidx", "RealignerTestActual.tidx", 32, 8 * 1024);
+        ASSERT_FALSE(shortRealigner.FindAnchor(3000, 3020, &expectSkip, &actualSkip));
+    }
+
+    RemoveTrace("RealignerTestExpect");
+    RemoveTrace("RealignerTestActual");
+}
+
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+
+#pragma warning(push)
+#pragma warning(disable : 4389)
+#include <gtest/gtest.h>
+#pragma warning(pop)
+
+#include <rafi/trace.h>
+
+namespace rafi { namespace trace {
+
+namespace {
+
+class StubLoggerTarget : public ILoggerTarget
+{
+public:
+    virtual uint32_t GetHostIoValue() const override
+    {
+        return 0;
+    }
+
+    virtual uint64_t GetPc() const override
+    {
+        return pc;
+    }
+
+    virtual void CopyIntReg(NodeIntReg32* pOut) const override
+    {
+        for (int i = 0; i < IntRegCount; i++)
+        {
+            pOut->regs[i] = static_cast<uint32_t>(intReg.regs[i]);
+        }
+    }
+
+    virtual void CopyIntReg(NodeIntReg64* pOut) const override
+    {
+        *pOut = intReg;
+    }
+
+    virtual void CopyFpReg(NodeFpReg* pOut) const override
+    {
+        *pOut = fpReg;
+    }
+
+    virtual const EventList& GetEventList() const override
+    {
+        return eventList;
+    }
+
+    uint64_t pc {0x80000000};
+    NodeIntReg64 intReg {};
+    NodeFpReg fpReg {};
+    EventList eventList;
+};
+
+}
+
+TEST(StateDigestTest, Compute)
+{
+    StubLoggerTarget target;
+    StateDigest digest;
+
+    const auto initial = digest.Compute(XLEN::XLEN64, target);
+    ASSERT_EQ(initial, digest.Compute(XLEN::XLEN64, target));
+
+    target.intReg.regs[31] = 1;
+    const auto intRegChanged = digest.Compute(XLEN::XLEN64, target);
+    ASSERT_NE(initial, intRegChanged);
+
+    target.fpReg.regs[0].u64.value = 1;
+    const auto fpRegChanged = digest.Compute(XLEN::XLEN64, target);
+    ASSERT_NE(intRegChanged, fpRegChanged);
+
+    char page[4096] = {};
+    digest.UpdateMemory(0x80000000, page, sizeof(page));
+    const auto memoryChanged = digest.Compute(XLEN::XLEN64, target);
+    ASSERT_NE(fpRegChanged, memoryChanged);
+
+    // The same contents at a different address make a different digest.
+    StateDigest other;
+    other.UpdateMemory(0x80001000, page, sizeof(page));
+    ASSERT_NE(memoryChanged, other.Compute(XLEN::XLEN64, target));
+}
+
+TEST(StateDigestTest, WriteAndRead)
+{
+    const char* path = "StateDigestTest.tdig";
+
+    {
+        StateDigestWriter writer(path, 100);
+
+        for (uint64_t i = 0; i < 10; i++)
+        {
+            writer.Write(i * 100, i * 3);
+        }
+    }
+
+    StateDigestReader reader(path);
+
+    ASSERT_EQ(100u, reader.GetInterval());
+    ASSERT_EQ(10u, reader.GetCount());
+
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        ASSERT_EQ(i * 100, reader.Get(i).cycle);
+        ASSERT_EQ(i * 3, reader.Get(i).digest);
+    }
+
+    std::remove(path);
+}
+
+}}
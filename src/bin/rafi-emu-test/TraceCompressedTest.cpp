@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+
+#pragma warning(push)
+#pragma warning(disable : 4389)
+#include <gtest/gtest.h>
+#pragma warning(pop)
+
+#include <rafi/trace.h>
+
+namespace rafi { namespace trace {
+
+TEST(TraceCompressedTest, WriteAndRead)
+{
+    const char* path = "TraceCompressedTest.tcz";
+    const uint32_t cycleCount = 1000;
+
+    {
+        // Small blocks to make many blocks
+        TraceCompressedWriter writer(path, 1024, 2);
+        BinaryCycleBuilder builder;
+
+        for (uint32_t i = 0; i < cycleCount; i++)
+        {
+            builder.Reset(i, XLEN::XLEN32, 0x80000000 + i * 4);
+            builder.Add(OpEvent { 0x00000013, PrivilegeLevel::Machine });
+            builder.Break();
+
+            writer.Write(builder.GetData(), static_cast<int64_t>(builder.GetDataSize()));
+        }
+    }
+
+    {
+        TraceCompressedReader reader(path);
+
+        for (uint32_t i = 0; i < cycleCount; i++)
+        {
+            ASSERT_FALSE(reader.IsEnd());
+            ASSERT_EQ(i, reader.GetCycle()->GetCycle());
+            ASSERT_EQ(0x80000000 + i * 4, reader.GetCycle()->GetPc());
+            reader.Next();
+        }
+
+        ASSERT_TRUE(reader.IsEnd());
+    }
+
+    {
+        TraceCompressedReader reader(path);
+
+        reader.Next(500);
+        ASSERT_EQ(500u, reader.GetCycle()->GetCycle());
+
+        reader.Next(1);
+        ASSERT_EQ(501u, reader.GetCycle()->GetCycle());
+
+        reader.Next(498);
+        ASSERT_EQ(999u, reader.GetCycle()->GetCycle());
+
+        ASSERT_THROW(reader.Next(1000), TraceException);
+    }
+
+    std::remove(path);
+}
+
+}}
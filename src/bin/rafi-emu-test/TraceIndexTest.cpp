@@ -0,0 +1,317 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdio>
+
+#pragma warning(push)
+#pragma warning(disable : 4389)
+#include <gtest/gtest.h>
+#pragma warning(pop)
+
+#include <rafi/trace.h>
+
+namespace rafi { namespace trace {
+
+namespace {
+
+void WriteDeltaTrace(const char* pathBase, uint32_t cycleCount, uint32_t keyframeInterval)
+{
+    TraceIndexWriter writer(pathBase);
+    BinaryCycleBuilder builder;
+
+    NodeIntReg64 previous {};
+
+    for (uint32_t i = 0; i < cycleCount; i++)
+    {
+        NodeIntReg64 current {};
+        current.regs[1] = i;
+        current.regs[2] = i / 3;
+
+        builder.Reset(i, XLEN::XLEN64, 0x80000000 + i * 4);
+
+        if (i % keyframeInterval == 0)
+        {
+            builder.Add(current);
+        }
+        else
+        {
+            builder.AddDelta(current, previous);
+        }
+
+        builder.Add(OpEvent { i, PrivilegeLevel::Supervisor });
+
+        if (i % 10 == 0)
+        {
+            builder.Add(MemoryEvent { MemoryAccessType::Load, 8, i, 0x1000 + i, 0x2000 + i });
+        }
+
+        builder.Break();
+
+        writer.Write(builder.GetData(), static_cast<int64_t>(builder.GetDataSize()));
+
+        previous = current;
+    }
+}
+
+void CheckCycle(uint32_t expected, const ICycle* pCycle)
+{
+    ASSERT_EQ(expected, pCycle->GetCycle());
+    ASSERT_EQ(0x80000000 + expected * 4, pCycle->GetPc());
+    ASSERT_EQ(expected, pCycle->GetIntReg(1));
+    ASSERT_EQ(expected / 3, pCycle->GetIntReg(2));
+}
+
+}
+
+TEST(TraceIndexTest, SeekWithDelta)
+{
+    const char* pathBase = "TraceIndexTest";
+    const uint32_t cycleCount = 20000;
+
+    WriteDeltaTrace(pathBase, cycleCount, 100);
+
+    // First pass uses the seek index written by TraceIndexWriter, and second pass uses the one rebuilt from data file.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        TraceIndexReader reader("TraceIndexTest.tidx");
+
+        CheckCycle(0, reader.GetCycle());
+
+        reader.Next(4097);
+        CheckCycle(4097, reader.GetCycle());
+
+        reader.Next(1);
+        CheckCycle(4098, reader.GetCycle());
+
+        reader.Next(10050);
+        CheckCycle(14148, reader.GetCycle());
+
+        reader.Next(cycleCount - 14148 - 1);
+        CheckCycle(cycleCount - 1, reader.GetCycle());
+
+        ASSERT_THROW(reader.Next(1), TraceException);
+
+        std::remove("TraceIndexTest.tseek");
+    }
+
+    std::remove("TraceIndexTest.tidx");
+    std::remove("TraceIndexTest.0.tbin");
+    std::remove("TraceIndexTest.tseek");
+}
+
+TEST(TraceIndexTest, StaleSeekIndex)
+{
+    const char* pathBase = "TraceIndexTestStale";
+    const uint32_t cycleCount = 10000;
+
+    // Regenerate the trace with the same cycle count but different data, and leave the seek index of the old one.
+    WriteDeltaTrace(pathBase, cycleCount, 100);
+    std::rename("TraceIndexTestStale.tseek", "TraceIndexTestStale.old.tseek");
+
+    WriteDeltaTrace(pathBase, cycleCount, 1);
+    std::remove("TraceIndexTestStale.tseek");
+    std::rename("TraceIndexTestStale.old.tseek", "TraceIndexTestStale.tseek");
+
+    {
+        TraceIndexReader reader("TraceIndexTestStale.tidx");
+
+        reader.Next(5001);
+        CheckCycle(5001, reader.GetCycle());
+    }
+
+    std::remove("TraceIndexTestStale.tidx");
+    std::remove("TraceIndexTestStale.0.tbin");
+    std::remove("TraceIndexTestStale.tseek");
+}
+
+TEST(TraceIndexTest, ReadBatch)
+{
+    const char* pathBase = "TraceIndexTestBatch";
+    const uint32_t cycleCount = 5000;
+    const size_t batchSize = 777;
+
+    WriteDeltaTrace(pathBase, cycleCount, 100);
+
+    TraceIndexReader reader("TraceIndexTestBatch.tidx");
+    CycleBatch batch;
+
+    reader.Next(10);
+
+    uint32_t expected = 10;
+
+    while (!reader.IsEnd())
+    {
+        batch.Clear();
+
+        const auto count = reader.ReadBatch(&batch, batchSize);
+        ASSERT_EQ(count, batch.GetCycleCount());
+        ASSERT_EQ(std::min(batchSize, static_cast<size_t>(cycleCount - expected)), count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            ASSERT_EQ(expected + i, batch.cycle[i]);
+            ASSERT_EQ(0x80000000 + (expected + i) * 4, batch.pc[i]);
+            ASSERT_EQ(expected + i, batch.insn[i]);
+            ASSERT_EQ(PrivilegeLevel::Supervisor, batch.priv[i]);
+            ASSERT_EQ(CycleBatchFlag_Op | CycleBatchFlag_IntReg, batch.flags[i]);
+        }
+
+        for (size_t i = 0; i < batch.GetMemoryEventCount(); i++)
+        {
+            const auto cycle = batch.cycle[batch.memCycleIndex[i]];
+
+            ASSERT_EQ(0u, cycle % 10);
+            ASSERT_EQ(0x1000 + cycle, batch.memVaddr[i]);
+            ASSERT_EQ(0x2000 + cycle, batch.memPaddr[i]);
+        }
+
+        expected += static_cast<uint32_t>(count);
+
+        // Reader stops at a cycle whose registers are reconstructed from delta nodes.
+        if (!reader.IsEnd())
+        {
+            CheckCycle(expected, reader.GetCycle());
+        }
+    }
+
+    ASSERT_EQ(cycleCount, expected);
+
+    std::remove("TraceIndexTestBatch.tidx");
+    std::remove("TraceIndexTestBatch.0.tbin");
+    std::remove("TraceIndexTestBatch.tseek");
+}
+
+TEST(TraceIndexTest, Summary)
+{
+    const char* pathBase = "TraceIndexTestSummary";
+    const uint32_t cycleCount = 1000;
+
+    WriteDeltaTrace(pathBase, cycleCount, 100);
+
+    {
+        const auto entries = ReadTraceIndexFile("TraceIndexTestSummary.tidx");
+        ASSERT_EQ(1u, entries.size());
+
+        const auto& entry = entries[0];
+        ASSERT_EQ("TraceIndexTestSummary.0.tbin", entry.path);
+        ASSERT_EQ(cycleCount, entry.cycleCount);
+        ASSERT_TRUE(entry.hasSummary);
+
+        ASSERT_EQ(0u, entry.summary.firstCycle);
+        ASSERT_EQ(cycleCount - 1, entry.summary.lastCycle);
+        ASSERT_EQ(cycleCount, entry.summary.opCount);
+        ASSERT_EQ(0u, entry.summary.trapCount);
+        ASSERT_EQ(cycleCount / 10, entry.summary.memoryEventCount);
+        ASSERT_EQ(0x80000000u, entry.summary.pcMin);
+        ASSERT_EQ(0x80000000u + (cycleCount - 1) * 4, entry.summary.pcMax);
+        ASSERT_EQ(0x2000u, entry.summary.paddrMin);
+        ASSERT_EQ(0x2000u + 990 + 7, entry.summary.paddrMax);
+        ASSERT_FALSE(entry.summary.hasHostIo);
+    }
+
+    // Index files written by older or newer versions
+    {
+        auto fp = std::fopen("TraceIndexTestSummary.tidx", "w");
+        std::fprintf(fp, "a.tbin 10\nb.tbin 20 op=20\nc.tbin 30 op=30 trap=1 mem=0 cycle=0-1d pc=1000-1074 unknown=1\n");
+        std::fclose(fp);
+
+        const auto entries = ReadTraceIndexFile("TraceIndexTestSummary.tidx");
+        ASSERT_EQ(3u, entries.size());
+        ASSERT_EQ(10u, entries[0].cycleCount);
+        ASSERT_FALSE(entries[0].hasSummary);
+
+        // Incomplete summary is ignored.
+        ASSERT_EQ(20u, entries[1].cycleCount);
+        ASSERT_FALSE(entries[1].hasSummary);
+
+        // Unknown fields are ignored.
+        ASSERT_EQ(30u, entries[2].cycleCount);
+        ASSERT_TRUE(entries[2].hasSummary);
+        ASSERT_EQ(1u, entries[2].summary.trapCount);
+        ASSERT_EQ(0x1074u, entries[2].summary.pcMax);
+    }
+
+    std::remove("TraceIndexTestSummary.tidx");
+    std::remove("TraceIndexTestSummary.0.tbin");
+    std::remove("TraceIndexTestSummary.tseek");
+}
+
+TEST(TraceIndexTest, SummaryCycleRange)
+{
+    const char* pathBase = "TraceIndexTestSummaryCycle";
+    const uint32_t cycleCount = 300;
+
+    // rafi-emu writes the cycle limit into every cycle, so the range must not come from basic nodes.
+    {
+        TraceIndexWriter writer(pathBase);
+        BinaryCycleBuilder builder;
+
+        for (uint32_t i = 0; i < cycleCount; i++)
+        {
+            builder.Reset(100000, XLEN::XLEN64, 0x80000000 + i * 4);
+            builder.Add(OpEvent { i, PrivilegeLevel::Machine });
+            builder.Break();
+
+            writer.Write(builder.GetData(), static_cast<int64_t>(builder.GetDataSize()));
+        }
+    }
+
+    const auto entries = ReadTraceIndexFile("TraceIndexTestSummaryCycle.tidx");
+    ASSERT_EQ(1u, entries.size());
+    ASSERT_TRUE(entries[0].hasSummary);
+    ASSERT_EQ(0u, entries[0].summary.firstCycle);
+    ASSERT_EQ(cycleCount - 1, entries[0].summary.lastCycle);
+
+    std::remove("TraceIndexTestSummaryCycle.tidx");
+    std::remove("TraceIndexTestSummaryCycle.0.tbin");
+    std::remove("TraceIndexTestSummaryCycle.tseek");
+}
+
+TEST(TraceIndexTest, SplitCycleRange)
+{
+    ASSERT_TRUE(IsTraceIndexPath("a/b.tidx"));
+    ASSERT_FALSE(IsTraceIndexPath("a/b.tbin"));
+    ASSERT_FALSE(IsTraceIndexPath("tidx"));
+
+    // Split by size only
+    {
+        const auto ranges = SplitCycleRange(5, 30, {}, 10);
+        ASSERT_EQ(3u, ranges.size());
+        ASSERT_EQ(5u, ranges[0].begin);
+        ASSERT_EQ(15u, ranges[0].end);
+        ASSERT_EQ(25u, ranges[2].begin);
+        ASSERT_EQ(30u, ranges[2].end);
+    }
+
+    // Boundaries out of [begin, end) and duplicated boundaries do not make empty ranges.
+    {
+        const auto ranges = SplitCycleRange(10, 40, { 0, 10, 12, 12, 35, 40, 50 }, 20);
+        ASSERT_EQ(4u, ranges.size());
+        ASSERT_EQ(10u, ranges[0].begin);
+        ASSERT_EQ(12u, ranges[0].end);
+        ASSERT_EQ(12u, ranges[1].begin);
+        ASSERT_EQ(32u, ranges[1].end);
+        ASSERT_EQ(32u, ranges[2].begin);
+        ASSERT_EQ(35u, ranges[2].end);
+        ASSERT_EQ(35u, ranges[3].begin);
+        ASSERT_EQ(40u, ranges[3].end);
+    }
+
+    ASSERT_TRUE(SplitCycleRange(10, 10, { 10 }, 20).empty());
+}
+
+}}
@@ -101,16 +101,26 @@ CommandLineOption::CommandLineOption(int argc, char** argv)
     po::options_description desc("options");
     desc.add_options()
         ("cycle", po::value<int>(&m_Cycle)->default_value(0), "number of emulation cycles")
+        ("dump-buffer-size", po::value<size_t>()->default_value(trace::DefaultLoggerBufferSize / 1024 / 1024), "upper bound of memory used for dump (MiB)")
+        ("dump-compress", "output compressed dump file (<dump-path>.tcz)")
+        ("dump-keyframe-interval", po::value<int>()->default_value(trace::DefaultLoggerKeyframeInterval), "number of cycles between full register dumps with --enable-dump-reg-delta")
         ("dump-path", po::value<std::string>(), "path of dump file")
         ("dump-skip-cycle", po::value<int>(&m_DumpSkipCycle)->default_value(0), "number of cycles to skip dump")
         ("enable-dump-fp-reg", "output fp register contents to dump file")
         ("enable-dump-memory", "output memory contents to dump file")
+        ("enable-dump-reg-delta", "output only changed registers to dump file except every keyframe interval")
         ("gdb", po::value<int>(&m_GdbPort), "enable gdb and specify tcp port")
         ("load", po::value<std::vector<std::string>>(), "path of binary file which is loaded to memory")
         ("help", "show help")
         ("host-io-addr", po::value<std::string>(), "host io address (hex)")
+        ("digest-interval", po::value<int>(&m_DigestInterval)->default_value(trace::DefaultStateDigestInterval), "number of cycles between state digests")
+        ("digest-path", po::value<std::string>(&m_DigestPath), "enable state digests and specify path of digest file (.tdig)")
         ("dtb-addr", po::value<std::string>(), "dtb address (hex)")
         ("pc", po::value<std::string>(), "initial program counter value (hex)")
+        ("profile-call-stack", "track guest call stacks and output them in folded format")
+        ("profile-elf", po::value<std::vector<std::string>>(), "path of ELF file whose symbols are used by profiler")
+        ("profile-interval", po::value<int>()->default_value(DefaultProfileInterval), "number of cycles between profiler samples")
+        ("profile-path", po::value<std::string>(), "enable profiler and specify path prefix of profile report")
         ("ram-size", po::value<size_t>(&m_RamSize)->default_value(DefaultRamSize), "ram size (byte)")
         ("xlen", po::value<int>(), "XLEN");
 
@@ -142,12 +152,48 @@ CommandLineOption::CommandLineOption(int argc, char** argv)
         m_LoggerConfig.enableDumpFpReg = variables.count("enable-dump-fp-reg") > 0;
         m_LoggerConfig.enableDumpHostIo = m_HostIoEnabled;
         m_LoggerConfig.path = variables["dump-path"].as<std::string>();
+        m_LoggerConfig.bufferSize = variables["dump-buffer-size"].as<size_t>() * 1024 * 1024;
+        m_LoggerConfig.enableRegDelta = variables.count("enable-dump-reg-delta") > 0;
+        m_LoggerConfig.enableCompression = variables.count("dump-compress") > 0;
+        m_LoggerConfig.keyframeInterval = variables["dump-keyframe-interval"].as<int>();
     }
     else
     {
         m_LoggerConfig.enabled = false;
     }
 
+    m_DigestEnabled = variables.count("digest-path") > 0;
+
+    if (m_DigestEnabled && m_DigestInterval <= 0)
+    {
+        std::cout << "--digest-interval must be positive." << std::endl;
+        std::exit(1);
+    }
+
+    if (variables.count("profile-path"))
+    {
+        m_ProfilerConfig.enabled = true;
+        m_ProfilerConfig.enableCallStack = variables.count("profile-call-stack") > 0;
+        m_ProfilerConfig.interval = variables["profile-interval"].as<int>();
+        m_ProfilerConfig.path = variables["profile-path"].as<std::string>();
+
+        if (variables.count("profile-elf"))
+        {
+            m_ProfilerConfig.elfPaths = variables["profile-elf"].as<std::vector<std::string>>();
+        }
+
+        if (m_ProfilerConfig.interval <= 0)
+        {
+            std::cout << "--profile-interval must be positive." << std::endl;
+            std::exit(1);
+        }
+    }
+    else
+    {
+        m_ProfilerConfig.enabled = false;
+        m_ProfilerConfig.enableCallStack = false;
+    }
+
     if (variables.count("dtb-addr"))
     {
         m_DtbAddress = strtoull(variables["dtb-addr"].as<std::string>().c_str(), 0, 16);
@@ -161,17 +207,20 @@ CommandLineOption::CommandLineOption(int argc, char** argv)
         m_Pc = strtoull(variables["pc"].as<std::string>().c_str(), 0, 16);
     }
 
-    try
+    if (variables.count("load"))
     {
-        for (auto& str: variables["load"].as<std::vector<std::string>>())
+        try
         {
-            m_LoadOptions.emplace_back(str);
+            for (auto& str: variables["load"].as<std::vector<std::string>>())
+            {
+                m_LoadOptions.emplace_back(str);
+            }
+        }
+        catch (CommandLineOptionException e)
+        {
+            e.PrintMessage();
+            exit(1);
         }
-    }
-    catch (CommandLineOptionException e)
-    {
-        e.PrintMessage();
-        exit(1);
     }
 
     if (variables.count("xlen"))
@@ -202,11 +251,26 @@ bool CommandLineOption::IsGdbEnabled() const
     return m_GdbEnabled;
 }
 
+bool CommandLineOption::IsDigestEnabled() const
+{
+    return m_DigestEnabled;
+}
+
+const std::string& CommandLineOption::GetDigestPath() const
+{
+    return m_DigestPath;
+}
+
 const trace::LoggerConfig& CommandLineOption::GetLoggerConfig() const
 {
     return m_LoggerConfig;
 }
 
+const prof::ProfilerConfig& CommandLineOption::GetProfilerConfig() const
+{
+    return m_ProfilerConfig;
+}
+
 const std::vector<LoadOption>& CommandLineOption::GetLoadOptions() const
 {
     return m_LoadOptions;
@@ -232,6 +296,11 @@ int CommandLineOption::GetDumpSkipCycle() const
     return m_DumpSkipCycle;
 }
 
+int CommandLineOption::GetDigestInterval() const
+{
+    return m_DigestInterval;
+}
+
 size_t CommandLineOption::GetRamSize() const
 {
     return m_RamSize;
@@ -22,6 +22,8 @@
 #include <rafi/emu.h>
 #include <rafi/trace.h>
 
+#include "prof/Profiler.h"
+
 namespace rafi { namespace emu {
 
 class LoadOption
@@ -45,13 +47,18 @@ public:
 
     bool IsGdbEnabled() const;
     bool IsHostIoEnabled() const;
+    bool IsDigestEnabled() const;
+
+    const std::string& GetDigestPath() const;
 
     const trace::LoggerConfig& GetLoggerConfig() const;
+    const prof::ProfilerConfig& GetProfilerConfig() const;
     const std::vector<LoadOption>& GetLoadOptions() const;
     XLEN GetXLEN() const;
 
     int GetCycle() const;
     int GetDumpSkipCycle() const;
+    int GetDigestInterval() const;
     int GetGdbPort() const;
 
     size_t GetRamSize() const;
@@ -62,16 +69,20 @@ public:
 
 private:
     static const int DefaultRamSize = 64 * 1024 * 1024;
+    static constexpr int DefaultProfileInterval = 1000;
 
     uint64_t ParseHex(const std::string str);
 
     trace::LoggerConfig m_LoggerConfig;
+    prof::ProfilerConfig m_ProfilerConfig;
     std::vector<LoadOption> m_LoadOptions;
+    std::string m_DigestPath;
 
     XLEN m_XLEN {XLEN::XLEN32};
 
     int m_Cycle {0};
     int m_DumpSkipCycle {0};
+    int m_DigestInterval {0};
     int m_GdbPort {0};
 
     size_t m_RamSize {0};
@@ -82,6 +93,7 @@ private:
 
     bool m_GdbEnabled {false};
     bool m_HostIoEnabled {false};
+    bool m_DigestEnabled {false};
 };
 
 }}
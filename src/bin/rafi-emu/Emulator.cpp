@@ -20,10 +20,11 @@
 
 namespace rafi { namespace emu {
 
-Emulator::Emulator(CommandLineOption option)
+Emulator::Emulator(const CommandLineOption& option)
     : m_Option(option)
     , m_System(option.GetXLEN(), option.GetPc(), option.GetRamSize())
     , m_Logger(option.GetXLEN(), option.GetLoggerConfig(), &m_System)
+    , m_Profiler(option.GetXLEN(), option.GetProfilerConfig())
 {
     if (option.IsHostIoEnabled())
     {
@@ -31,6 +32,12 @@ Emulator::Emulator(CommandLineOption option)
     }
 
     m_System.SetDtbAddress(option.GetDtbAddress());
+
+    if (option.IsDigestEnabled())
+    {
+        m_pStateDigestWriter = std::make_unique<trace::StateDigestWriter>(option.GetDigestPath().c_str(), option.GetDigestInterval());
+        m_System.EnableStateDigest();
+    }
 }
 
 Emulator::~Emulator()
@@ -42,25 +49,48 @@ void Emulator::LoadFileToMemory(const char* path, paddr_t address)
     m_System.LoadFileToMemory(path, address);
 }
 
+void Emulator::LoadSymbolFile(const char* path)
+{
+    m_Profiler.LoadSymbolFile(path);
+}
+
 void Emulator::PrintStatus() const
 {
     m_System.PrintStatus();
 }
 
+void Emulator::WriteProfile() const
+{
+    m_Profiler.WriteReport();
+}
+
 int Emulator::GetCycle() const
 {
     return m_Cycle;
 }
 
+uint32_t Emulator::GetHostIoValue() const
+{
+    return m_System.GetHostIoValue();
+}
+
 void Emulator::Process(EmulationStop condition, int cycle)
 {
     while (m_Cycle < cycle || cycle == CycleForever)
     {
         const bool dumpEnabled = m_Cycle >= m_Option.GetDumpSkipCycle();
-        
+        const auto pc = m_System.GetPc();
+
+        // Process() may be resumed at the same cycle by gdb, so the digest of the cycle may be already recorded.
+        if (m_pStateDigestWriter && m_Cycle % m_Option.GetDigestInterval() == 0 && m_Cycle != m_LastDigestCycle)
+        {
+            RecordStateDigest();
+        }
+
         if (dumpEnabled)
         {
-            m_Logger.BeginCycle(cycle, m_System.GetPc());
+            RAFI_EMU_SELF_PROFILE_SCOPE(Logger);
+            m_Logger.BeginCycle(cycle, pc);
             m_Logger.RecordState();
         }
 
@@ -68,6 +98,7 @@ void Emulator::Process(EmulationStop condition, int cycle)
         {
             if (dumpEnabled)
             {
+                RAFI_EMU_SELF_PROFILE_SCOPE(Logger);
                 m_Logger.EndCycle();
             }
             break;
@@ -75,8 +106,14 @@ void Emulator::Process(EmulationStop condition, int cycle)
 
         ProcessCycle();
 
+        if (m_Profiler.IsEnabled())
+        {
+            m_Profiler.ProcessCycle(pc, m_System.GetEventList());
+        }
+
         if (dumpEnabled)
         {
+            RAFI_EMU_SELF_PROFILE_SCOPE(Logger);
             m_Logger.RecordEvent();
             m_Logger.EndCycle();
         }
@@ -88,6 +125,12 @@ void Emulator::Process(EmulationStop condition, int cycle)
 
         m_Cycle++;
     }
+
+    // Divergence after the last periodic digest is caught by the digest at the end of run.
+    if (m_pStateDigestWriter && m_Cycle != m_LastDigestCycle)
+    {
+        RecordStateDigest();
+    }
 }
 
 void Emulator::Process(EmulationStop condition)
@@ -130,6 +173,14 @@ void Emulator::CopyIntReg(trace::NodeIntReg64* pOut) const
     m_System.CopyIntReg(pOut);
 }
 
+void Emulator::RecordStateDigest()
+{
+    m_System.UpdateStateDigest(&m_StateDigest);
+    m_pStateDigestWriter->Write(m_Cycle, m_StateDigest.Compute(m_Option.GetXLEN(), m_System));
+
+    m_LastDigestCycle = m_Cycle;
+}
+
 bool Emulator::IsStopConditionFilledPre(EmulationStop condition)
 {
     if (condition & EmulationStop_HostIo)
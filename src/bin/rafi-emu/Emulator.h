@@ -16,9 +16,13 @@
 
 #pragma once
 
+#include <memory>
+
 #include <rafi/emu.h>
 #include <rafi/trace.h>
 
+#include "prof/Profiler.h"
+
 #include "CommandLineOption.h"
 #include "System.h"
 #include "IEmulator.h"
@@ -28,12 +32,15 @@ namespace rafi { namespace emu {
 class Emulator final : public IEmulator
 {
 public:
-    Emulator(CommandLineOption option);
+    explicit Emulator(const CommandLineOption& option);
     virtual ~Emulator();
 
     void LoadFileToMemory(const char* path, paddr_t address);
+    void LoadSymbolFile(const char* path);
     void PrintStatus() const;
+    void WriteProfile() const;
     int GetCycle() const;
+    uint32_t GetHostIoValue() const;
 
     void Process(EmulationStop condition, int cycle);
     void Process(EmulationStop condition) override;
@@ -52,12 +59,18 @@ private:
 
     bool IsStopConditionFilledPre(EmulationStop condition);
     bool IsStopConditionFilledPost(EmulationStop condition);
+    void RecordStateDigest();
 
     const CommandLineOption& m_Option;
     System m_System;
     trace::Logger m_Logger;
+    prof::Profiler m_Profiler;
+
+    trace::StateDigest m_StateDigest;
+    std::unique_ptr<trace::StateDigestWriter> m_pStateDigestWriter;
 
     int m_Cycle{0};
+    int m_LastDigestCycle{-1};
 };
 
 }}
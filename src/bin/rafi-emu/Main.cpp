@@ -27,6 +27,19 @@
 #include "Socket.h"
 #include "Emulator.h"
 
+void WriteProfile(const rafi::emu::Emulator& emulator)
+{
+    try
+    {
+        emulator.WriteProfile();
+    }
+    catch (rafi::FileOpenFailureException e)
+    {
+        e.PrintMessage();
+        std::exit(1);
+    }
+}
+
 int main(int argc, char** argv)
 {
     rafi::emu::CommandLineOption option(argc, argv);
@@ -38,6 +51,10 @@ int main(int argc, char** argv)
         {
             emulator.LoadFileToMemory(loadOption.GetPath().c_str(), loadOption.GetAddress());
         }
+        for (auto& path: option.GetProfilerConfig().elfPaths)
+        {
+            emulator.LoadSymbolFile(path.c_str());
+        }
     }
     catch (rafi::FileOpenFailureException e)
     {
@@ -51,19 +68,26 @@ int main(int argc, char** argv)
             ? rafi::emu::EmulationStop_HostIo
             : rafi::emu::EmulationStop_None;
 
+        RAFI_EMU_SELF_PROFILE_BEGIN();
         emulator.Process(condition, option.GetCycle());
     }
     catch (rafi::emu::RafiEmuException)
     {
         std::cout << "Emulation stopped by exception." << std::endl;
         emulator.PrintStatus();        
+        WriteProfile(emulator);
+        RAFI_EMU_SELF_PROFILE_PRINT(emulator.GetCycle());
         std::exit(1);
     }
 
+    WriteProfile(emulator);
+
     std::cout << "Emulation finished @ cycle "
         << std::dec << emulator.GetCycle()
         << std::hex << " (0x" << emulator.GetCycle() << ")" << std::endl;
 
+    RAFI_EMU_SELF_PROFILE_PRINT(emulator.GetCycle());
+
     if (option.IsGdbEnabled())
     {
         rafi::emu::InitializeSocket();
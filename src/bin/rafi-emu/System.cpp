@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include <rafi/emu.h>
 
 #include "System.h"
@@ -82,10 +84,16 @@ void System::ProcessCycle()
 {
     m_EventList.clear();
 
-    m_Clint.ProcessCycle();
-    m_Uart16550.ProcessCycle();
-    m_Uart.ProcessCycle();
-    m_Timer.ProcessCycle();
+    m_Processor.UpdateCounter();
+
+    {
+        RAFI_EMU_SELF_PROFILE_SCOPE(Device);
+
+        m_Clint.ProcessCycle();
+        m_Uart16550.ProcessCycle();
+        m_Uart.ProcessCycle();
+        m_Timer.ProcessCycle();
+    }
 
     m_Processor.ProcessCycle();
 }
@@ -105,6 +113,26 @@ void System::WriteMemory(const void* pBuffer, size_t bufferSize, paddr_t addr)
     return m_Bus.Write(pBuffer, bufferSize, addr);
 }
 
+void System::EnableStateDigest()
+{
+    m_Ram.EnableDirtyPageTracking();
+}
+
+void System::UpdateStateDigest(trace::StateDigest* pDigest)
+{
+    m_Ram.GetDirtyPages(&m_DirtyPages);
+
+    for (const auto offset: m_DirtyPages)
+    {
+        const auto size = std::min(static_cast<size_t>(Ram::DirtyPageSize), static_cast<size_t>(m_Ram.GetCapacity() - offset));
+
+        m_Ram.Read(m_DirtyPageBuffer, size, offset);
+        pDigest->UpdateMemory(AddrRam + offset, m_DirtyPageBuffer, size);
+    }
+
+    m_Ram.ClearDirtyPages();
+}
+
 uint32_t System::GetHostIoValue() const
 {
     uint32_t value;
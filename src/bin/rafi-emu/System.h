@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <vector>
+
 #include <rafi/emu.h>
+#include <rafi/trace.h>
 
 #include "cpu/Processor.h"
 #include "io/IoInterruptSource.h"
@@ -52,6 +55,10 @@ public:
 
     void PrintStatus() const;
 
+    // State digest
+    void EnableStateDigest();
+    void UpdateStateDigest(trace::StateDigest* pDigest);
+
     // ILoggerTarget
     virtual uint32_t GetHostIoValue() const override;
     virtual uint64_t GetPc() const;
@@ -112,6 +119,9 @@ private:
     cpu::Processor m_Processor;
 
     uint32_t m_HostIoAddress{0};
+
+    std::vector<uint64_t> m_DirtyPages;
+    char m_DirtyPageBuffer[Ram::DirtyPageSize];
 };
 
 }}
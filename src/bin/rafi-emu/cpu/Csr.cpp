@@ -163,14 +163,17 @@ PrivilegeLevel Csr::GetPriv() const
 
 void Csr::SetPriv(PrivilegeLevel level)
 {
+    if (m_Priv != level)
+    {
+        m_InterruptStateChanged = true;
+    }
+
     m_Priv = level;
 }
 
 void Csr::ProcessCycle()
 {
-    m_CycleCounter++;
-    m_TimeCounter++;
-    m_InstructionRetiredCounter++;
+    m_Cycle++;
 }
 
 std::optional<Trap> Csr::CheckTrap(csr_addr_t addr, bool write, vaddr_t pc, uint32_t insn) const
@@ -336,7 +339,7 @@ satp_t Csr::ReadSatp() const
 
 uint64_t Csr::ReadTime() const
 {
-    return m_TimeCounter;
+    return ReadCounter(m_TimeOffset);
 }
 
 void Csr::WriteFpCsr(const fcsr_t& value)
@@ -347,16 +350,46 @@ void Csr::WriteFpCsr(const fcsr_t& value)
 void Csr::WriteInterruptPending(const xip_t& value)
 {
     m_InterruptPending = value;
+    m_InterruptStateChanged = true;
 }
 
 void Csr::WriteStatus(const xstatus_t& value)
 {
+    const uint64_t interruptEnableMask = xstatus_t::MIE::Mask | xstatus_t::SIE::Mask | xstatus_t::UIE::Mask;
+    const auto prevInterruptEnable = m_Status.GetWithMask(interruptEnableMask);
+
     m_Status.SetWithMask(value, xstatus_t::WriteMask);
+
+    // Skip re-evaluation for frequent writes which do not touch xIE (e.g. FS update by fp instructions).
+    if (m_Status.GetWithMask(interruptEnableMask) != prevInterruptEnable)
+    {
+        m_InterruptStateChanged = true;
+    }
 }
 
 void Csr::WriteTime(uint64_t value)
 {
-    m_TimeCounter = value;
+    WriteCounter(&m_TimeOffset, value);
+}
+
+uint64_t Csr::GetCycle() const
+{
+    return m_Cycle;
+}
+
+bool Csr::IsInterruptStateChanged() const
+{
+    return m_InterruptStateChanged;
+}
+
+void Csr::NotifyInterruptStateChanged()
+{
+    m_InterruptStateChanged = true;
+}
+
+void Csr::ClearInterruptStateChanged()
+{
+    m_InterruptStateChanged = false;
 }
 
 bool Csr::IsUserModeRegister(csr_addr_t addr) const
@@ -430,27 +463,27 @@ uint64_t Csr::ReadMachineModeRegister(csr_addr_t addr) const
     default:
         if (addr == csr_addr_t::mcycle && m_XLEN == XLEN::XLEN32)
         {
-            return GetLow32(m_CycleCounter);
+            return GetLow32(ReadCounter(m_CycleOffset));
         }
         else if (addr == csr_addr_t::mcycle && m_XLEN == XLEN::XLEN64)
         {
-            return m_CycleCounter;
+            return ReadCounter(m_CycleOffset);
         }
         else if (addr == csr_addr_t::minstret && m_XLEN == XLEN::XLEN32)
         {
-            return GetLow32(m_InstructionRetiredCounter);
+            return GetLow32(ReadCounter(m_InstructionRetiredOffset));
         }
         else if (addr == csr_addr_t::minstret && m_XLEN == XLEN::XLEN64)
         {
-            return m_InstructionRetiredCounter;
+            return ReadCounter(m_InstructionRetiredOffset);
         }
         else if (addr == csr_addr_t::mcycleh && m_XLEN == XLEN::XLEN32)
         {
-            return GetHigh32(m_CycleCounter);
+            return GetHigh32(ReadCounter(m_CycleOffset));
         }
         else if (addr == csr_addr_t::minstreth && m_XLEN == XLEN::XLEN32)
         {
-            return GetHigh32(m_InstructionRetiredCounter);
+            return GetHigh32(ReadCounter(m_InstructionRetiredOffset));
         }
         else
         {
@@ -534,39 +567,39 @@ uint64_t Csr::ReadUserModeRegister(csr_addr_t addr) const
     default:
         if (addr == csr_addr_t::cycle && m_XLEN == XLEN::XLEN32)
         {
-            return GetLow32(m_CycleCounter);
+            return GetLow32(ReadCounter(m_CycleOffset));
         }
         else if (addr == csr_addr_t::cycle && m_XLEN == XLEN::XLEN64)
         {
-            return m_CycleCounter;
+            return ReadCounter(m_CycleOffset);
         }
         else if (addr == csr_addr_t::time && m_XLEN == XLEN::XLEN32)
         {
-            return GetLow32(m_CycleCounter);
+            return GetLow32(ReadCounter(m_CycleOffset));
         }
         else if (addr == csr_addr_t::time && m_XLEN == XLEN::XLEN64)
         {
-            return m_TimeCounter;
+            return ReadCounter(m_TimeOffset);
         }
         else if (addr == csr_addr_t::instret && m_XLEN == XLEN::XLEN32)
         {
-            return GetLow32(m_InstructionRetiredCounter);
+            return GetLow32(ReadCounter(m_InstructionRetiredOffset));
         }
         else if (addr == csr_addr_t::instret && m_XLEN == XLEN::XLEN64)
         {
-            return m_InstructionRetiredCounter;
+            return ReadCounter(m_InstructionRetiredOffset);
         }
         else if (addr == csr_addr_t::cycleh && m_XLEN == XLEN::XLEN32)
         {
-            return GetHigh32(m_CycleCounter);
+            return GetHigh32(ReadCounter(m_CycleOffset));
         }
         else if (addr == csr_addr_t::timeh && m_XLEN == XLEN::XLEN32)
         {
-            return GetHigh32(m_TimeCounter);
+            return GetHigh32(ReadCounter(m_TimeOffset));
         }
         else if (addr == csr_addr_t::instreth && m_XLEN == XLEN::XLEN32)
         {
-            return GetHigh32(m_InstructionRetiredCounter);
+            return GetHigh32(ReadCounter(m_InstructionRetiredOffset));
         }
         else
         {
@@ -598,9 +631,11 @@ void Csr::WriteMachineModeRegister(csr_addr_t addr, uint64_t value)
         return;
     case csr_addr_t::mideleg:
         m_MachineInterruptDelegation = value;
+        m_InterruptStateChanged = true;
         return;
     case csr_addr_t::mie:
         m_InterruptEnable.SetWithMask(value, xie_t::MachineMask);
+        m_InterruptStateChanged = true;
         return;
     case csr_addr_t::mcounteren:
         m_MachineCounterEnable = value;
@@ -622,6 +657,7 @@ void Csr::WriteMachineModeRegister(csr_addr_t addr, uint64_t value)
         return;
     case csr_addr_t::mip:
         m_InterruptPending.SetWithMask(value, xip_t::MachineMask & xip_t::WriteMask);
+        m_InterruptStateChanged = true;
         return;
     case csr_addr_t::pmpcfg0:
     case csr_addr_t::pmpcfg1:
@@ -632,27 +668,27 @@ void Csr::WriteMachineModeRegister(csr_addr_t addr, uint64_t value)
     default:
         if (addr == csr_addr_t::mcycle && m_XLEN == XLEN::XLEN32)
         {
-            SetLow32(&m_CycleCounter, value);
+            WriteCounterLow32(&m_CycleOffset, value);
         }
         else if (addr == csr_addr_t::mcycle && m_XLEN == XLEN::XLEN64)
         {
-            m_CycleCounter = value;
+            WriteCounter(&m_CycleOffset, value);
         }
         else if (addr == csr_addr_t::minstret && m_XLEN == XLEN::XLEN32)
         {
-            SetLow32(&m_InstructionRetiredCounter, value);
+            WriteCounterLow32(&m_InstructionRetiredOffset, value);
         }
         else if (addr == csr_addr_t::minstret && m_XLEN == XLEN::XLEN64)
         {
-            m_InstructionRetiredCounter = value;
+            WriteCounter(&m_InstructionRetiredOffset, value);
         }
         else if (addr == csr_addr_t::mcycleh && m_XLEN == XLEN::XLEN32)
         {
-            SetHigh32(&m_CycleCounter, value);
+            WriteCounterHigh32(&m_CycleOffset, value);
         }
         else if (addr == csr_addr_t::minstreth && m_XLEN == XLEN::XLEN32)
         {
-            SetHigh32(&m_InstructionRetiredCounter, value);
+            WriteCounterHigh32(&m_InstructionRetiredOffset, value);
         }
         else
         {
@@ -683,9 +719,11 @@ void Csr::WriteSupervisorModeRegister(csr_addr_t addr, uint64_t value)
         return;
     case csr_addr_t::sideleg:
         m_SupervisorInterruptDelegation = value;
+        m_InterruptStateChanged = true;
         return;
     case csr_addr_t::sie:
         m_InterruptEnable.SetWithMask(value, xie_t::SupervisorMask);
+        m_InterruptStateChanged = true;
         return;
     case csr_addr_t::stvec:
         m_SupervisorTrapVector.SetValue(value);
@@ -707,6 +745,7 @@ void Csr::WriteSupervisorModeRegister(csr_addr_t addr, uint64_t value)
         return;
     case csr_addr_t::sip:
         m_InterruptPending.SetWithMask(value, xip_t::WriteMask & xip_t::SupervisorMask);
+        m_InterruptStateChanged = true;
         return;
     case csr_addr_t::satp:
         m_SupervisorAddressTranslationProtection.SetValue(value);
@@ -735,6 +774,7 @@ void Csr::WriteUserModeRegister(csr_addr_t addr, uint64_t value)
         return;
     case csr_addr_t::uie:
         m_InterruptEnable.SetWithMask(value, xie_t::UserMask);
+        m_InterruptStateChanged = true;
         return;
     case csr_addr_t::utvec:
         m_UserTrapVector.SetValue(value);
@@ -753,43 +793,44 @@ void Csr::WriteUserModeRegister(csr_addr_t addr, uint64_t value)
         return;
     case csr_addr_t::uip:
         m_InterruptPending.SetWithMask(value, xip_t::WriteMask & xip_t::UserMask);
+        m_InterruptStateChanged = true;
         return;
     default:
         if (addr == csr_addr_t::cycle && m_XLEN == XLEN::XLEN32)
         {
-            SetLow32(&m_CycleCounter, value);
+            WriteCounterLow32(&m_CycleOffset, value);
         }
         else if (addr == csr_addr_t::cycle && m_XLEN == XLEN::XLEN64)
         {
-            m_CycleCounter = value;
+            WriteCounter(&m_CycleOffset, value);
         }
         else if (addr == csr_addr_t::time && m_XLEN == XLEN::XLEN32)
         {
-            SetLow32(&m_TimeCounter, value);
+            WriteCounterLow32(&m_TimeOffset, value);
         }
         else if (addr == csr_addr_t::time && m_XLEN == XLEN::XLEN64)
         {
-            m_TimeCounter = value;
+            WriteCounter(&m_TimeOffset, value);
         }
         else if (addr == csr_addr_t::instret && m_XLEN == XLEN::XLEN32)
         {
-            SetLow32(&m_InstructionRetiredCounter, value);
+            WriteCounterLow32(&m_InstructionRetiredOffset, value);
         }
         else if (addr == csr_addr_t::instret && m_XLEN == XLEN::XLEN64)
         {
-            m_InstructionRetiredCounter = value;
+            WriteCounter(&m_InstructionRetiredOffset, value);
         }
         else if (addr == csr_addr_t::cycleh && m_XLEN == XLEN::XLEN32)
         {
-            SetHigh32(&m_CycleCounter, value);
+            WriteCounterHigh32(&m_CycleOffset, value);
         }
         else if (addr == csr_addr_t::timeh && m_XLEN == XLEN::XLEN32)
         {
-            SetHigh32(&m_CycleCounter, value);
+            WriteCounterHigh32(&m_CycleOffset, value);
         }
         else if (addr == csr_addr_t::instreth && m_XLEN == XLEN::XLEN32)
         {
-            SetHigh32(&m_InstructionRetiredCounter, value);
+            WriteCounterHigh32(&m_InstructionRetiredOffset, value);
         }
         else
         {
@@ -799,6 +840,30 @@ void Csr::WriteUserModeRegister(csr_addr_t addr, uint64_t value)
     }
 }
 
+uint64_t Csr::ReadCounter(uint64_t offset) const
+{
+    return m_Cycle + offset;
+}
+
+void Csr::WriteCounter(uint64_t* pOffset, uint64_t value)
+{
+    *pOffset = value - m_Cycle;
+}
+
+void Csr::WriteCounterLow32(uint64_t* pOffset, uint64_t value)
+{
+    auto counter = ReadCounter(*pOffset);
+    SetLow32(&counter, value);
+    WriteCounter(pOffset, counter);
+}
+
+void Csr::WriteCounterHigh32(uint64_t* pOffset, uint64_t value)
+{
+    auto counter = ReadCounter(*pOffset);
+    SetHigh32(&counter, value);
+    WriteCounter(pOffset, counter);
+}
+
 int Csr::GetPerformanceCounterIndex(csr_addr_t addr) const
 {
     csr_addr_t base;
@@ -35,6 +35,9 @@ public:
     // Update registers for cycle
     void ProcessCycle();
 
+    // Number of cycles since reset. Performance counters and time are derived from this value.
+    uint64_t GetCycle() const;
+
     // Special register access
     vaddr_t GetPc() const;
     void SetPc(vaddr_t value);
@@ -61,6 +64,12 @@ public:
     void WriteStatus(const xstatus_t& value);
     void WriteTime(uint64_t value);
 
+    // Interrupt state tracking
+    // Set when any input of interrupt evaluation (xstatus, xie, xip, xideleg, privilege level) is changed.
+    bool IsInterruptStateChanged() const;
+    void NotifyInterruptStateChanged();
+    void ClearInterruptStateChanged();
+
 private:
     static const int RegisterAddrWidth = 12;
 	static const int NumberOfRegister = 1 << RegisterAddrWidth;
@@ -79,6 +88,11 @@ private:
     void WriteSupervisorModeRegister(csr_addr_t addr, uint64_t value);
     void WriteUserModeRegister(csr_addr_t addr, uint64_t value);
 
+    uint64_t ReadCounter(uint64_t offset) const;
+    void WriteCounter(uint64_t* pOffset, uint64_t value);
+    void WriteCounterLow32(uint64_t* pOffset, uint64_t value);
+    void WriteCounterHigh32(uint64_t* pOffset, uint64_t value);
+
     int GetPerformanceCounterIndex(csr_addr_t addr) const;
     void PrintRegisterUnimplementedMessage(csr_addr_t addr) const;
 
@@ -130,13 +144,17 @@ private:
     satp_t m_SupervisorAddressTranslationProtection {0};
 
     // Performance Counters
-    uint64_t m_CycleCounter {0};
-    uint64_t m_TimeCounter {0};
-    uint64_t m_InstructionRetiredCounter {0};
+    // Each counter is represented as an offset from m_Cycle so that ProcessCycle() needs only one increment.
+    uint64_t m_Cycle {0};
+    uint64_t m_CycleOffset {0};
+    uint64_t m_TimeOffset {0};
+    uint64_t m_InstructionRetiredOffset {0};
 
     // Special registers
     vaddr_t m_Pc {0};
     PrivilegeLevel m_Priv {PrivilegeLevel::Machine};
+
+    bool m_InterruptStateChanged {true};
 };
 
 }}}
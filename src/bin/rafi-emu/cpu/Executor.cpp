@@ -215,6 +215,8 @@ std::optional<Trap> Executor::PostCheckTrap(const Op& op, vaddr_t pc) const
 
 void Executor::ProcessOp(const Op& op, vaddr_t pc)
 {
+    RAFI_EMU_SELF_PROFILE_SCOPE_OP(op.opCode);
+
     switch (op.opClass)
     {
     case OpClass::RV32I:
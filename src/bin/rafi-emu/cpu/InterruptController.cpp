@@ -15,6 +15,7 @@
  */
 
 #include <cassert>
+#include <cinttypes>
 #include <cstring>
 
 #include <rafi/emu.h>
@@ -61,13 +62,61 @@ bool InterruptController::IsRequested() const
 
 void InterruptController::Update()
 {
-    UpdateCsr();
+    if (m_pCsr->IsInterruptStateChanged())
+    {
+        Evaluate();
+    }
+
+#if defined(RAFI_EMU_CHECK_INTERRUPT_CONTROLLER)
+    Check();
+#endif
+}
+
+void InterruptController::Evaluate()
+{
+    const auto pending = MakeInterruptPending();
+
+    m_pCsr->WriteInterruptPending(pending);
+
+    const auto interruptType = FindInterrupt(pending);
+
+    m_IsRequested = interruptType.has_value();
+    if (m_IsRequested)
+    {
+        m_InterruptType = interruptType.value();
+    }
+
+    // Writing xip above marks the state as changed, so clear the flag after the evaluation.
+    m_pCsr->ClearInterruptStateChanged();
+}
+
+// Cross-check the cached result against the full evaluation.
+void InterruptController::Check() const
+{
+    const auto pending = MakeInterruptPending();
+    const auto interruptType = FindInterrupt(pending);
 
+    if (pending.GetValue() != m_pCsr->ReadInterruptPending().GetValue())
+    {
+        RAFI_EMU_ERROR("[InterruptController] Cached xip (0x%" PRIx64 ") does not match evaluated value (0x%" PRIx64 ").\n",
+            m_pCsr->ReadInterruptPending().GetValue(), pending.GetValue());
+    }
+    if (interruptType.has_value() != m_IsRequested)
+    {
+        RAFI_EMU_ERROR("[InterruptController] Cached request (%d) does not match evaluated value (%d).\n",
+            m_IsRequested, interruptType.has_value());
+    }
+    if (m_IsRequested && interruptType.value() != m_InterruptType)
+    {
+        RAFI_EMU_ERROR("[InterruptController] Cached type (%d) does not match evaluated value (%d).\n",
+            static_cast<int>(m_InterruptType), static_cast<int>(interruptType.value()));
+    }
+}
+
+std::optional<InterruptType> InterruptController::FindInterrupt(const xip_t& ip) const
+{
     const xstatus_t status = m_pCsr->ReadStatus();
     const xie_t ie = m_pCsr->ReadInterruptEnable();
-    const xip_t ip = m_pCsr->ReadInterruptPending();
-
-    m_IsRequested = false;
 
     // Check xIE
     switch (m_pCsr->GetPriv())
@@ -75,19 +124,19 @@ void InterruptController::Update()
     case PrivilegeLevel::Machine:
         if (!status.GetMember<xstatus_t::MIE>())
         {
-            return;
+            return std::nullopt;
         }
         break;
     case PrivilegeLevel::Supervisor:
         if (!status.GetMember<xstatus_t::SIE>())
         {
-            return;
+            return std::nullopt;
         }
         break;
     case PrivilegeLevel::User:
         if (!status.GetMember<xstatus_t::UIE>())
         {
-            return;
+            return std::nullopt;
         }
         break;
     default:
@@ -97,62 +146,46 @@ void InterruptController::Update()
     // Check interrupt to M-mode
     if (ie.GetMember<xie_t::MEIE>() && ip.GetMember<xip_t::MEIP>())
     {
-        m_IsRequested = true;
-        m_InterruptType = InterruptType::MachineExternal;
-        return;
+        return InterruptType::MachineExternal;
     }
     if (ie.GetMember<xie_t::MTIE>() && ip.GetMember<xip_t::MTIP>())
     {
-        m_IsRequested = true;
-        m_InterruptType = InterruptType::MachineTimer;
-        return;
+        return InterruptType::MachineTimer;
     }
     if (ie.GetMember<xie_t::MSIE>() && ip.GetMember<xip_t::MSIP>())
     {
-        m_IsRequested = true;
-        m_InterruptType = InterruptType::MachineSoftware;
-        return;
+        return InterruptType::MachineSoftware;
     }
 
     // Check interrupt to S-mode
     if (ie.GetMember<xie_t::SEIE>() && ip.GetMember<xip_t::SEIP>())
     {
-        m_IsRequested = true;
-        m_InterruptType = InterruptType::SupervisorExternal;
-        return;
+        return InterruptType::SupervisorExternal;
     }
     if (ie.GetMember<xie_t::STIE>() && ip.GetMember<xip_t::STIP>())
     {
-        m_IsRequested = true;
-        m_InterruptType = InterruptType::SupervisorTimer;
-        return;
+        return InterruptType::SupervisorTimer;
     }
     if (ie.GetMember<xie_t::SSIE>() && ip.GetMember<xip_t::SSIP>())
     {
-        m_IsRequested = true;
-        m_InterruptType = InterruptType::SupervisorSoftware;
-        return;
+        return InterruptType::SupervisorSoftware;
     }
 
     // Check interrupt to U-mode
     if (ie.GetMember<xie_t::UEIE>() && ip.GetMember<xip_t::UEIP>())
     {
-        m_IsRequested = true;
-        m_InterruptType = InterruptType::UserExternal;
-        return;
+        return InterruptType::UserExternal;
     }
     if (ie.GetMember<xie_t::UTIE>() && ip.GetMember<xip_t::UTIP>())
     {
-        m_IsRequested = true;
-        m_InterruptType = InterruptType::UserTimer;
-        return;
+        return InterruptType::UserTimer;
     }
     if (ie.GetMember<xie_t::USIE>() && ip.GetMember<xip_t::USIP>())
     {
-        m_IsRequested = true;
-        m_InterruptType = InterruptType::UserSoftware;
-        return;
+        return InterruptType::UserSoftware;
     }
+
+    return std::nullopt;
 }
 
 void InterruptController::RegisterExternalInterruptSource(IInterruptSource* pInterruptSource)
@@ -169,7 +202,12 @@ void InterruptController::RegisterTimerInterruptSource(IInterruptSource* pInterr
     m_pTimerInterruptSource = pInterruptSource;
 }
 
-void InterruptController::UpdateCsr()
+void InterruptController::NotifyInterruptSourceChanged()
+{
+    m_pCsr->NotifyInterruptStateChanged();
+}
+
+xip_t InterruptController::MakeInterruptPending() const
 {
     const auto mideleg = m_pCsr->ReadUInt32(csr_addr_t::mideleg);
     const auto sideleg = m_pCsr->ReadUInt32(csr_addr_t::sideleg);
@@ -218,7 +256,7 @@ void InterruptController::UpdateCsr()
         }
     }
 
-    m_pCsr->WriteInterruptPending(pending);
+    return pending;
 }
 
 }}}
@@ -18,6 +18,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <optional>
 
 #include <rafi/emu.h>
 
@@ -34,13 +35,21 @@ public:
 
     bool IsRequested() const;
 
+    // Re-evaluate interrupt request only if its inputs have changed since the last evaluation.
     void Update();
 
     void RegisterExternalInterruptSource(IInterruptSource* pInterruptSource);
     void RegisterTimerInterruptSource(IInterruptSource* pInterruptSource);
 
+    // Called by interrupt sources when their request level changes.
+    void NotifyInterruptSourceChanged();
+
 private:
-    void UpdateCsr();
+    void Evaluate();
+    void Check() const;
+
+    xip_t MakeInterruptPending() const;
+    std::optional<InterruptType> FindInterrupt(const xip_t& pending) const;
 
     Csr* m_pCsr { nullptr };
     IInterruptSource* m_pExternalInterruptSource { nullptr };
@@ -397,6 +397,8 @@ std::optional<Trap> MemoryAccessUnit::MakeTrap(MemoryAccessType accessType, vadd
 
 std::optional<Trap> MemoryAccessUnit::Translate(paddr_t* pOutAddr, MemoryAccessType accessType, vaddr_t addr, vaddr_t pc)
 {
+    RAFI_EMU_SELF_PROFILE_SCOPE(Translate);
+
     switch (GetAddresssTranslationMode(accessType))
     {
     case AddressTranslationMode::Bare:
@@ -49,6 +49,11 @@ void Processor::RegisterTimerInterruptSource(IInterruptSource* pInterruptSource)
     m_InterruptController.RegisterTimerInterruptSource(pInterruptSource);
 }
 
+void Processor::NotifyInterruptSourceChanged()
+{
+    m_InterruptController.NotifyInterruptSourceChanged();
+}
+
 void Processor::SetIntReg(int regId, uint32_t regValue)
 {
     m_IntRegFile.WriteUInt32(regId, regValue);
@@ -64,6 +69,11 @@ void Processor::WriteInterruptPending(const xip_t& value)
     m_Csr.WriteInterruptPending(value);
 }
 
+uint64_t Processor::ReadCycle() const
+{
+    return m_Csr.GetCycle();
+}
+
 uint64_t Processor::ReadTime() const
 {
     return m_Csr.ReadTime();
@@ -74,10 +84,23 @@ void Processor::WriteTime(uint64_t value)
     m_Csr.WriteTime(value);
 }
 
-void Processor::ProcessCycle()
+void Processor::SetTimerInterruptDeadline(uint64_t cycle)
+{
+    m_TimerInterruptDeadline = cycle;
+}
+
+void Processor::UpdateCounter()
 {
     m_Csr.ProcessCycle();
 
+    if (m_Csr.GetCycle() == m_TimerInterruptDeadline)
+    {
+        m_InterruptController.NotifyInterruptSourceChanged();
+    }
+}
+
+void Processor::ProcessCycle()
+{
     const auto priv = m_Csr.GetPriv();
     const auto pc = m_Csr.GetPc();
 
@@ -106,7 +129,11 @@ void Processor::ProcessCycle()
     m_pEventList->emplace_back(trace::OpEvent { insn, priv });
 
     // Decode
-    const auto op = m_Decoder.Decode(insn);
+    Op op;
+    {
+        RAFI_EMU_SELF_PROFILE_SCOPE(Decode);
+        op = m_Decoder.Decode(insn);
+    }
     if (op.opCode == OpCode::unknown)
     {
         const auto decodeTrap = MakeIllegalInstructionException(pc, insn);
@@ -164,6 +191,8 @@ void Processor::CopyFpReg(trace::NodeFpReg* pOut) const
 
 std::optional<Trap> Processor::Fetch(uint32_t* pOutInsn, vaddr_t pc)
 {
+    RAFI_EMU_SELF_PROFILE_SCOPE(Fetch);
+
     if (pc % 0x1000 == 0xffe)
     {
         // To support 4-byte instruction across a page boundary, split memory access.
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <limits>
+
 #include <rafi/common.h>
 #include <rafi/emu.h>
 
@@ -41,15 +43,22 @@ public:
     // Interrupt source
     void RegisterExternalInterruptSource(IInterruptSource* pInterruptSource);
     void RegisterTimerInterruptSource(IInterruptSource* pInterruptSource);
+    void NotifyInterruptSourceChanged();
 
     // for clint and plic
     xip_t ReadInterruptPending() const;
     void WriteInterruptPending(const xip_t& value);
 
+    uint64_t ReadCycle() const;
     uint64_t ReadTime() const;
     void WriteTime(uint64_t value);
 
+    // Cycle at which the timer interrupt source changes its level
+    void SetTimerInterruptDeadline(uint64_t cycle);
+
     // Process
+    // UpdateCounter() is called at the beginning of cycle so that IOs observe the same time as the core.
+    void UpdateCounter();
     void ProcessCycle();
 
     // for Dump
@@ -81,6 +90,8 @@ private:
     Executor m_Executor;
 
     uint32_t m_OpCount { 0 };
+
+    uint64_t m_TimerInterruptDeadline { std::numeric_limits<uint64_t>::max() };
 };
 
 }}}
@@ -17,6 +17,7 @@
 #include <cassert>
 #include <cstdio>
 #include <cstring>
+#include <limits>
 
 #include <rafi/emu.h>
 
@@ -66,6 +67,7 @@ void Clint::Write(const void* pBuffer, size_t size, uint64_t address)
             RAFI_EMU_ERROR("[Clint] Write size (%zd byte) for mtimecmp is invalid.\n", size);
         }
         std::memcpy(&m_TimeCmp, pBuffer, size);
+        UpdateTimerInterruptDeadline();
         break;
     default:
         RAFI_EMU_NOT_IMPLEMENTED;
@@ -146,6 +148,28 @@ void Clint::WriteTime(const void* pBuffer, size_t size)
     std::memcpy(&value, pBuffer, size);
 
     m_pProcessor->WriteTime(value);
+
+    UpdateTimerInterruptDeadline();
+}
+
+// Compute the exact cycle at which MTIP is asserted, so that mtime and mtimecmp need not be compared every cycle.
+// mtime and mtimecmp are changed only by register writes, so this is called only on those writes.
+void Clint::UpdateTimerInterruptDeadline()
+{
+    const auto cycle = m_pProcessor->ReadCycle();
+    const auto time = m_pProcessor->ReadTime();
+
+    if (time < m_TimeCmp)
+    {
+        m_pProcessor->SetTimerInterruptDeadline(cycle + (m_TimeCmp - time));
+    }
+    else
+    {
+        m_pProcessor->SetTimerInterruptDeadline(std::numeric_limits<uint64_t>::max());
+    }
+
+    // The level may be changed by the write itself.
+    m_pProcessor->NotifyInterruptSourceChanged();
 }
 
 }}}
@@ -42,6 +42,8 @@ private:
     void WriteMsip(const void* pBuffer, size_t size);
     void WriteTime(const void* pBuffer, size_t size);
 
+    void UpdateTimerInterruptDeadline();
+
     static const int RegisterSpaceSize = 0x10000;
 
     // Register address
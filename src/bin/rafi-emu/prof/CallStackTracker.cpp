@@ -0,0 +1,318 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <limits>
+
+#include <rafi/emu.h>
+
+#include "CallStackTracker.h"
+
+namespace rafi { namespace emu { namespace prof {
+
+namespace {
+
+const vaddr_t TrapReturnAddress = std::numeric_limits<vaddr_t>::max();
+
+const uint32_t RegRa = 1;
+
+bool IsCompressed(uint32_t insn)
+{
+    return (insn & 0b11) != 0b11;
+}
+
+}
+
+CallStackTracker::CallStackTracker(XLEN xlen)
+    : m_XLEN(xlen)
+{
+    for (int i = 0; i < PrivilegeLevelCount; i++)
+    {
+        m_Stacks[i].root = static_cast<int>(m_Nodes.size());
+        m_Nodes.push_back(CallNode { 0, InvalidNode, 0 });
+    }
+}
+
+void CallStackTracker::ProcessCycle(vaddr_t pc, const trace::EventList& eventList)
+{
+    if (m_PendingAction != PendingAction::None)
+    {
+        ResolvePendingAction(pc);
+    }
+
+    const trace::OpEvent* pOpEvent = nullptr;
+    const trace::TrapEvent* pTrapEvent = nullptr;
+
+    for (const auto& event: eventList)
+    {
+        if (std::holds_alternative<trace::OpEvent>(event))
+        {
+            pOpEvent = &std::get<trace::OpEvent>(event);
+        }
+        else if (std::holds_alternative<trace::TrapEvent>(event))
+        {
+            pTrapEvent = &std::get<trace::TrapEvent>(event);
+        }
+    }
+
+    if (pOpEvent != nullptr)
+    {
+        auto& stack = m_Stacks[static_cast<int>(pOpEvent->priv)];
+        m_Nodes[GetCurrentNode(stack)].count++;
+
+        // Calls and returns take effect only if the op is completed without exception.
+        if (pTrapEvent == nullptr)
+        {
+            ProcessOp(pc, *pOpEvent);
+        }
+    }
+
+    if (pTrapEvent != nullptr)
+    {
+        ProcessTrap(*pTrapEvent);
+    }
+}
+
+void CallStackTracker::WriteFoldedStacks(const std::string& path, const SymbolTable& symbolTable) const
+{
+    auto fp = std::fopen(path.c_str(), "w");
+    if (fp == nullptr)
+    {
+        throw FileOpenFailureException(path.c_str());
+    }
+
+    std::vector<int> nodes;
+
+    for (int i = 0; i < static_cast<int>(m_Nodes.size()); i++)
+    {
+        if (m_Nodes[i].count == 0)
+        {
+            continue;
+        }
+
+        nodes.clear();
+        for (int node = i; node != InvalidNode; node = m_Nodes[node].parent)
+        {
+            nodes.push_back(node);
+        }
+
+        std::string line;
+        for (auto it = nodes.rbegin(); it != nodes.rend(); ++it)
+        {
+            const auto& node = m_Nodes[*it];
+
+            if (node.parent == InvalidNode)
+            {
+                // Root nodes are created in order of privilege level.
+                line += GetString(static_cast<PrivilegeLevel>(*it));
+                continue;
+            }
+
+            line += ';';
+
+            const auto pSymbol = symbolTable.Find(node.function);
+            if (pSymbol != nullptr)
+            {
+                line += pSymbol->name;
+            }
+            else
+            {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "0x%" PRIx64, static_cast<uint64_t>(node.function));
+                line += buffer;
+            }
+        }
+
+        std::fprintf(fp, "%s %" PRIu64 "\n", line.c_str(), m_Nodes[i].count);
+    }
+
+    std::fclose(fp);
+}
+
+void CallStackTracker::ResolvePendingAction(vaddr_t pc)
+{
+    auto pStack = &m_Stacks[static_cast<int>(m_PendingPriv)];
+
+    switch (m_PendingAction)
+    {
+    case PendingAction::Call:
+        Push(pStack, pc, m_PendingReturnAddress);
+        break;
+    case PendingAction::Return:
+        Unwind(pStack, pc);
+        break;
+    case PendingAction::TrapEntry:
+        Push(pStack, pc, TrapReturnAddress);
+        break;
+    default:
+        break;
+    }
+
+    m_PendingAction = PendingAction::None;
+}
+
+void CallStackTracker::ProcessOp(vaddr_t pc, const trace::OpEvent& opEvent)
+{
+    const auto insn = opEvent.insn;
+
+    bool isCall = false;
+    bool isReturn = false;
+
+    if (IsCompressed(insn))
+    {
+        const auto op = insn & 0b11;
+        const auto funct3 = (insn >> 13) & 0b111;
+        const auto funct4 = (insn >> 12) & 0b1111;
+        const auto rs1 = (insn >> 7) & 0b11111;
+        const auto rs2 = (insn >> 2) & 0b11111;
+
+        if (op == 0b10 && rs1 != 0 && rs2 == 0)
+        {
+            // c.jalr links to ra, c.jr ra is return.
+            isCall = funct4 == 0b1001;
+            isReturn = funct4 == 0b1000 && rs1 == RegRa;
+        }
+        else if (op == 0b01 && funct3 == 0b001 && m_XLEN == XLEN::XLEN32)
+        {
+            // c.jal (RV32 only)
+            isCall = true;
+        }
+    }
+    else
+    {
+        const auto opcode = insn & 0b1111111;
+        const auto rd = (insn >> 7) & 0b11111;
+        const auto funct3 = (insn >> 12) & 0b111;
+        const auto rs1 = (insn >> 15) & 0b11111;
+
+        if (opcode == 0b1101111)
+        {
+            // jal
+            isCall = rd == RegRa;
+        }
+        else if (opcode == 0b1100111 && funct3 == 0)
+        {
+            // jalr
+            isCall = rd == RegRa;
+            isReturn = rd == 0 && rs1 == RegRa;
+        }
+    }
+
+    if (isCall)
+    {
+        m_PendingAction = PendingAction::Call;
+        m_PendingPriv = opEvent.priv;
+        m_PendingReturnAddress = pc + (IsCompressed(insn) ? 2 : 4);
+    }
+    else if (isReturn)
+    {
+        m_PendingAction = PendingAction::Return;
+        m_PendingPriv = opEvent.priv;
+    }
+}
+
+void CallStackTracker::ProcessTrap(const trace::TrapEvent& trapEvent)
+{
+    if (trapEvent.trapType == TrapType::Return)
+    {
+        // Unwind frames pushed after trap entry, including the trap handler frame.
+        auto& stack = m_Stacks[static_cast<int>(trapEvent.from)];
+
+        if (!stack.trapDepths.empty())
+        {
+            stack.frames.resize(std::min(stack.frames.size(), stack.trapDepths.back()));
+            stack.trapDepths.pop_back();
+        }
+    }
+    else
+    {
+        auto& stack = m_Stacks[static_cast<int>(trapEvent.to)];
+
+        stack.trapDepths.push_back(stack.frames.size());
+
+        m_PendingAction = PendingAction::TrapEntry;
+        m_PendingPriv = trapEvent.to;
+    }
+}
+
+void CallStackTracker::Push(CallStack* pStack, vaddr_t function, vaddr_t returnAddress)
+{
+    if (pStack->frames.size() >= MaxFrameCount)
+    {
+        // Shadow stack is out of sync with guest (e.g. context switch without return). Start over from root.
+        pStack->frames.clear();
+        pStack->trapDepths.clear();
+    }
+
+    const auto parent = GetCurrentNode(*pStack);
+
+    // Deep recursion is folded into the deepest frame to bound the number of call tree nodes.
+    const auto node = pStack->frames.size() < MaxDepth
+        ? GetChildNode(parent, function)
+        : parent;
+
+    pStack->frames.push_back(Frame { node, returnAddress });
+}
+
+void CallStackTracker::Unwind(CallStack* pStack, vaddr_t returnAddress)
+{
+    auto& frames = pStack->frames;
+
+    // Frames below the trap handler are not unwound by function return.
+    const size_t floor = pStack->trapDepths.empty() ? 0 : pStack->trapDepths.back() + 1;
+
+    for (size_t i = frames.size(); i > floor; i--)
+    {
+        if (frames[i - 1].returnAddress == returnAddress)
+        {
+            frames.resize(i - 1);
+            return;
+        }
+    }
+
+    // Return address is not found (e.g. longjmp or tail call). Assume one frame is returned.
+    if (frames.size() > floor)
+    {
+        frames.pop_back();
+    }
+}
+
+int CallStackTracker::GetCurrentNode(const CallStack& stack) const
+{
+    return stack.frames.empty() ? stack.root : stack.frames.back().node;
+}
+
+int CallStackTracker::GetChildNode(int parent, vaddr_t function)
+{
+    const ChildKey key { parent, function };
+
+    const auto it = m_ChildNodes.find(key);
+    if (it != m_ChildNodes.end())
+    {
+        return it->second;
+    }
+
+    const auto node = static_cast<int>(m_Nodes.size());
+
+    m_Nodes.push_back(CallNode { function, parent, 0 });
+    m_ChildNodes.emplace(key, node);
+
+    return node;
+}
+
+}}}
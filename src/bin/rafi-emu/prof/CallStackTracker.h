@@ -0,0 +1,119 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <rafi/emu.h>
+#include <rafi/trace.h>
+
+#include "SymbolTable.h"
+
+namespace rafi { namespace emu { namespace prof {
+
+// Shadow call stack of guest code for each privilege level.
+// Calls are jal/jalr/c.jalr (and c.jal on RV32) with rd=ra, and returns are jalr x0, ra / c.jr ra.
+// Trap entry pushes the handler as a frame on the stack of the destination privilege level, and xRET unwinds it.
+// Every op is counted on the call tree node of its current stack.
+class CallStackTracker
+{
+public:
+    explicit CallStackTracker(XLEN xlen);
+
+    void ProcessCycle(vaddr_t pc, const trace::EventList& eventList);
+
+    // Writes call stacks in folded format (e.g. "Supervisor;handle_exception;do_irq 123").
+    void WriteFoldedStacks(const std::string& path, const SymbolTable& symbolTable) const;
+
+private:
+    static const int PrivilegeLevelCount = 4;
+    static const size_t MaxDepth = 256;
+    static const size_t MaxFrameCount = 4096;
+    static const int InvalidNode = -1;
+
+    enum class PendingAction
+    {
+        None,
+        Call,
+        Return,
+        TrapEntry,
+    };
+
+    struct CallNode
+    {
+        vaddr_t function;
+        int parent;
+        uint64_t count;
+    };
+
+    struct Frame
+    {
+        int node;
+        vaddr_t returnAddress;
+    };
+
+    struct ChildKey
+    {
+        int parent;
+        vaddr_t function;
+
+        bool operator==(const ChildKey& other) const
+        {
+            return parent == other.parent && function == other.function;
+        }
+    };
+
+    struct ChildKeyHash
+    {
+        size_t operator()(const ChildKey& key) const
+        {
+            return std::hash<uint64_t>()(static_cast<uint64_t>(key.function) * 31 + key.parent);
+        }
+    };
+
+    struct CallStack
+    {
+        std::vector<Frame> frames;
+        std::vector<size_t> trapDepths;
+        int root;
+    };
+
+    void ResolvePendingAction(vaddr_t pc);
+    void ProcessOp(vaddr_t pc, const trace::OpEvent& opEvent);
+    void ProcessTrap(const trace::TrapEvent& trapEvent);
+
+    void Push(CallStack* pStack, vaddr_t function, vaddr_t returnAddress);
+    void Unwind(CallStack* pStack, vaddr_t returnAddress);
+
+    int GetCurrentNode(const CallStack& stack) const;
+    int GetChildNode(int parent, vaddr_t function);
+
+    XLEN m_XLEN;
+
+    std::vector<CallNode> m_Nodes;
+    std::unordered_map<ChildKey, int, ChildKeyHash> m_ChildNodes;
+    CallStack m_Stacks[PrivilegeLevelCount];
+
+    PendingAction m_PendingAction {PendingAction::None};
+    PrivilegeLevel m_PendingPriv {PrivilegeLevel::Machine};
+    vaddr_t m_PendingReturnAddress {0};
+};
+
+}}}
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <utility>
+
+#include <rafi/emu.h>
+
+#include "Profiler.h"
+
+namespace rafi { namespace emu { namespace prof {
+
+namespace {
+
+const char* UnknownFunctionName = "[unknown]";
+
+struct InstructionEntry
+{
+    PrivilegeLevel priv;
+    vaddr_t pc;
+    uint64_t count;
+    uint32_t insn;
+};
+
+template <typename Key>
+std::vector<std::pair<Key, uint64_t>> SortByCount(const std::map<Key, uint64_t>& counts)
+{
+    std::vector<std::pair<Key, uint64_t>> entries(counts.begin(), counts.end());
+
+    std::stable_sort(entries.begin(), entries.end(), [](const std::pair<Key, uint64_t>& lhs, const std::pair<Key, uint64_t>& rhs)
+    {
+        return lhs.second > rhs.second;
+    });
+
+    return entries;
+}
+
+double GetPercent(uint64_t count, uint64_t total)
+{
+    return total == 0 ? 0.0 : 100.0 * count / total;
+}
+
+std::string EscapeJson(const std::string& str)
+{
+    std::string escaped;
+    for (const auto c: str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+}
+
+Profiler::Profiler(XLEN xlen, const ProfilerConfig& config)
+    : m_Config(config)
+    , m_Decoder(xlen)
+    , m_CallStackTracker(xlen)
+    , m_Countdown(config.interval)
+{
+}
+
+void Profiler::LoadSymbolFile(const char* path)
+{
+    m_SymbolTable.LoadElf(path);
+}
+
+void Profiler::Sample(vaddr_t pc, const trace::EventList& eventList)
+{
+    for (const auto& event: eventList)
+    {
+        if (std::holds_alternative<trace::OpEvent>(event))
+        {
+            const auto& opEvent = std::get<trace::OpEvent>(event);
+
+            auto& sample = m_Histograms[static_cast<int>(opEvent.priv)][pc];
+            sample.count++;
+            sample.insn = opEvent.insn;
+
+            m_SampleCount++;
+            m_Countdown = m_Config.interval;
+            return;
+        }
+    }
+
+    // No op is executed in this cycle (e.g. interrupt). Take the sample at the next cycle instead.
+    m_Countdown = 1;
+}
+
+void Profiler::WriteReport() const
+{
+    if (!m_Config.enabled)
+    {
+        return;
+    }
+
+    WriteTextReport(m_Config.path + ".txt");
+    WriteJsonReport(m_Config.path + ".json");
+
+    if (m_Config.enableCallStack)
+    {
+        m_CallStackTracker.WriteFoldedStacks(m_Config.path + ".folded", m_SymbolTable);
+    }
+}
+
+void Profiler::WriteTextReport(const std::string& path) const
+{
+    auto fp = std::fopen(path.c_str(), "w");
+    if (fp == nullptr)
+    {
+        throw FileOpenFailureException(path.c_str());
+    }
+
+    std::map<std::pair<PrivilegeLevel, std::string>, uint64_t> functionCounts;
+    std::map<std::string, uint64_t> opCodeCounts;
+    std::vector<InstructionEntry> instructions;
+
+    std::fprintf(fp, "Profile: %" PRIu64 " samples (interval %d cycles)\n", m_SampleCount, m_Config.interval);
+
+    for (int i = PrivilegeLevelCount - 1; i >= 0; i--)
+    {
+        const auto priv = static_cast<PrivilegeLevel>(i);
+
+        uint64_t privCount = 0;
+        for (const auto& pair: m_Histograms[i])
+        {
+            const auto& sample = pair.second;
+
+            privCount += sample.count;
+            functionCounts[std::make_pair(priv, GetFunctionName(pair.first))] += sample.count;
+            opCodeCounts[GetString(m_Decoder.Decode(sample.insn).opCode)] += sample.count;
+            instructions.push_back(InstructionEntry { priv, pair.first, sample.count, sample.insn });
+        }
+
+        if (privCount > 0)
+        {
+            std::fprintf(fp, "  %-10s %12" PRIu64 " (%6.2f%%)\n", GetString(priv), privCount, GetPercent(privCount, m_SampleCount));
+        }
+    }
+
+    std::sort(instructions.begin(), instructions.end(), [](const InstructionEntry& lhs, const InstructionEntry& rhs)
+    {
+        return lhs.count != rhs.count ? lhs.count > rhs.count : lhs.pc < rhs.pc;
+    });
+
+    std::fprintf(fp, "\nFunctions:\n");
+    std::fprintf(fp, "  %4s %12s %8s  %-10s %s\n", "Rank", "Samples", "Percent", "Priv", "Function");
+
+    const auto functions = SortByCount(functionCounts);
+    for (size_t i = 0; i < functions.size() && i < ReportLineCount; i++)
+    {
+        const auto& key = functions[i].first;
+        const auto count = functions[i].second;
+
+        std::fprintf(fp, "  %4zu %12" PRIu64 " %7.2f%%  %-10s %s\n",
+            i + 1, count, GetPercent(count, m_SampleCount), GetString(key.first), key.second.c_str());
+    }
+
+    std::fprintf(fp, "\nInstructions:\n");
+    std::fprintf(fp, "  %4s %12s %8s  %-10s %-16s %-10s %s\n", "Rank", "Samples", "Percent", "Priv", "PC", "OpCode", "Location");
+
+    for (size_t i = 0; i < instructions.size() && i < ReportLineCount; i++)
+    {
+        const auto& entry = instructions[i];
+
+        std::fprintf(fp, "  %4zu %12" PRIu64 " %7.2f%%  %-10s %016" PRIx64 " %-10s %s\n",
+            i + 1, entry.count, GetPercent(entry.count, m_SampleCount),
+            GetString(entry.priv), static_cast<uint64_t>(entry.pc),
+            GetString(m_Decoder.Decode(entry.insn).opCode), GetLocation(entry.pc).c_str());
+    }
+
+    std::fprintf(fp, "\nOpCodes:\n");
+    std::fprintf(fp, "  %4s %12s %8s  %s\n", "Rank", "Samples", "Percent", "OpCode");
+
+    const auto opCodes = SortByCount(opCodeCounts);
+    for (size_t i = 0; i < opCodes.size() && i < ReportLineCount; i++)
+    {
+        std::fprintf(fp, "  %4zu %12" PRIu64 " %7.2f%%  %s\n",
+            i + 1, opCodes[i].second, GetPercent(opCodes[i].second, m_SampleCount), opCodes[i].first.c_str());
+    }
+
+    std::fclose(fp);
+}
+
+void Profiler::WriteJsonReport(const std::string& path) const
+{
+    auto fp = std::fopen(path.c_str(), "w");
+    if (fp == nullptr)
+    {
+        throw FileOpenFailureException(path.c_str());
+    }
+
+    std::fprintf(fp, "{\n");
+    std::fprintf(fp, "  \"interval\": %d,\n", m_Config.interval);
+    std::fprintf(fp, "  \"samples\": %" PRIu64 ",\n", m_SampleCount);
+    std::fprintf(fp, "  \"instructions\": [");
+
+    bool first = true;
+    for (int i = PrivilegeLevelCount - 1; i >= 0; i--)
+    {
+        const auto priv = static_cast<PrivilegeLevel>(i);
+
+        for (const auto& pair: m_Histograms[i])
+        {
+            const auto& sample = pair.second;
+
+            std::fprintf(fp, "%s\n    {\"priv\": \"%s\", \"pc\": %" PRIu64 ", \"insn\": %" PRIu32 ", \"opcode\": \"%s\", \"location\": \"%s\", \"samples\": %" PRIu64 "}",
+                first ? "" : ",",
+                GetString(priv), static_cast<uint64_t>(pair.first), sample.insn,
+                GetString(m_Decoder.Decode(sample.insn).opCode), EscapeJson(GetLocation(pair.first)).c_str(), sample.count);
+
+            first = false;
+        }
+    }
+
+    std::fprintf(fp, "\n  ]\n");
+    std::fprintf(fp, "}\n");
+
+    std::fclose(fp);
+}
+
+std::string Profiler::GetLocation(vaddr_t pc) const
+{
+    const auto pSymbol = m_SymbolTable.Find(pc);
+    if (pSymbol == nullptr)
+    {
+        return UnknownFunctionName;
+    }
+
+    char offset[32];
+    std::snprintf(offset, sizeof(offset), "+0x%" PRIx64, static_cast<uint64_t>(pc - pSymbol->address));
+
+    return pSymbol->name + offset;
+}
+
+std::string Profiler::GetFunctionName(vaddr_t pc) const
+{
+    const auto pSymbol = m_SymbolTable.Find(pc);
+
+    return pSymbol == nullptr ? UnknownFunctionName : pSymbol->name;
+}
+
+}}}
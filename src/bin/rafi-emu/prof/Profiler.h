@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <rafi/emu.h>
+#include <rafi/trace.h>
+
+#include "CallStackTracker.h"
+#include "SymbolTable.h"
+
+namespace rafi { namespace emu { namespace prof {
+
+struct ProfilerConfig
+{
+    bool enabled;
+    bool enableCallStack;
+    int interval;
+    std::string path;
+    std::vector<std::string> elfPaths;
+};
+
+// Sampling profiler of guest code.
+// Every 'interval' cycles, records pc, privilege level and instruction of the op executed in that cycle.
+// Reports are written to "<path>.txt" (ranked functions, instructions and opcodes) and "<path>.json".
+// If call stack tracking is enabled, op counts of every call stack are written to "<path>.folded".
+class Profiler
+{
+public:
+    Profiler(XLEN xlen, const ProfilerConfig& config);
+
+    void LoadSymbolFile(const char* path);
+
+    bool IsEnabled() const
+    {
+        return m_Config.enabled;
+    }
+
+    void ProcessCycle(vaddr_t pc, const trace::EventList& eventList)
+    {
+        if (m_Config.enableCallStack)
+        {
+            m_CallStackTracker.ProcessCycle(pc, eventList);
+        }
+
+        if (--m_Countdown > 0)
+        {
+            return;
+        }
+
+        Sample(pc, eventList);
+    }
+
+    void WriteReport() const;
+
+private:
+    static const int PrivilegeLevelCount = 4;
+    static const size_t ReportLineCount = 50;
+
+    struct InstructionSample
+    {
+        uint64_t count;
+        uint32_t insn;
+    };
+
+    using Histogram = std::unordered_map<vaddr_t, InstructionSample>;
+
+    void Sample(vaddr_t pc, const trace::EventList& eventList);
+
+    void WriteTextReport(const std::string& path) const;
+    void WriteJsonReport(const std::string& path) const;
+
+    std::string GetLocation(vaddr_t pc) const;
+    std::string GetFunctionName(vaddr_t pc) const;
+
+    ProfilerConfig m_Config;
+    Decoder m_Decoder;
+    SymbolTable m_SymbolTable;
+    CallStackTracker m_CallStackTracker;
+
+    Histogram m_Histograms[PrivilegeLevelCount];
+    uint64_t m_SampleCount {0};
+    int m_Countdown {0};
+};
+
+}}}
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <rafi/emu.h>
+
+#include "SymbolTable.h"
+
+namespace rafi { namespace emu { namespace prof {
+
+namespace {
+
+// ELF structures are defined here instead of using <elf.h> which is not available on Windows.
+struct Elf32_Ehdr
+{
+    uint8_t e_ident[16];
+    uint16_t e_type;
+    uint16_t e_machine;
+    uint32_t e_version;
+    uint32_t e_entry;
+    uint32_t e_phoff;
+    uint32_t e_shoff;
+    uint32_t e_flags;
+    uint16_t e_ehsize;
+    uint16_t e_phentsize;
+    uint16_t e_phnum;
+    uint16_t e_shentsize;
+    uint16_t e_shnum;
+    uint16_t e_shstrndx;
+};
+
+struct Elf64_Ehdr
+{
+    uint8_t e_ident[16];
+    uint16_t e_type;
+    uint16_t e_machine;
+    uint32_t e_version;
+    uint64_t e_entry;
+    uint64_t e_phoff;
+    uint64_t e_shoff;
+    uint32_t e_flags;
+    uint16_t e_ehsize;
+    uint16_t e_phentsize;
+    uint16_t e_phnum;
+    uint16_t e_shentsize;
+    uint16_t e_shnum;
+    uint16_t e_shstrndx;
+};
+
+struct Elf32_Shdr
+{
+    uint32_t sh_name;
+    uint32_t sh_type;
+    uint32_t sh_flags;
+    uint32_t sh_addr;
+    uint32_t sh_offset;
+    uint32_t sh_size;
+    uint32_t sh_link;
+    uint32_t sh_info;
+    uint32_t sh_addralign;
+    uint32_t sh_entsize;
+};
+
+struct Elf64_Shdr
+{
+    uint32_t sh_name;
+    uint32_t sh_type;
+    uint64_t sh_flags;
+    uint64_t sh_addr;
+    uint64_t sh_offset;
+    uint64_t sh_size;
+    uint32_t sh_link;
+    uint32_t sh_info;
+    uint64_t sh_addralign;
+    uint64_t sh_entsize;
+};
+
+struct Elf32_Sym
+{
+    uint32_t st_name;
+    uint32_t st_value;
+    uint32_t st_size;
+    uint8_t st_info;
+    uint8_t st_other;
+    uint16_t st_shndx;
+};
+
+struct Elf64_Sym
+{
+    uint32_t st_name;
+    uint8_t st_info;
+    uint8_t st_other;
+    uint16_t st_shndx;
+    uint64_t st_value;
+    uint64_t st_size;
+};
+
+const int EI_CLASS = 4;
+const int EI_DATA = 5;
+const uint8_t ELFCLASS32 = 1;
+const uint8_t ELFCLASS64 = 2;
+const uint8_t ELFDATA2LSB = 1;
+
+const uint32_t SHT_SYMTAB = 2;
+const uint64_t SHF_EXECINSTR = 0x4;
+
+const uint8_t STT_NOTYPE = 0;
+const uint8_t STT_FUNC = 2;
+
+const uint16_t SHN_LORESERVE = 0xff00;
+
+template <typename T>
+bool ReadStruct(T* pOut, const std::vector<char>& image, uint64_t offset)
+{
+    if (offset > image.size() || image.size() - offset < sizeof(T))
+    {
+        return false;
+    }
+
+    std::memcpy(pOut, &image[offset], sizeof(T));
+    return true;
+}
+
+bool IsProfilingTarget(const char* name)
+{
+    // Skip mapping symbols ($x, $d) and assembler local labels.
+    return name[0] != '\0' && name[0] != '$' && std::strncmp(name, ".L", 2) != 0;
+}
+
+}
+
+void SymbolTable::LoadElf(const char* path)
+{
+    std::ifstream f(path, std::ios::in | std::ios::binary);
+    if (!f.is_open())
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    const std::vector<char> image((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    if (image.size() < 16 || std::memcmp(image.data(), "\x7f" "ELF", 4) != 0)
+    {
+        throw FileOpenFailureException(path, "not an ELF file");
+    }
+    if (image[EI_DATA] != ELFDATA2LSB)
+    {
+        throw FileOpenFailureException(path, "big endian ELF is not supported");
+    }
+
+    switch (image[EI_CLASS])
+    {
+    case ELFCLASS32:
+        LoadSymbols<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(path, image);
+        break;
+    case ELFCLASS64:
+        LoadSymbols<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(path, image);
+        break;
+    default:
+        throw FileOpenFailureException(path, "unknown ELF class");
+    }
+
+    // Sort by address, and keep one symbol per address preferring sized (i.e. function) symbols.
+    std::sort(m_Symbols.begin(), m_Symbols.end(), [](const Symbol& lhs, const Symbol& rhs)
+    {
+        return lhs.address != rhs.address ? lhs.address < rhs.address : lhs.size > rhs.size;
+    });
+
+    const auto end = std::unique(m_Symbols.begin(), m_Symbols.end(), [](const Symbol& lhs, const Symbol& rhs)
+    {
+        return lhs.address == rhs.address;
+    });
+
+    m_Symbols.erase(end, m_Symbols.end());
+}
+
+const Symbol* SymbolTable::Find(uint64_t address) const
+{
+    auto it = std::upper_bound(m_Symbols.begin(), m_Symbols.end(), address, [](uint64_t value, const Symbol& symbol)
+    {
+        return value < symbol.address;
+    });
+
+    if (it == m_Symbols.begin())
+    {
+        return nullptr;
+    }
+
+    --it;
+
+    if (it->size != 0 && address - it->address >= it->size)
+    {
+        return nullptr;
+    }
+
+    return &(*it);
+}
+
+bool SymbolTable::IsEmpty() const
+{
+    return m_Symbols.empty();
+}
+
+template <typename Ehdr, typename Shdr, typename Sym>
+void SymbolTable::LoadSymbols(const char* path, const std::vector<char>& image)
+{
+    Ehdr ehdr;
+    if (!ReadStruct(&ehdr, image, 0) || ehdr.e_shentsize != sizeof(Shdr))
+    {
+        throw FileOpenFailureException(path, "invalid ELF header");
+    }
+
+    std::vector<Shdr> sections(ehdr.e_shnum);
+    for (int i = 0; i < ehdr.e_shnum; i++)
+    {
+        if (!ReadStruct(&sections[i], image, ehdr.e_shoff + static_cast<uint64_t>(i) * sizeof(Shdr)))
+        {
+            throw FileOpenFailureException(path, "invalid ELF section header");
+        }
+    }
+
+    for (const auto& section: sections)
+    {
+        if (section.sh_type != SHT_SYMTAB || section.sh_link >= sections.size())
+        {
+            continue;
+        }
+
+        const auto& strtab = sections[section.sh_link];
+        if (strtab.sh_offset > image.size() || image.size() - strtab.sh_offset < strtab.sh_size)
+        {
+            throw FileOpenFailureException(path, "invalid ELF string table");
+        }
+
+        const auto count = section.sh_size / sizeof(Sym);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            Sym sym;
+            if (!ReadStruct(&sym, image, section.sh_offset + i * sizeof(Sym)))
+            {
+                throw FileOpenFailureException(path, "invalid ELF symbol table");
+            }
+
+            const auto type = sym.st_info & 0xf;
+            if (type != STT_FUNC && type != STT_NOTYPE)
+            {
+                continue;
+            }
+            if (sym.st_shndx == 0 || sym.st_shndx >= SHN_LORESERVE || sym.st_shndx >= sections.size())
+            {
+                continue;
+            }
+            if ((sections[sym.st_shndx].sh_flags & SHF_EXECINSTR) == 0)
+            {
+                continue;
+            }
+            if (sym.st_name >= strtab.sh_size)
+            {
+                continue;
+            }
+
+            const char* name = &image[strtab.sh_offset + sym.st_name];
+            const auto nameLength = strnlen(name, strtab.sh_size - sym.st_name);
+            if (nameLength == strtab.sh_size - sym.st_name || !IsProfilingTarget(name))
+            {
+                continue;
+            }
+
+            m_Symbols.push_back(Symbol { sym.st_value, sym.st_size, std::string(name, nameLength) });
+        }
+    }
+}
+
+}}}
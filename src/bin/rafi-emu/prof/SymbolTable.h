@@ -0,0 +1,51 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rafi { namespace emu { namespace prof {
+
+struct Symbol
+{
+    uint64_t address;
+    uint64_t size;
+    std::string name;
+};
+
+// Function symbols collected from the .symtab of ELF32/ELF64 little-endian files.
+class SymbolTable
+{
+public:
+    void LoadElf(const char* path);
+
+    // Returns nullptr if no symbol covers the address.
+    // A symbol with size 0 is assumed to extend to the next symbol.
+    const Symbol* Find(uint64_t address) const;
+
+    bool IsEmpty() const;
+
+private:
+    template <typename Ehdr, typename Shdr, typename Sym>
+    void LoadSymbols(const char* path, const std::vector<char>& image);
+
+    std::vector<Symbol> m_Symbols;
+};
+
+}}}
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include "Benchmark.h"
+
+namespace rafi { namespace microbench {
+
+namespace {
+
+const uint64_t MaxIterationCount = 1ull << 40;
+
+}
+
+double GetMedian(const std::vector<double>& values)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+
+    auto sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+
+    return sorted[sorted.size() / 2];
+}
+
+double GetMin(const std::vector<double>& values)
+{
+    return values.empty() ? 0.0 : *std::min_element(values.begin(), values.end());
+}
+
+void BenchmarkRunner::Add(const std::string& name, BenchmarkFunction function)
+{
+    m_Benchmarks.push_back(Benchmark { name, function });
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::Run(const std::string& filter, int minTimeMs, int repeat) const
+{
+    std::vector<BenchmarkResult> results;
+
+    for (const auto& benchmark: m_Benchmarks)
+    {
+        if (benchmark.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        BenchmarkResult result { benchmark.name, Calibrate(benchmark, minTimeMs), {} };
+
+        for (int i = 0; i < repeat; i++)
+        {
+            result.nsPerIteration.push_back(Measure(benchmark, result.iterationCount) / result.iterationCount);
+        }
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+uint64_t BenchmarkRunner::Calibrate(const Benchmark& benchmark, int minTimeMs) const
+{
+    const double minTimeNs = minTimeMs * 1000.0 * 1000.0;
+
+    uint64_t iterationCount = 1;
+
+    while (iterationCount < MaxIterationCount)
+    {
+        const auto ns = Measure(benchmark, iterationCount);
+
+        if (ns >= minTimeNs)
+        {
+            break;
+        }
+
+        // Grow by at most 10x to avoid overshooting due to a noisy short measurement.
+        const auto scale = ns <= 0.0 ? 10.0 : std::min(10.0, minTimeNs * 1.2 / ns);
+        iterationCount = std::max(iterationCount + 1, static_cast<uint64_t>(iterationCount * scale));
+    }
+
+    return iterationCount;
+}
+
+double BenchmarkRunner::Measure(const Benchmark& benchmark, uint64_t iterationCount) const
+{
+    const auto begin = std::chrono::steady_clock::now();
+    benchmark.function(iterationCount);
+    const auto end = std::chrono::steady_clock::now();
+
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+}
+
+}}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rafi { namespace microbench {
+
+// Keeps value alive so that the computation of value is not optimized away.
+template <typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile T s_Sink;
+    s_Sink = value;
+#endif
+}
+
+// Number of inputs prepared by a benchmark, which are used in turn by iterations.
+// Power of two to wrap iteration index by mask.
+const size_t InputCount = 4096;
+
+inline size_t GetInputIndex(uint64_t iteration)
+{
+    return static_cast<size_t>(iteration & (InputCount - 1));
+}
+
+// Body of benchmark which runs the measured operation iterationCount times.
+// Setup should be done before registration (e.g. in objects captured by the lambda) so that it is not measured.
+using BenchmarkFunction = std::function<void(uint64_t iterationCount)>;
+
+struct BenchmarkResult
+{
+    std::string name;
+    uint64_t iterationCount;
+    std::vector<double> nsPerIteration;
+};
+
+double GetMedian(const std::vector<double>& values);
+double GetMin(const std::vector<double>& values);
+
+// Minimal substitute of google benchmark.
+// Iteration count is calibrated once per benchmark so that one repetition takes at least minTimeMs,
+// then the same iteration count is used in every repetition to make repetitions comparable.
+class BenchmarkRunner
+{
+public:
+    void Add(const std::string& name, BenchmarkFunction function);
+
+    std::vector<BenchmarkResult> Run(const std::string& filter, int minTimeMs, int repeat) const;
+
+private:
+    struct Benchmark
+    {
+        std::string name;
+        BenchmarkFunction function;
+    };
+
+    uint64_t Calibrate(const Benchmark& benchmark, int minTimeMs) const;
+    double Measure(const Benchmark& benchmark, uint64_t iterationCount) const;
+
+    std::vector<Benchmark> m_Benchmarks;
+};
+
+// Registration functions implemented in each *Benchmark.cpp
+void RegisterDecoderBenchmarks(BenchmarkRunner* pRunner);
+void RegisterBusBenchmarks(BenchmarkRunner* pRunner);
+void RegisterMemoryAccessUnitBenchmarks(BenchmarkRunner* pRunner);
+void RegisterFpBenchmarks(BenchmarkRunner* pRunner);
+void RegisterRegisterBenchmarks(BenchmarkRunner* pRunner);
+
+}}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <rafi/emu.h>
+
+#include "../rafi-emu/io/Clint.h"
+
+#include "Benchmark.h"
+
+namespace rafi { namespace microbench {
+
+namespace {
+
+// Same address map as emu::System
+const paddr_t AddrRam = 0x80000000;
+const paddr_t AddrClint = 0x02000000;
+const paddr_t AddrMtimecmp = AddrClint + 0x4000;
+
+const size_t RamSize = 1024 * 1024;
+
+struct BusFixture
+{
+    BusFixture()
+        : ram(RamSize)
+    {
+        bus.RegisterMemory(&ram, AddrRam, ram.GetCapacity());
+        bus.RegisterIo(&clint, AddrClint, clint.GetSize());
+
+        // 8-byte aligned addresses scattered over RAM with a fixed seed.
+        uint32_t seed = 1;
+        for (size_t i = 0; i < InputCount; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            ramAddresses.push_back(AddrRam + ((seed >> 8) % (RamSize / 8)) * 8);
+        }
+    }
+
+    emu::Bus bus;
+    emu::Ram ram;
+    emu::io::Clint clint;
+
+    std::vector<paddr_t> ramAddresses;
+};
+
+}
+
+void RegisterBusBenchmarks(BenchmarkRunner* pRunner)
+{
+    auto pFixture = std::make_shared<BusFixture>();
+
+    pRunner->Add("Bus::ReadUInt32/Ram", [pFixture](uint64_t iterationCount)
+    {
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            DoNotOptimize(pFixture->bus.ReadUInt32(pFixture->ramAddresses[GetInputIndex(i)]));
+        }
+    });
+
+    pRunner->Add("Bus::ReadUInt64/Ram", [pFixture](uint64_t iterationCount)
+    {
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            DoNotOptimize(pFixture->bus.ReadUInt64(pFixture->ramAddresses[GetInputIndex(i)]));
+        }
+    });
+
+    // mtimecmp of CLINT is readable without processor.
+    pRunner->Add("Bus::ReadUInt32/Mmio", [pFixture](uint64_t iterationCount)
+    {
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            DoNotOptimize(pFixture->bus.ReadUInt32(AddrMtimecmp));
+        }
+    });
+
+    pRunner->Add("Bus::ReadUInt64/Mmio", [pFixture](uint64_t iterationCount)
+    {
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            DoNotOptimize(pFixture->bus.ReadUInt64(AddrMtimecmp));
+        }
+    });
+}
+
+}}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <rafi/common.h>
+
+#include "Benchmark.h"
+
+namespace rafi { namespace microbench {
+
+namespace {
+
+struct WeightedInsn
+{
+    uint32_t insn;
+    int weight;
+};
+
+// Instruction mix resembling RV64GC integer code: loads and ALU ops dominate, and about a third is compressed.
+const WeightedInsn InsnMix[] = {
+    { 0x00843783, 6 }, // ld a5, 8(s0)
+    { 0x0007a703, 4 }, // lw a4, 0(a5)
+    { 0x00154683, 3 }, // lbu a3, 1(a0)
+    { 0x00113c23, 3 }, // sd ra, 24(sp)
+    { 0x00e4a623, 2 }, // sw a4, 12(s1)
+    { 0x00150513, 6 }, // addi a0, a0, 1
+    { 0xfff7879b, 3 }, // addiw a5, a5, -1
+    { 0x00f70733, 4 }, // add a4, a4, a5
+    { 0x40b68633, 2 }, // sub a2, a3, a1
+    { 0x00379793, 2 }, // slli a5, a5, 3
+    { 0x02075713, 2 }, // srli a4, a4, 32
+    { 0x00c6f6b3, 1 }, // and a3, a3, a2
+    { 0x00a5e5b3, 1 }, // or a1, a1, a0
+    { 0x00b54533, 1 }, // xor a0, a0, a1
+    { 0x00d737b3, 1 }, // sltu a5, a4, a3
+    { 0x123457b7, 2 }, // lui a5, 0x12345
+    { 0x00001517, 1 }, // auipc a0, 0x1
+    { 0x00078863, 4 }, // beqz a5, 16
+    { 0xfef710e3, 3 }, // bne a4, a5, -32
+    { 0x00c6e463, 1 }, // bltu a3, a2, 8
+    { 0x100000ef, 2 }, // jal 256
+    { 0x00008067, 2 }, // ret
+    { 0x02d707b3, 1 }, // mul a5, a4, a3
+    { 0x02a5d633, 1 }, // divu a2, a1, a0
+    { 0x00053787, 1 }, // fld fa5, 0(a0)
+    { 0x6ac5f543, 1 }, // fmadd.d fa0, fa1, fa2, fa3
+    { 0x00b6252f, 1 }, // amoadd.w a0, a1, (a2)
+    { 0x30002573, 1 }, // csrr a0, mstatus
+    { 0x0505, 4 },     // c.addi a0, 1
+    { 0x651c, 4 },     // c.ld a5, 8(a0)
+    { 0xe998, 2 },     // c.sd a4, 16(a1)
+    { 0x853e, 4 },     // c.mv a0, a5
+    { 0x973e, 2 },     // c.add a4, a5
+    { 0xe791, 3 },     // c.bnez a5, 12
+    { 0xb7f5, 2 },     // c.j -20
+    { 0x470d, 2 },     // c.li a4, 3
+    { 0x4532, 2 },     // c.lwsp a0, 12(sp)
+    { 0x8082, 2 },     // c.jr ra
+};
+
+// Instruction stream in which each entry of InsnMix appears in proportion to its weight, shuffled by a fixed seed.
+std::vector<uint32_t> MakeInsnStream()
+{
+    std::vector<uint32_t> pool;
+    for (const auto& entry: InsnMix)
+    {
+        pool.insert(pool.end(), entry.weight, entry.insn);
+    }
+
+    std::vector<uint32_t> stream(InputCount);
+
+    uint32_t seed = 1;
+    for (auto& insn: stream)
+    {
+        seed = seed * 1103515245 + 12345;
+        insn = pool[(seed >> 16) % pool.size()];
+    }
+
+    return stream;
+}
+
+}
+
+void RegisterDecoderBenchmarks(BenchmarkRunner* pRunner)
+{
+    auto pDecoder = std::make_shared<Decoder>(XLEN::XLEN64);
+    auto pStream = std::make_shared<std::vector<uint32_t>>(MakeInsnStream());
+
+    pRunner->Add("Decoder::Decode/RV64GC", [pDecoder, pStream](uint64_t iterationCount)
+    {
+        const auto& stream = *pStream;
+
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            const auto op = pDecoder->Decode(stream[GetInputIndex(i)]);
+            DoNotOptimize(op.opCode);
+        }
+    });
+}
+
+}}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <rafi/fp.h>
+
+#include "Benchmark.h"
+
+namespace rafi { namespace microbench {
+
+namespace {
+
+// Round to nearest, ties to even
+const int RoundModeRne = 0;
+
+// Positive normal operands in [1, 2) with a fixed seed, so that every operation takes the common (non-special) path.
+template <typename T, typename HostType>
+std::vector<T> MakeOperands(uint32_t seed)
+{
+    std::vector<T> operands;
+
+    for (size_t i = 0; i < InputCount; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+
+        const HostType value = 1 + static_cast<HostType>(seed >> 8) / (1 << 24);
+
+        T bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        operands.push_back(bits);
+    }
+
+    return operands;
+}
+
+template <typename T, typename HostType>
+struct FpFixture
+{
+    FpFixture()
+        : x(MakeOperands<T, HostType>(1))
+        , y(MakeOperands<T, HostType>(2))
+        , z(MakeOperands<T, HostType>(3))
+    {
+    }
+
+    std::vector<T> x;
+    std::vector<T> y;
+    std::vector<T> z;
+};
+
+template <typename T, typename HostType>
+void AddFpBenchmarks(BenchmarkRunner* pRunner, const std::string& suffix)
+{
+    auto pFixture = std::make_shared<FpFixture<T, HostType>>();
+
+    pRunner->Add("fp::MulAdd/" + suffix, [pFixture](uint64_t iterationCount)
+    {
+        fp::ScopedFpRound scopedFpRound(RoundModeRne);
+
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            const auto index = GetInputIndex(i);
+            DoNotOptimize(fp::MulAdd(pFixture->x[index], pFixture->y[index], pFixture->z[index]));
+        }
+    });
+
+    pRunner->Add("fp::Div/" + suffix, [pFixture](uint64_t iterationCount)
+    {
+        fp::ScopedFpRound scopedFpRound(RoundModeRne);
+
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            const auto index = GetInputIndex(i);
+            DoNotOptimize(fp::Div(pFixture->x[index], pFixture->y[index]));
+        }
+    });
+
+    pRunner->Add("fp::Sqrt/" + suffix, [pFixture](uint64_t iterationCount)
+    {
+        fp::ScopedFpRound scopedFpRound(RoundModeRne);
+
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            DoNotOptimize(fp::Sqrt(pFixture->x[GetInputIndex(i)]));
+        }
+    });
+}
+
+}
+
+void RegisterFpBenchmarks(BenchmarkRunner* pRunner)
+{
+    AddFpBenchmarks<uint32_t, float>(pRunner, "Float");
+    AddFpBenchmarks<uint64_t, double>(pRunner, "Double");
+}
+
+}}
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <rafi/common.h>
+
+#include "Benchmark.h"
+
+namespace po = boost::program_options;
+
+namespace rafi { namespace microbench {
+
+namespace {
+
+const int DefaultMinTimeMs = 200;
+const int DefaultRepeat = 5;
+
+void PrintResults(const std::vector<BenchmarkResult>& results)
+{
+    std::printf("%-36s %14s %12s %12s\n", "Benchmark", "Iterations", "ns/op", "min ns/op");
+
+    for (const auto& result: results)
+    {
+        std::printf("%-36s %14" PRIu64 " %12.3f %12.3f\n",
+            result.name.c_str(),
+            result.iterationCount,
+            GetMedian(result.nsPerIteration),
+            GetMin(result.nsPerIteration));
+    }
+}
+
+void WriteJsonReport(const std::string& path, const std::vector<BenchmarkResult>& results)
+{
+    auto fp = std::fopen(path.c_str(), "w");
+    if (fp == nullptr)
+    {
+        throw FileOpenFailureException(path.c_str());
+    }
+
+    std::fprintf(fp, "{\n");
+    std::fprintf(fp, "  \"benchmarks\": [");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto& result = results[i];
+
+        std::fprintf(fp, "%s\n    {\"name\": \"%s\", \"iterations\": %" PRIu64 ", \"ns_per_op\": %.4f, \"min_ns_per_op\": %.4f}",
+            i == 0 ? "" : ",",
+            result.name.c_str(),
+            result.iterationCount,
+            GetMedian(result.nsPerIteration),
+            GetMin(result.nsPerIteration));
+    }
+
+    std::fprintf(fp, "\n  ]\n");
+    std::fprintf(fp, "}\n");
+
+    std::fclose(fp);
+}
+
+}
+
+}}
+
+int main(int argc, char** argv)
+{
+    int minTimeMs;
+    int repeat;
+
+    po::options_description desc("options");
+    desc.add_options()
+        ("filter", po::value<std::string>(), "run only benchmarks whose name contains this string")
+        ("help", "show help")
+        ("min-time-ms", po::value<int>(&minTimeMs)->default_value(rafi::microbench::DefaultMinTimeMs), "minimum time of one repetition (milliseconds)")
+        ("output", po::value<std::string>(), "path of JSON report")
+        ("repeat", po::value<int>(&repeat)->default_value(rafi::microbench::DefaultRepeat), "number of repetitions");
+
+    po::variables_map variables;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), variables);
+        po::notify(variables);
+    }
+    catch (const po::error& e)
+    {
+        std::cout << e.what() << std::endl;
+        std::exit(1);
+    }
+
+    if (variables.count("help"))
+    {
+        std::cout << desc << std::endl;
+        std::exit(0);
+    }
+
+    if (minTimeMs <= 0 || repeat <= 0)
+    {
+        std::cout << "--min-time-ms and --repeat must be positive." << std::endl;
+        std::exit(1);
+    }
+
+    rafi::microbench::BenchmarkRunner runner;
+    rafi::microbench::RegisterDecoderBenchmarks(&runner);
+    rafi::microbench::RegisterBusBenchmarks(&runner);
+    rafi::microbench::RegisterMemoryAccessUnitBenchmarks(&runner);
+    rafi::microbench::RegisterFpBenchmarks(&runner);
+    rafi::microbench::RegisterRegisterBenchmarks(&runner);
+
+    const auto filter = variables.count("filter") ? variables["filter"].as<std::string>() : "";
+    const auto results = runner.Run(filter, minTimeMs, repeat);
+
+    rafi::microbench::PrintResults(results);
+
+    if (variables.count("output"))
+    {
+        try
+        {
+            rafi::microbench::WriteJsonReport(variables["output"].as<std::string>(), results);
+        }
+        catch (const rafi::FileOpenFailureException& e)
+        {
+            e.PrintMessage();
+            std::exit(1);
+        }
+    }
+
+    return 0;
+}
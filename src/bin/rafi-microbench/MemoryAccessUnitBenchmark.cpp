@@ -0,0 +1,166 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <rafi/emu.h>
+
+#include "../rafi-emu/cpu/Csr.h"
+#include "../rafi-emu/cpu/MemoryAccessUnit.h"
+
+#include "Benchmark.h"
+
+namespace rafi { namespace microbench {
+
+namespace {
+
+const paddr_t AddrRam = 0x80000000;
+const size_t RamSize = 4 * 1024 * 1024;
+
+// Page tables and pages in RAM
+const paddr_t PageTableAddress = AddrRam + 0x100000;
+const paddr_t PageAddress = AddrRam + 0x200000;
+
+// Virtual address of the 4KB pages, which is the same for Sv32 and Sv39
+const vaddr_t PageVirtualAddress = 0x40000000;
+const int PageCount = 512;
+const int PageSize = 4096;
+
+// PTE flags
+const uint64_t PteV = 1 << 0;
+const uint64_t PteR = 1 << 1;
+const uint64_t PteW = 1 << 2;
+const uint64_t PteA = 1 << 6;
+const uint64_t PteD = 1 << 7;
+
+uint64_t MakePte(paddr_t address, uint64_t flags)
+{
+    return ((address >> 12) << 10) | flags;
+}
+
+struct TranslationFixture
+{
+    TranslationFixture(XLEN xlen, AddressTranslationMode mode)
+        : ram(RamSize)
+        , csr(xlen, AddrRam)
+        , memoryAccessUnit(xlen)
+    {
+        bus.RegisterMemory(&ram, AddrRam, ram.GetCapacity());
+        memoryAccessUnit.Initialize(&bus, &csr, &eventList);
+
+        switch (mode)
+        {
+        case AddressTranslationMode::Sv32:
+            BuildSv32();
+            break;
+        case AddressTranslationMode::Sv39:
+            BuildSv39();
+            break;
+        default:
+            break;
+        }
+
+        // Addresses over all mapped pages with a fixed seed. Bare mode accesses the same physical pages.
+        const auto base = mode == AddressTranslationMode::Bare ? PageAddress : PageVirtualAddress;
+
+        uint32_t seed = 1;
+        for (size_t i = 0; i < InputCount; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            addresses.push_back(base + ((seed >> 8) % (PageCount * PageSize / 8)) * 8);
+        }
+    }
+
+    // Two level walk: root -> 4KB leaf
+    void BuildSv32()
+    {
+        const auto level0 = PageTableAddress + PageSize;
+
+        bus.WriteUInt32(PageTableAddress + (PageVirtualAddress >> 22) * 4, static_cast<uint32_t>(MakePte(level0, PteV)));
+        for (int i = 0; i < PageCount; i++)
+        {
+            bus.WriteUInt32(level0 + i * 4, static_cast<uint32_t>(MakePte(PageAddress + i * PageSize, PteV | PteR | PteW | PteA | PteD)));
+        }
+
+        csr.WriteUInt64(csr_addr_t::satp, (1ull << 31) | (PageTableAddress >> 12));
+        csr.SetPriv(PrivilegeLevel::Supervisor);
+    }
+
+    // Three level walk: root -> level 1 -> 4KB leaf
+    void BuildSv39()
+    {
+        const auto level1 = PageTableAddress + PageSize;
+        const auto level0 = PageTableAddress + PageSize * 2;
+
+        bus.WriteUInt64(PageTableAddress + (PageVirtualAddress >> 30) * 8, MakePte(level1, PteV));
+        bus.WriteUInt64(level1 + ((PageVirtualAddress >> 21) & 0x1ff) * 8, MakePte(level0, PteV));
+        for (int i = 0; i < PageCount; i++)
+        {
+            bus.WriteUInt64(level0 + i * 8, MakePte(PageAddress + i * PageSize, PteV | PteR | PteW | PteA | PteD));
+        }
+
+        csr.WriteUInt64(csr_addr_t::satp, (8ull << 60) | (PageTableAddress >> 12));
+        csr.SetPriv(PrivilegeLevel::Supervisor);
+    }
+
+    emu::Bus bus;
+    emu::Ram ram;
+    emu::cpu::Csr csr;
+    trace::EventList eventList;
+    emu::cpu::MemoryAccessUnit memoryAccessUnit;
+
+    std::vector<vaddr_t> addresses;
+};
+
+void AddTranslateBenchmark(BenchmarkRunner* pRunner, const char* name, XLEN xlen, AddressTranslationMode mode)
+{
+    auto pFixture = std::make_shared<TranslationFixture>(xlen, mode);
+
+    // Fail early rather than measuring the page fault path.
+    paddr_t paddr;
+    if (pFixture->memoryAccessUnit.Translate(&paddr, MemoryAccessType::Load, pFixture->addresses[0]))
+    {
+        std::fprintf(stderr, "[%s] Failed to translate address 0x%016" PRIx64 ".\n", name, static_cast<uint64_t>(pFixture->addresses[0]));
+        std::exit(1);
+    }
+
+    pRunner->Add(name, [pFixture](uint64_t iterationCount)
+    {
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            paddr_t paddr;
+            const auto trap = pFixture->memoryAccessUnit.Translate(&paddr, MemoryAccessType::Load, pFixture->addresses[GetInputIndex(i)]);
+
+            DoNotOptimize(paddr);
+            DoNotOptimize(trap.has_value());
+        }
+    });
+}
+
+}
+
+void RegisterMemoryAccessUnitBenchmarks(BenchmarkRunner* pRunner)
+{
+    AddTranslateBenchmark(pRunner, "MemoryAccessUnit::Translate/Bare", XLEN::XLEN64, AddressTranslationMode::Bare);
+    AddTranslateBenchmark(pRunner, "MemoryAccessUnit::Translate/Sv32", XLEN::XLEN32, AddressTranslationMode::Sv32);
+    AddTranslateBenchmark(pRunner, "MemoryAccessUnit::Translate/Sv39", XLEN::XLEN64, AddressTranslationMode::Sv39);
+}
+
+}}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <rafi/emu.h>
+
+#include "../rafi-emu/cpu/Csr.h"
+#include "../rafi-emu/cpu/IntRegFile.h"
+
+#include "Benchmark.h"
+
+namespace rafi { namespace microbench {
+
+namespace {
+
+// CSRs frequently accessed by kernels (trap handling, counters and fp state)
+const csr_addr_t CsrMix[] = {
+    csr_addr_t::mstatus,
+    csr_addr_t::mepc,
+    csr_addr_t::mcause,
+    csr_addr_t::mie,
+    csr_addr_t::mip,
+    csr_addr_t::mtvec,
+    csr_addr_t::sstatus,
+    csr_addr_t::sepc,
+    csr_addr_t::scause,
+    csr_addr_t::satp,
+    csr_addr_t::cycle,
+    csr_addr_t::time,
+    csr_addr_t::instret,
+    csr_addr_t::fcsr,
+};
+
+std::vector<int> MakeIndices(int range)
+{
+    std::vector<int> indices;
+
+    uint32_t seed = 1;
+    for (size_t i = 0; i < InputCount; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        indices.push_back(static_cast<int>((seed >> 16) % range));
+    }
+
+    return indices;
+}
+
+struct CsrFixture
+{
+    CsrFixture()
+        : csr(XLEN::XLEN64, 0x80000000)
+        , indices(MakeIndices(static_cast<int>(sizeof(CsrMix) / sizeof(CsrMix[0]))))
+    {
+    }
+
+    emu::cpu::Csr csr;
+    std::vector<int> indices;
+};
+
+struct IntRegFileFixture
+{
+    IntRegFileFixture()
+        : indices(MakeIndices(IntRegCount))
+    {
+    }
+
+    emu::cpu::IntRegFile intRegFile;
+    std::vector<int> indices;
+};
+
+}
+
+void RegisterRegisterBenchmarks(BenchmarkRunner* pRunner)
+{
+    auto pCsrFixture = std::make_shared<CsrFixture>();
+
+    pRunner->Add("Csr::ReadUInt64", [pCsrFixture](uint64_t iterationCount)
+    {
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            DoNotOptimize(pCsrFixture->csr.ReadUInt64(CsrMix[pCsrFixture->indices[GetInputIndex(i)]]));
+        }
+    });
+
+    auto pIntRegFileFixture = std::make_shared<IntRegFileFixture>();
+
+    pRunner->Add("IntRegFile::ReadUInt64", [pIntRegFileFixture](uint64_t iterationCount)
+    {
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            DoNotOptimize(pIntRegFileFixture->intRegFile.ReadUInt64(pIntRegFileFixture->indices[GetInputIndex(i)]));
+        }
+    });
+
+    // Read-modify-write like an ALU op (rd = rs1 + rs2)
+    pRunner->Add("IntRegFile/AluReadWrite", [pIntRegFileFixture](uint64_t iterationCount)
+    {
+        auto& intRegFile = pIntRegFileFixture->intRegFile;
+        const auto& indices = pIntRegFileFixture->indices;
+
+        for (uint64_t i = 0; i < iterationCount; i++)
+        {
+            const auto rs1 = intRegFile.ReadUInt64(indices[GetInputIndex(i)]);
+            const auto rs2 = intRegFile.ReadUInt64(indices[GetInputIndex(i + 1)]);
+
+            intRegFile.WriteUInt64(indices[GetInputIndex(i + 2)], rs1 + rs2 + 1);
+        }
+
+        DoNotOptimize(intRegFile.ReadUInt64(1));
+    });
+}
+
+}}
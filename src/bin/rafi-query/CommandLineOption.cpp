@@ -0,0 +1,213 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include <boost/program_options.hpp>
+
+#include <rafi/trace.h>
+
+#include "CommandLineOption.h"
+
+namespace po = boost::program_options;
+
+namespace rafi { namespace query {
+
+namespace {
+    const uint64_t DefaultRowEnd = UINT64_MAX;
+
+    uint32_t GetAccessBit(MemoryAccessType accessType)
+    {
+        return 1u << static_cast<uint32_t>(accessType);
+    }
+}
+
+CommandLineOption::CommandLineOption(int argc, char** argv)
+{
+    std::string access;
+
+    po::options_description optDesc("options");
+    optDesc.add_options()
+        ("access,a", po::value<std::string>(&access), "access types reported by --page and --paddr-range, comma separated list of fetch, load and store (default: all)")
+        ("begin,b", po::value<uint64_t>(&m_RowBegin)->default_value(0), "cycle to begin query")
+        ("block-cycles", po::value<uint32_t>(&m_BlockCycleCount)->default_value(trace::DefaultColumnStoreBlockCycleCount), "number of cycles in a block of column store (with --input)")
+        ("count-only,n", "print only number of matched cycles or memory events")
+        ("end,e", po::value<uint64_t>(&m_RowEnd)->default_value(DefaultRowEnd), "cycle to end query")
+        ("input,i", po::value<std::string>(&m_InputPath), "input trace path to convert into column store")
+        ("page", po::value<std::string>(), "query memory events to the physical page which contains the address (hex)")
+        ("paddr-range", po::value<std::string>(), "query memory events to physical addresses in <begin>:<end> (hex, end is exclusive)")
+        ("pc", po::value<std::string>(), "query cycles executing the pc (hex)")
+        ("pc-range", po::value<std::string>(), "query cycles executing pc in <begin>:<end> (hex, end is exclusive)")
+        ("store,s", po::value<std::string>(&m_StorePath), "column store path (.tcol)")
+        ("help,h", "show help");
+
+    po::positional_options_description posOptDesc;
+    posOptDesc.add("store", -1);
+
+    po::variables_map optMap;
+    try
+    {
+        po::store(po::command_line_parser(argc, argv).options(optDesc).positional(posOptDesc).run(), optMap);
+        po::notify(optMap);
+    }
+    catch (const boost::program_options::error_with_option_name& e)
+    {
+        std::cout << e.what() << std::endl;
+        std::exit(1);
+    }
+
+    if (optMap.count("help") > 0 || optMap.count("store") == 0)
+    {
+        std::cout << optDesc << std::endl;
+        std::exit(0);
+    }
+
+    const auto queryCount = optMap.count("pc") + optMap.count("page") + optMap.count("pc-range") + optMap.count("paddr-range");
+    if (queryCount > 1 || (queryCount > 0 && optMap.count("input") > 0))
+    {
+        std::cout << "Specify only one of --input, --pc, --page, --pc-range and --paddr-range." << std::endl;
+        std::exit(1);
+    }
+
+    if (optMap.count("input") > 0)
+    {
+        m_QueryType = QueryType::Build;
+    }
+    else if (optMap.count("pc") > 0)
+    {
+        m_QueryType = QueryType::Pc;
+        m_QueryMin = std::strtoull(optMap["pc"].as<std::string>().c_str(), nullptr, 16);
+    }
+    else if (optMap.count("page") > 0)
+    {
+        m_QueryType = QueryType::Page;
+        m_QueryMin = std::strtoull(optMap["page"].as<std::string>().c_str(), nullptr, 16);
+    }
+    else if (optMap.count("pc-range") > 0)
+    {
+        m_QueryType = QueryType::PcRange;
+        ParseRange(optMap["pc-range"].as<std::string>());
+    }
+    else if (optMap.count("paddr-range") > 0)
+    {
+        m_QueryType = QueryType::PaddrRange;
+        ParseRange(optMap["paddr-range"].as<std::string>());
+    }
+    else
+    {
+        m_QueryType = QueryType::Summary;
+    }
+
+    m_CountOnly = optMap.count("count-only") > 0;
+
+    if (access.empty())
+    {
+        m_AccessMask = GetAccessBit(MemoryAccessType::Instruction) | GetAccessBit(MemoryAccessType::Load) | GetAccessBit(MemoryAccessType::Store);
+    }
+    else
+    {
+        std::stringstream ss(access);
+        std::string type;
+
+        while (std::getline(ss, type, ','))
+        {
+            if (type == "fetch")
+            {
+                m_AccessMask |= GetAccessBit(MemoryAccessType::Instruction);
+            }
+            else if (type == "load")
+            {
+                m_AccessMask |= GetAccessBit(MemoryAccessType::Load);
+            }
+            else if (type == "store")
+            {
+                m_AccessMask |= GetAccessBit(MemoryAccessType::Store);
+            }
+            else
+            {
+                std::cout << "Unknown access type: " << type << std::endl;
+                std::exit(1);
+            }
+        }
+    }
+}
+
+void CommandLineOption::ParseRange(const std::string& range)
+{
+    const auto delimPos = range.find(':');
+    if (delimPos == std::string::npos)
+    {
+        std::cout << "Range must be <begin>:<end>: " << range << std::endl;
+        std::exit(1);
+    }
+
+    m_QueryMin = std::strtoull(range.substr(0, delimPos).c_str(), nullptr, 16);
+    m_QueryMax = std::strtoull(range.substr(delimPos + 1).c_str(), nullptr, 16);
+}
+
+QueryType CommandLineOption::GetQueryType() const
+{
+    return m_QueryType;
+}
+
+const std::string& CommandLineOption::GetInputPath() const
+{
+    return m_InputPath;
+}
+
+const std::string& CommandLineOption::GetStorePath() const
+{
+    return m_StorePath;
+}
+
+uint64_t CommandLineOption::GetQueryMin() const
+{
+    return m_QueryMin;
+}
+
+uint64_t CommandLineOption::GetQueryMax() const
+{
+    return m_QueryMax;
+}
+
+uint32_t CommandLineOption::GetAccessMask() const
+{
+    return m_AccessMask;
+}
+
+uint64_t CommandLineOption::GetRowBegin() const
+{
+    return m_RowBegin;
+}
+
+uint64_t CommandLineOption::GetRowEnd() const
+{
+    return m_RowEnd;
+}
+
+uint32_t CommandLineOption::GetBlockCycleCount() const
+{
+    return m_BlockCycleCount;
+}
+
+bool CommandLineOption::IsCountOnly() const
+{
+    return m_CountOnly;
+}
+
+}}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace rafi { namespace query {
+
+enum class QueryType
+{
+    Build,
+    Pc,
+    Page,
+    PcRange,
+    PaddrRange,
+    Summary,
+};
+
+class CommandLineOption
+{
+public:
+    CommandLineOption(int argc, char** argv);
+
+    QueryType GetQueryType() const;
+
+    const std::string& GetInputPath() const;
+    const std::string& GetStorePath() const;
+
+    // Key of the query. For range queries, [GetQueryMin(), GetQueryMax()) is queried.
+    uint64_t GetQueryMin() const;
+    uint64_t GetQueryMax() const;
+
+    // Bit mask of (1 << MemoryAccessType) to be reported by memory queries.
+    uint32_t GetAccessMask() const;
+
+    uint64_t GetRowBegin() const;
+    uint64_t GetRowEnd() const;
+    uint32_t GetBlockCycleCount() const;
+    bool IsCountOnly() const;
+
+private:
+    void ParseRange(const std::string& range);
+
+    QueryType m_QueryType;
+
+    std::string m_InputPath;
+    std::string m_StorePath;
+
+    uint64_t m_QueryMin{ 0 };
+    uint64_t m_QueryMax{ 0 };
+    uint32_t m_AccessMask{ 0 };
+
+    uint64_t m_RowBegin;
+    uint64_t m_RowEnd;
+    uint32_t m_BlockCycleCount;
+    bool m_CountOnly{ false };
+};
+
+}}
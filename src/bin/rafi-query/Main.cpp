@@ -0,0 +1,389 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <rafi/trace.h>
+
+#include "CommandLineOption.h"
+
+namespace rafi { namespace query {
+
+namespace {
+    const size_t BatchSize = 64 * 1024;
+
+    const uint32_t CycleColumnMask = trace::GetColumnMask(trace::ColumnId_Pc)
+        | trace::GetColumnMask(trace::ColumnId_Insn)
+        | trace::GetColumnMask(trace::ColumnId_Priv)
+        | trace::GetColumnMask(trace::ColumnId_Flags);
+
+    const uint32_t MemoryColumnMask = trace::GetColumnMask(trace::ColumnId_Pc)
+        | trace::GetColumnMask(trace::ColumnId_MemCycleIndex)
+        | trace::GetColumnMask(trace::ColumnId_MemAccessType)
+        | trace::GetColumnMask(trace::ColumnId_MemSize)
+        | trace::GetColumnMask(trace::ColumnId_MemValue)
+        | trace::GetColumnMask(trace::ColumnId_MemVaddr)
+        | trace::GetColumnMask(trace::ColumnId_MemPaddr);
+
+    // Columns needed to count memory events without printing them.
+    const uint32_t MemoryCountColumnMask = trace::GetColumnMask(trace::ColumnId_MemCycleIndex)
+        | trace::GetColumnMask(trace::ColumnId_MemAccessType)
+        | trace::GetColumnMask(trace::ColumnId_MemSize)
+        | trace::GetColumnMask(trace::ColumnId_MemPaddr);
+}
+
+// Keeps the last decompressed block, because rows given by indexes are clustered in a few blocks in most cases.
+class BlockCache
+{
+public:
+    BlockCache(const trace::ColumnStoreReader& reader, uint32_t columnMask)
+        : m_Reader(reader)
+        , m_ColumnMask(columnMask)
+    {
+    }
+
+    const trace::CycleBatch& Get(size_t index)
+    {
+        if (index != m_Index)
+        {
+            m_Reader.ReadBlock(&m_Batch, index, m_ColumnMask);
+            m_Index = index;
+        }
+
+        return m_Batch;
+    }
+
+private:
+    const trace::ColumnStoreReader& m_Reader;
+    uint32_t m_ColumnMask;
+    size_t m_Index{ SIZE_MAX };
+    trace::CycleBatch m_Batch;
+};
+
+class QueryRunner
+{
+public:
+    QueryRunner(const CommandLineOption& option, const trace::ColumnStoreReader& reader)
+        : m_Option(option)
+        , m_Reader(reader)
+        , m_CycleCache(reader, option.IsCountOnly() ? trace::GetColumnMask(trace::ColumnId_Pc) : CycleColumnMask)
+        , m_MemoryCache(reader, option.IsCountOnly() ? MemoryCountColumnMask : MemoryColumnMask)
+    {
+    }
+
+    void QueryPc()
+    {
+        std::vector<uint64_t> rows;
+        m_Reader.FindPc(&rows, m_Option.GetQueryMin());
+
+        const auto begin = std::lower_bound(rows.begin(), rows.end(), m_Option.GetRowBegin());
+        const auto end = std::lower_bound(begin, rows.end(), m_Option.GetRowEnd());
+
+        if (m_Option.IsCountOnly())
+        {
+            m_MatchCount = static_cast<uint64_t>(end - begin);
+            return;
+        }
+
+        for (auto it = begin; it != end; ++it)
+        {
+            const auto blockIndex = m_Reader.FindBlock(*it);
+            const auto& batch = m_CycleCache.Get(blockIndex);
+
+            PrintCycle(*it, batch, static_cast<size_t>(*it - m_Reader.GetBlock(blockIndex).firstRow));
+        }
+    }
+
+    void QueryPage()
+    {
+        std::vector<uint64_t> memoryEventRows;
+        m_Reader.FindPage(&memoryEventRows, m_Option.GetQueryMin() >> trace::ColumnStorePageShift);
+
+        // Skip memory events in blocks out of the cycle range without decompression.
+        uint64_t memoryEventRowBegin;
+        uint64_t memoryEventRowEnd;
+        GetMemoryEventRowRange(&memoryEventRowBegin, &memoryEventRowEnd);
+
+        const auto begin = std::lower_bound(memoryEventRows.begin(), memoryEventRows.end(), memoryEventRowBegin);
+        const auto end = std::lower_bound(begin, memoryEventRows.end(), memoryEventRowEnd);
+
+        for (auto it = begin; it != end; ++it)
+        {
+            const auto memoryEventRow = *it;
+            const auto blockIndex = m_Reader.FindBlockByMemoryEventRow(memoryEventRow);
+            const auto& block = m_Reader.GetBlock(blockIndex);
+            const auto& batch = m_MemoryCache.Get(blockIndex);
+
+            ProcessMemoryEvent(block, batch, static_cast<size_t>(memoryEventRow - block.firstMemoryEventRow));
+        }
+    }
+
+    void QueryPcRange()
+    {
+        // Blocks whose zone map does not overlap the range are skipped without decompression.
+        for (size_t i = 0; i < m_Reader.GetBlockCount(); i++)
+        {
+            const auto& block = m_Reader.GetBlock(i);
+
+            if (!IsBlockInRowRange(block) || block.pcMax < m_Option.GetQueryMin() || m_Option.GetQueryMax() <= block.pcMin)
+            {
+                continue;
+            }
+
+            const auto& batch = m_CycleCache.Get(i);
+
+            for (size_t j = 0; j < block.cycleCount; j++)
+            {
+                const auto row = block.firstRow + j;
+                const auto pc = batch.pc[j];
+
+                if (IsRowInRange(row) && m_Option.GetQueryMin() <= pc && pc < m_Option.GetQueryMax())
+                {
+                    PrintCycle(row, batch, j);
+                }
+            }
+        }
+    }
+
+    void QueryPaddrRange()
+    {
+        for (size_t i = 0; i < m_Reader.GetBlockCount(); i++)
+        {
+            const auto& block = m_Reader.GetBlock(i);
+
+            if (!IsBlockInRowRange(block) || block.memoryEventCount == 0
+                || block.paddrMax < m_Option.GetQueryMin() || m_Option.GetQueryMax() <= block.paddrMin)
+            {
+                continue;
+            }
+
+            const auto& batch = m_MemoryCache.Get(i);
+
+            // Memory events which overlap the range are matched, as well as those which start in the range.
+            for (size_t j = 0; j < block.memoryEventCount; j++)
+            {
+                const auto paddr = batch.memPaddr[j];
+                const auto size = std::max<uint64_t>(batch.memSize[j], 1);
+
+                if (paddr < m_Option.GetQueryMax() && m_Option.GetQueryMin() < paddr + size)
+                {
+                    ProcessMemoryEvent(block, batch, j);
+                }
+            }
+        }
+    }
+
+    void PrintSummary() const
+    {
+        printf("cycles:        %" PRIu64 "\n", m_Reader.GetRowCount());
+        printf("memory events: %" PRIu64 "\n", m_Reader.GetMemoryEventRowCount());
+        printf("blocks:        %zu\n", m_Reader.GetBlockCount());
+
+        for (size_t i = 0; i < m_Reader.GetBlockCount(); i++)
+        {
+            const auto& block = m_Reader.GetBlock(i);
+
+            printf("  [%zu] cycle %" PRIu64 "-%" PRIu64 " pc %016" PRIx64 "-%016" PRIx64,
+                i, block.firstRow, block.firstRow + block.cycleCount - 1, block.pcMin, block.pcMax);
+
+            if (block.memoryEventCount > 0)
+            {
+                printf(" paddr %016" PRIx64 "-%016" PRIx64, block.paddrMin, block.paddrMax);
+            }
+
+            printf("\n");
+        }
+    }
+
+    void PrintCount(const char* unit) const
+    {
+        printf("%" PRIu64 " %s\n", m_MatchCount, unit);
+    }
+
+private:
+    bool IsRowInRange(uint64_t row) const
+    {
+        return m_Option.GetRowBegin() <= row && row < m_Option.GetRowEnd();
+    }
+
+    bool IsBlockInRowRange(const trace::ColumnStoreBlockEntry& block) const
+    {
+        return m_Option.GetRowBegin() < block.firstRow + block.cycleCount && block.firstRow < m_Option.GetRowEnd();
+    }
+
+    void GetMemoryEventRowRange(uint64_t* pOutBegin, uint64_t* pOutEnd) const
+    {
+        const auto rowEnd = std::min(m_Option.GetRowEnd(), m_Reader.GetRowCount());
+
+        if (m_Option.GetRowBegin() >= rowEnd)
+        {
+            *pOutBegin = 0;
+            *pOutEnd = 0;
+            return;
+        }
+
+        const auto& firstBlock = m_Reader.GetBlock(m_Reader.FindBlock(m_Option.GetRowBegin()));
+        const auto& lastBlock = m_Reader.GetBlock(m_Reader.FindBlock(rowEnd - 1));
+
+        *pOutBegin = firstBlock.firstMemoryEventRow;
+        *pOutEnd = lastBlock.firstMemoryEventRow + lastBlock.memoryEventCount;
+    }
+
+    void PrintCycle(uint64_t row, const trace::CycleBatch& batch, size_t index)
+    {
+        m_MatchCount++;
+
+        if (m_Option.IsCountOnly())
+        {
+            return;
+        }
+
+        printf("%" PRIu64 " %016" PRIx64, row, batch.pc[index]);
+
+        if (batch.flags[index] & trace::CycleBatchFlag_Op)
+        {
+            printf(" %08" PRIx32 " %s", batch.insn[index], GetString(batch.priv[index]));
+        }
+        if (batch.flags[index] & trace::CycleBatchFlag_Trap)
+        {
+            printf(" TRAP");
+        }
+
+        printf("\n");
+    }
+
+    void ProcessMemoryEvent(const trace::ColumnStoreBlockEntry& block, const trace::CycleBatch& batch, size_t index)
+    {
+        const auto cycleIndex = batch.memCycleIndex[index];
+        const auto row = block.firstRow + cycleIndex;
+        const auto accessBit = 1u << static_cast<uint32_t>(batch.memAccessType[index]);
+
+        if (!IsRowInRange(row) || (m_Option.GetAccessMask() & accessBit) == 0)
+        {
+            return;
+        }
+
+        m_MatchCount++;
+
+        if (m_Option.IsCountOnly())
+        {
+            return;
+        }
+
+        printf("%" PRIu64 " %016" PRIx64 " MA %s %" PRIx32 " %" PRIx64 " %" PRIx64 " %" PRIx64 "\n",
+            row, batch.pc[cycleIndex], GetString(batch.memAccessType[index]),
+            batch.memSize[index], batch.memValue[index], batch.memVaddr[index], batch.memPaddr[index]);
+    }
+
+    const CommandLineOption& m_Option;
+    const trace::ColumnStoreReader& m_Reader;
+
+    BlockCache m_CycleCache;
+    BlockCache m_MemoryCache;
+
+    uint64_t m_MatchCount{ 0 };
+};
+
+void Build(const CommandLineOption& option)
+{
+    auto reader = trace::MakeTraceReader(option.GetInputPath());
+
+    trace::ColumnStoreWriter writer(option.GetStorePath().c_str(), option.GetBlockCycleCount());
+    trace::CycleBatch batch;
+
+    uint64_t count = 0;
+
+    while (!reader->IsEnd())
+    {
+        batch.Clear();
+        count += reader->ReadBatch(&batch, BatchSize);
+
+        writer.Write(batch);
+    }
+
+    writer.Close();
+
+    std::cout << "Converted " << count << " cycles into " << option.GetStorePath() << "." << std::endl;
+}
+
+void Query(const CommandLineOption& option)
+{
+    trace::ColumnStoreReader reader(option.GetStorePath().c_str());
+    QueryRunner runner(option, reader);
+
+    switch (option.GetQueryType())
+    {
+    case QueryType::Pc:
+        runner.QueryPc();
+        break;
+    case QueryType::Page:
+        runner.QueryPage();
+        break;
+    case QueryType::PcRange:
+        runner.QueryPcRange();
+        break;
+    case QueryType::PaddrRange:
+        runner.QueryPaddrRange();
+        break;
+    case QueryType::Summary:
+        runner.PrintSummary();
+        return;
+    default:
+        RAFI_NOT_IMPLEMENTED;
+    }
+
+    if (option.IsCountOnly())
+    {
+        const auto isMemoryQuery = option.GetQueryType() == QueryType::Page || option.GetQueryType() == QueryType::PaddrRange;
+        runner.PrintCount(isMemoryQuery ? "memory events" : "cycles");
+    }
+}
+
+}}
+
+int main(int argc, char** argv)
+{
+    rafi::query::CommandLineOption option(argc, argv);
+
+    try
+    {
+        if (option.GetQueryType() == rafi::query::QueryType::Build)
+        {
+            rafi::query::Build(option);
+        }
+        else
+        {
+            rafi::query::Query(option);
+        }
+    }
+    catch (const rafi::trace::TraceException& e)
+    {
+        e.PrintMessage();
+        std::exit(1);
+    }
+    catch (const rafi::FileOpenFailureException& e)
+    {
+        e.PrintMessage();
+        std::exit(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+
+#include <rafi/trace.h>
+
+#include "CycleSynthesizer.h"
+
+namespace rafi { namespace tracebench {
+
+namespace {
+
+// Mix of loads, stores, ALU ops, branches and compressed ops.
+// Printers decode ops, so ops must be valid for the XLEN of the trace.
+const uint32_t Rv32Insns[] = {
+    0x0007a703, // lw a4, 0(a5)
+    0x0084a783, // lw a5, 8(s1)
+    0x00112e23, // sw ra, 28(sp)
+    0x00e4a623, // sw a4, 12(s1)
+    0x00150513, // addi a0, a0, 1
+    0x00f70733, // add a4, a4, a5
+    0x40b68633, // sub a2, a3, a1
+    0x00379793, // slli a5, a5, 3
+    0x00078863, // beqz a5, 16
+    0xfef710e3, // bne a4, a5, -32
+    0x100000ef, // jal 256
+    0x00008067, // ret
+    0x02d707b3, // mul a5, a4, a3
+    0x6ac5f543, // fmadd.d fa0, fa1, fa2, fa3
+    0x0505,     // c.addi a0, 1
+    0x853e,     // c.mv a0, a5
+};
+
+const uint32_t Rv64Insns[] = {
+    0x00843783, // ld a5, 8(s0)
+    0x0007a703, // lw a4, 0(a5)
+    0x00113c23, // sd ra, 24(sp)
+    0x00e4a623, // sw a4, 12(s1)
+    0x00150513, // addi a0, a0, 1
+    0x00f70733, // add a4, a4, a5
+    0x40b68633, // sub a2, a3, a1
+    0x00379793, // slli a5, a5, 3
+    0x00078863, // beqz a5, 16
+    0xfef710e3, // bne a4, a5, -32
+    0x100000ef, // jal 256
+    0x00008067, // ret
+    0x02d707b3, // mul a5, a4, a3
+    0x6ac5f543, // fmadd.d fa0, fa1, fa2, fa3
+    0x0505,     // c.addi a0, 1
+    0x853e,     // c.mv a0, a5
+};
+
+static_assert(sizeof(Rv32Insns) == sizeof(Rv64Insns));
+
+const int InsnCount = sizeof(Rv64Insns) / sizeof(Rv64Insns[0]);
+
+}
+
+CycleSynthesizer::CycleSynthesizer(XLEN xlen)
+    : m_XLEN(xlen)
+{
+    std::memset(&m_IntReg, 0, sizeof(m_IntReg));
+    std::memset(&m_FpReg, 0, sizeof(m_FpReg));
+}
+
+size_t CycleSynthesizer::WriteNext(trace::ITraceWriter* pWriter)
+{
+    m_Builder.Reset(m_Cycle, m_XLEN, m_Pc);
+
+    // A few registers are updated in each cycle, as in real programs.
+    m_IntReg.regs[1 + NextRandom() % (IntRegCount - 1)] = (static_cast<uint64_t>(NextRandom()) << 32) | NextRandom();
+    if (m_Cycle % 4 == 0)
+    {
+        m_FpReg.regs[NextRandom() % FpRegCount].u64.value = (static_cast<uint64_t>(NextRandom()) << 32) | NextRandom();
+    }
+
+    if (m_XLEN == XLEN::XLEN32)
+    {
+        trace::NodeIntReg32 node;
+        for (int i = 0; i < IntRegCount; i++)
+        {
+            node.regs[i] = static_cast<uint32_t>(m_IntReg.regs[i]);
+        }
+        m_Builder.Add(node);
+    }
+    else
+    {
+        m_Builder.Add(m_IntReg);
+    }
+
+    m_Builder.Add(m_FpReg);
+    m_Builder.Add(trace::NodeIo { 0, 0 });
+
+    const auto index = NextRandom() % InsnCount;
+    const auto insn = m_XLEN == XLEN::XLEN32 ? Rv32Insns[index] : Rv64Insns[index];
+    m_Builder.Add(trace::OpEvent { insn, m_Priv });
+
+    const auto random = NextRandom() % 100;
+    if (random < 20)
+    {
+        const uint64_t address = 0x80100000 + (NextRandom() % 0x10000) * 8;
+        m_Builder.Add(trace::MemoryEvent { MemoryAccessType::Load, 8, m_IntReg.regs[random % IntRegCount], address, address });
+    }
+    else if (random < 33)
+    {
+        const uint64_t address = 0x80100000 + (NextRandom() % 0x10000) * 8;
+        m_Builder.Add(trace::MemoryEvent { MemoryAccessType::Store, 8, m_IntReg.regs[random % IntRegCount], address, address });
+    }
+
+    if (m_Cycle % TrapInterval == TrapInterval - 1)
+    {
+        // Alternate between trap entry (ecall from user) and return (sret).
+        if (m_Priv == PrivilegeLevel::User)
+        {
+            m_Builder.Add(trace::TrapEvent { TrapType::Exception, PrivilegeLevel::User, PrivilegeLevel::Supervisor, static_cast<uint32_t>(ExceptionType::EnvironmentCallFromUser), 0 });
+            m_Priv = PrivilegeLevel::Supervisor;
+        }
+        else
+        {
+            m_Builder.Add(trace::TrapEvent { TrapType::Return, PrivilegeLevel::Supervisor, PrivilegeLevel::User, 0, 0 });
+            m_Priv = PrivilegeLevel::User;
+        }
+    }
+
+    m_Builder.Break();
+
+    const auto size = m_Builder.GetDataSize();
+    pWriter->Write(m_Builder.GetData(), size);
+
+    m_Pc = (insn & 0x7f) == 0x6f ? m_Pc + 256 : m_Pc + ((insn & 0b11) == 0b11 ? 4 : 2);
+    if (m_XLEN == XLEN::XLEN32)
+    {
+        m_Pc &= 0xffffffff;
+    }
+    m_Cycle++;
+
+    return size;
+}
+
+uint32_t CycleSynthesizer::NextRandom()
+{
+    m_Seed = m_Seed * 1103515245 + 12345;
+    return m_Seed >> 8;
+}
+
+}}
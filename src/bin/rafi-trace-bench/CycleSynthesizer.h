@@ -0,0 +1,54 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <rafi/trace.h>
+
+namespace rafi { namespace tracebench {
+
+// Generates cycles similar to what rafi-emu records with --enable-dump-fp-reg and host io enabled:
+// int / fp registers and io state on every cycle, an op event on almost every cycle,
+// memory events on about a third of cycles and a trap now and then.
+// Output is deterministic for the same xlen.
+class CycleSynthesizer
+{
+public:
+    explicit CycleSynthesizer(XLEN xlen);
+
+    // Builds next cycle and writes it to pWriter. Returns size of the cycle in bytes.
+    size_t WriteNext(trace::ITraceWriter* pWriter);
+
+private:
+    static const int TrapInterval = 997;
+
+    uint32_t NextRandom();
+
+    XLEN m_XLEN;
+
+    trace::BinaryCycleBuilder m_Builder;
+    trace::NodeIntReg64 m_IntReg;
+    trace::NodeFpReg m_FpReg;
+
+    uint32_t m_Cycle {0};
+    uint64_t m_Pc {0x80000000};
+    uint32_t m_Seed {1};
+    PrivilegeLevel m_Priv {PrivilegeLevel::Supervisor};
+};
+
+}}
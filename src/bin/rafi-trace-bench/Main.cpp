@@ -0,0 +1,470 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+
+#if defined(WIN32)
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <boost/program_options.hpp>
+
+#include <rafi/trace.h>
+
+#include "CycleSynthesizer.h"
+
+namespace po = boost::program_options;
+
+namespace rafi { namespace tracebench {
+
+namespace {
+
+#if defined(WIN32)
+int DuplicateFd(int fd) { return _dup(fd); }
+int DuplicateFd2(int fd, int fd2) { return _dup2(fd, fd2); }
+int OpenForWrite(const char* path) { return _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE); }
+int CloseFd(int fd) { return _close(fd); }
+int GetStdoutFd() { return _fileno(stdout); }
+#else
+int DuplicateFd(int fd) { return dup(fd); }
+int DuplicateFd2(int fd, int fd2) { return dup2(fd, fd2); }
+int OpenForWrite(const char* path) { return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644); }
+int CloseFd(int fd) { return close(fd); }
+int GetStdoutFd() { return fileno(stdout); }
+#endif
+
+const int DefaultCycleCount = 200 * 1000;
+const int DefaultPrintCycleCount = 20 * 1000;
+const int DefaultSeekCount = 20;
+
+// Printers write to stdout, so stdout is redirected to a file while they are measured.
+class ScopedStdoutRedirect
+{
+public:
+    explicit ScopedStdoutRedirect(const std::string& path)
+    {
+        std::fflush(stdout);
+
+        const auto fd = OpenForWrite(path.c_str());
+        if (fd < 0)
+        {
+            throw FileOpenFailureException(path.c_str());
+        }
+
+        m_SavedFd = DuplicateFd(GetStdoutFd());
+        DuplicateFd2(fd, GetStdoutFd());
+        CloseFd(fd);
+    }
+
+    ~ScopedStdoutRedirect()
+    {
+        std::fflush(stdout);
+
+        DuplicateFd2(m_SavedFd, GetStdoutFd());
+        CloseFd(m_SavedFd);
+    }
+
+private:
+    int m_SavedFd;
+};
+
+struct Config
+{
+    std::string workDirPath;
+    int cycleCount;
+    int printCycleCount;
+    int seekCount;
+    bool keepFiles;
+};
+
+struct Result
+{
+    std::string name;
+    uint64_t cycles;
+    uint64_t bytes;
+    double seconds;
+};
+
+struct SeekResult
+{
+    std::string name;
+    uint64_t seeks;
+    double meanUs;
+    double maxUs;
+};
+
+double GetSeconds(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / 1e9;
+}
+
+uint64_t GetFileSize(const std::string& path)
+{
+    std::ifstream f(path, std::ios::in | std::ios::binary | std::ios::ate);
+    return f.is_open() ? static_cast<uint64_t>(f.tellg()) : 0;
+}
+
+const char* GetXLENName(XLEN xlen)
+{
+    return xlen == XLEN::XLEN32 ? "rv32" : "rv64";
+}
+
+const char* GetPrinterName(trace::PrinterType printerType)
+{
+    switch (printerType)
+    {
+    case trace::PrinterType::Short:
+        return "short";
+    case trace::PrinterType::Json:
+        return "json";
+    case trace::PrinterType::Text:
+        return "text";
+    default:
+        RAFI_NOT_IMPLEMENTED;
+    }
+}
+
+// Synthesizes the trace and writes it with TraceIndexWriter. Time includes building cycles and flushing files.
+Result MeasureWrite(const std::string& pathBase, XLEN xlen, const Config& config)
+{
+    Result result { std::string("write/") + GetXLENName(xlen), 0, 0, 0.0 };
+
+    const auto begin = std::chrono::steady_clock::now();
+    {
+        CycleSynthesizer synthesizer(xlen);
+        trace::TraceIndexWriter writer(pathBase.c_str());
+
+        for (int i = 0; i < config.cycleCount; i++)
+        {
+            result.bytes += synthesizer.WriteNext(&writer);
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    result.cycles = config.cycleCount;
+    result.seconds = GetSeconds(begin, end);
+
+    return result;
+}
+
+// Reads all cycles and touches every node so that the whole cycle is parsed.
+Result MeasureRead(const std::string& pathBase, XLEN xlen, uint64_t bytes, uint64_t* pOutChecksum)
+{
+    Result result { std::string("read/") + GetXLENName(xlen), 0, bytes, 0.0 };
+
+    uint64_t checksum = 0;
+
+    const auto begin = std::chrono::steady_clock::now();
+    {
+        trace::TraceIndexReader reader((pathBase + ".tidx").c_str());
+
+        while (!reader.IsEnd())
+        {
+            const auto pCycle = reader.GetCycle();
+
+            checksum += pCycle->GetPc() + pCycle->GetIntReg(10) + pCycle->GetFpReg(10);
+            checksum += pCycle->GetOpEventCount() + pCycle->GetMemoryEventCount() + pCycle->GetTrapEventCount();
+
+            reader.Next();
+            result.cycles++;
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    result.seconds = GetSeconds(begin, end);
+    *pOutChecksum += checksum;
+
+    return result;
+}
+
+// Seeks from the beginning of the trace to targets spread over the trace. Opening the reader is not measured.
+SeekResult MeasureSeek(const std::string& pathBase, XLEN xlen, const Config& config, uint64_t* pOutChecksum)
+{
+    SeekResult result { std::string("seek/") + GetXLENName(xlen), 0, 0.0, 0.0 };
+
+    double totalUs = 0.0;
+
+    for (int i = 0; i < config.seekCount; i++)
+    {
+        // Targets are evenly spaced with a fixed offset so that runs are comparable.
+        const auto target = static_cast<uint32_t>((static_cast<uint64_t>(config.cycleCount - 1) * (i + 1)) / config.seekCount);
+
+        trace::TraceIndexReader reader((pathBase + ".tidx").c_str());
+
+        const auto begin = std::chrono::steady_clock::now();
+        reader.Next(target);
+        const auto end = std::chrono::steady_clock::now();
+
+        *pOutChecksum += reader.GetCycle()->GetCycle();
+
+        const auto us = GetSeconds(begin, end) * 1e6;
+        totalUs += us;
+        result.maxUs = std::max(result.maxUs, us);
+        result.seeks++;
+    }
+
+    result.meanUs = result.seeks == 0 ? 0.0 : totalUs / result.seeks;
+
+    return result;
+}
+
+Result MeasurePrint(const std::string& pathBase, XLEN xlen, trace::PrinterType printerType, const Config& config)
+{
+    Result result { std::string("print-") + GetPrinterName(printerType) + "/" + GetXLENName(xlen), 0, 0, 0.0 };
+
+    const auto outputPath = pathBase + "." + GetPrinterName(printerType) + ".txt";
+
+    trace::TraceIndexReader reader((pathBase + ".tidx").c_str());
+
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::time_point end;
+    {
+        ScopedStdoutRedirect redirect(outputPath);
+
+        begin = std::chrono::steady_clock::now();
+        {
+            auto printer = trace::MakeTracePrinter(printerType, xlen);
+
+            for (int i = 0; i < config.printCycleCount && !reader.IsEnd(); i++)
+            {
+                printer->Print(reader.GetCycle());
+                reader.Next();
+                result.cycles++;
+            }
+        }
+        std::fflush(stdout);
+        end = std::chrono::steady_clock::now();
+    }
+
+    result.seconds = GetSeconds(begin, end);
+    result.bytes = GetFileSize(outputPath);
+
+    if (!config.keepFiles)
+    {
+        std::remove(outputPath.c_str());
+    }
+
+    return result;
+}
+
+void RemoveTrace(const std::string& pathBase)
+{
+    const auto indexPath = pathBase + ".tidx";
+
+    try
+    {
+        for (const auto& entry : trace::ReadTraceIndexFile(indexPath.c_str()))
+        {
+            std::remove(entry.path.c_str());
+        }
+    }
+    catch (const FileOpenFailureException&)
+    {
+        // Nothing to remove.
+    }
+
+    std::remove(indexPath.c_str());
+}
+
+double GetRate(uint64_t value, double seconds)
+{
+    return seconds <= 0.0 ? 0.0 : value / seconds;
+}
+
+void PrintSummary(const std::vector<Result>& results, const std::vector<SeekResult>& seekResults)
+{
+    std::printf("%-20s %12s %12s %14s %10s\n", "Benchmark", "Cycles", "MB", "Cycles/s", "MB/s");
+
+    for (const auto& result: results)
+    {
+        std::printf("%-20s %12" PRIu64 " %12.1f %14.0f %10.1f\n",
+            result.name.c_str(),
+            result.cycles,
+            result.bytes / 1e6,
+            GetRate(result.cycles, result.seconds),
+            GetRate(result.bytes, result.seconds) / 1e6);
+    }
+
+    std::printf("\n%-20s %12s %12s %12s\n", "Benchmark", "Seeks", "Mean(us)", "Max(us)");
+
+    for (const auto& result: seekResults)
+    {
+        std::printf("%-20s %12" PRIu64 " %12.1f %12.1f\n", result.name.c_str(), result.seeks, result.meanUs, result.maxUs);
+    }
+}
+
+void WriteJsonReport(const std::string& path, const Config& config, const std::vector<Result>& results, const std::vector<SeekResult>& seekResults, uint64_t checksum)
+{
+    auto fp = std::fopen(path.c_str(), "w");
+    if (fp == nullptr)
+    {
+        throw FileOpenFailureException(path.c_str());
+    }
+
+    std::fprintf(fp, "{\n");
+    std::fprintf(fp, "  \"cycles\": %d,\n", config.cycleCount);
+    std::fprintf(fp, "  \"print_cycles\": %d,\n", config.printCycleCount);
+    std::fprintf(fp, "  \"checksum\": %" PRIu64 ",\n", checksum);
+    std::fprintf(fp, "  \"throughput\": [");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto& result = results[i];
+
+        std::fprintf(fp, "%s\n    {\"name\": \"%s\", \"cycles\": %" PRIu64 ", \"bytes\": %" PRIu64 ", \"seconds\": %.6f, \"cycles_per_second\": %.1f, \"mb_per_second\": %.3f}",
+            i == 0 ? "" : ",",
+            result.name.c_str(),
+            result.cycles,
+            result.bytes,
+            result.seconds,
+            GetRate(result.cycles, result.seconds),
+            GetRate(result.bytes, result.seconds) / 1e6);
+    }
+
+    std::fprintf(fp, "\n  ],\n");
+    std::fprintf(fp, "  \"seek\": [");
+
+    for (size_t i = 0; i < seekResults.size(); i++)
+    {
+        const auto& result = seekResults[i];
+
+        std::fprintf(fp, "%s\n    {\"name\": \"%s\", \"seeks\": %" PRIu64 ", \"mean_us\": %.3f, \"max_us\": %.3f}",
+            i == 0 ? "" : ",",
+            result.name.c_str(),
+            result.seeks,
+            result.meanUs,
+            result.maxUs);
+    }
+
+    std::fprintf(fp, "\n  ]\n");
+    std::fprintf(fp, "}\n");
+
+    std::fclose(fp);
+}
+
+}
+
+}}
+
+int main(int argc, char** argv)
+{
+    rafi::tracebench::Config config;
+
+    po::options_description desc("options");
+    desc.add_options()
+        ("cycle", po::value<int>(&config.cycleCount)->default_value(rafi::tracebench::DefaultCycleCount), "number of synthesized cycles for each XLEN")
+        ("help", "show help")
+        ("keep-files", "do not remove generated trace and printer output files")
+        ("output", po::value<std::string>(), "path of JSON report")
+        ("print-cycle", po::value<int>(&config.printCycleCount)->default_value(rafi::tracebench::DefaultPrintCycleCount), "number of cycles printed by each printer")
+        ("seek", po::value<int>(&config.seekCount)->default_value(rafi::tracebench::DefaultSeekCount), "number of seeks for each XLEN")
+        ("work-dir", po::value<std::string>(&config.workDirPath)->default_value("."), "directory for generated files");
+
+    po::variables_map variables;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), variables);
+        po::notify(variables);
+    }
+    catch (const po::error& e)
+    {
+        std::cout << e.what() << std::endl;
+        std::exit(1);
+    }
+
+    if (variables.count("help"))
+    {
+        std::cout << desc << std::endl;
+        std::exit(0);
+    }
+
+    if (config.cycleCount <= 0 || config.printCycleCount < 0 || config.seekCount < 0)
+    {
+        std::cout << "--cycle must be positive, and --print-cycle and --seek must not be negative." << std::endl;
+        std::exit(1);
+    }
+
+    config.keepFiles = variables.count("keep-files") > 0;
+
+    std::vector<rafi::tracebench::Result> results;
+    std::vector<rafi::tracebench::SeekResult> seekResults;
+    uint64_t checksum = 0;
+
+    try
+    {
+        for (const auto xlen: { rafi::XLEN::XLEN32, rafi::XLEN::XLEN64 })
+        {
+            // rafi-dump determines XLEN from "rv32" or "rv64" in the path.
+            const auto pathBase = config.workDirPath + "/rafi-trace-bench-" + rafi::tracebench::GetXLENName(xlen);
+
+            const auto writeResult = rafi::tracebench::MeasureWrite(pathBase, xlen, config);
+            results.push_back(writeResult);
+            results.push_back(rafi::tracebench::MeasureRead(pathBase, xlen, writeResult.bytes, &checksum));
+            seekResults.push_back(rafi::tracebench::MeasureSeek(pathBase, xlen, config, &checksum));
+
+            for (const auto printerType: { rafi::trace::PrinterType::Text, rafi::trace::PrinterType::Json, rafi::trace::PrinterType::Short })
+            {
+                results.push_back(rafi::tracebench::MeasurePrint(pathBase, xlen, printerType, config));
+            }
+
+            if (!config.keepFiles)
+            {
+                rafi::tracebench::RemoveTrace(pathBase);
+            }
+        }
+    }
+    catch (const rafi::FileOpenFailureException& e)
+    {
+        e.PrintMessage();
+        std::exit(1);
+    }
+    catch (const rafi::trace::TraceException& e)
+    {
+        e.PrintMessage();
+        std::exit(1);
+    }
+
+    rafi::tracebench::PrintSummary(results, seekResults);
+
+    if (variables.count("output"))
+    {
+        try
+        {
+            rafi::tracebench::WriteJsonReport(variables["output"].as<std::string>(), config, results, seekResults, checksum);
+        }
+        catch (const rafi::FileOpenFailureException& e)
+        {
+            e.PrintMessage();
+            std::exit(1);
+        }
+    }
+
+    return 0;
+}
@@ -56,6 +56,8 @@ class BusImpl
 public:
     void Read(void* pOutBuffer, size_t size, paddr_t address)
     {
+        RAFI_EMU_SELF_PROFILE_SCOPE(Bus);
+
         if (IsMemoryAddress(address, size))
         {
             const auto location = ConvertToMemoryLocation(address);
@@ -74,6 +76,8 @@ public:
 
     void Write(const void* pBuffer, size_t size, paddr_t address)
     {
+        RAFI_EMU_SELF_PROFILE_SCOPE(Bus);
+
         if (IsMemoryAddress(address, sizeof(int8_t)))
         {
             const auto location = ConvertToMemoryLocation(address);
@@ -14,10 +14,12 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <vector>
 
 #include <rafi/common.h>
 #include <rafi/emu.h>
@@ -62,6 +64,9 @@ public:
             RAFI_EMU_ERROR("Failed to open file: %s\n", path);
         }
         f.read(&m_pBody[offset], m_Capacity - offset);
+
+        MarkDirty(offset, static_cast<size_t>(f.gcount()));
+
         f.close();
     }
 
@@ -77,11 +82,64 @@ public:
         assert(0 <= address && address + size <= GetCapacity());
 
         std::memcpy(&m_pBody[address], pBuffer, size);
+
+        MarkDirty(address, size);
+    }
+
+    void EnableDirtyPageTracking()
+    {
+        m_DirtyPageFlags.assign((m_Capacity + Ram::DirtyPageSize - 1) / Ram::DirtyPageSize, false);
+    }
+
+    void GetDirtyPages(std::vector<uint64_t>* pOut) const
+    {
+        pOut->clear();
+
+        for (const auto page: m_DirtyPages)
+        {
+            pOut->push_back(static_cast<uint64_t>(page) * Ram::DirtyPageSize);
+        }
+
+        std::sort(pOut->begin(), pOut->end());
+    }
+
+    void ClearDirtyPages()
+    {
+        for (const auto page: m_DirtyPages)
+        {
+            m_DirtyPageFlags[page] = false;
+        }
+
+        m_DirtyPages.clear();
     }
 
 private:
+    void MarkDirty(uint64_t address, size_t size)
+    {
+        // Tracking is disabled unless EnableDirtyPageTracking() is called.
+        if (m_DirtyPageFlags.empty() || size == 0)
+        {
+            return;
+        }
+
+        const auto first = static_cast<size_t>(address / Ram::DirtyPageSize);
+        const auto last = static_cast<size_t>((address + size - 1) / Ram::DirtyPageSize);
+
+        for (auto page = first; page <= last; page++)
+        {
+            if (!m_DirtyPageFlags[page])
+            {
+                m_DirtyPageFlags[page] = true;
+                m_DirtyPages.push_back(page);
+            }
+        }
+    }
+
     size_t m_Capacity;
 	char* m_pBody;
+
+    std::vector<bool> m_DirtyPageFlags;
+    std::vector<size_t> m_DirtyPages;
 };
 
 Ram::Ram(size_t capacity)
@@ -109,6 +167,21 @@ void Ram::Copy(void* pOut, size_t size) const
     m_pImpl->Copy(pOut, size);
 }
 
+void Ram::EnableDirtyPageTracking()
+{
+    m_pImpl->EnableDirtyPageTracking();
+}
+
+void Ram::GetDirtyPages(std::vector<uint64_t>* pOut) const
+{
+    m_pImpl->GetDirtyPages(pOut);
+}
+
+void Ram::ClearDirtyPages()
+{
+    m_pImpl->ClearDirtyPages();
+}
+
 void Ram::Read(void* pOutBuffer, size_t size, uint64_t address) const
 {
     m_pImpl->Read(pOutBuffer, size, address);
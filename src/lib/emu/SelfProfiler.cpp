@@ -0,0 +1,142 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(RAFI_EMU_SELF_PROFILE)
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <vector>
+
+#include <rafi/emu.h>
+
+namespace rafi { namespace emu {
+
+namespace {
+
+static_assert(static_cast<int>(OpCode::c_sdsp) < SelfProfileOpCodeCount);
+
+const char* SelfProfileCategoryNames[SelfProfileCategoryCount] =
+{
+    "Fetch",
+    "Decode",
+    "Translate",
+    "Bus",
+    "Device",
+    "Logger",
+};
+
+// Used to convert timestamp counter ticks to nanoseconds.
+struct SelfProfileClock
+{
+    SelfProfileClock()
+        : timestamp(ReadSelfProfileTimestamp())
+        , time(std::chrono::steady_clock::now())
+    {
+    }
+
+    uint64_t timestamp;
+    std::chrono::steady_clock::time_point time;
+};
+
+SelfProfileClock g_StartClock;
+
+void PrintLine(const char* name, const SelfProfileCounter& counter, double nsPerTick, uint64_t instructionCount, uint64_t totalTicks)
+{
+    const auto ns = counter.ticks * nsPerTick;
+
+    std::printf("  %-16s %10.2f %7.2f%% %14" PRIu64 " %10.2f\n",
+        name,
+        instructionCount == 0 ? 0.0 : ns / instructionCount,
+        totalTicks == 0 ? 0.0 : 100.0 * counter.ticks / totalTicks,
+        counter.count,
+        counter.count == 0 ? 0.0 : ns / counter.count);
+}
+
+}
+
+SelfProfileCounter g_SelfProfileCategoryCounters[SelfProfileCategoryCount];
+SelfProfileCounter g_SelfProfileOpCodeCounters[SelfProfileOpCodeCount];
+
+ScopedSelfProfileTimer* ScopedSelfProfileTimer::s_pCurrent = nullptr;
+
+SelfProfileCounter* GetSelfProfileCounter(OpCode opCode)
+{
+    return &g_SelfProfileOpCodeCounters[static_cast<int>(opCode)];
+}
+
+void BeginSelfProfile()
+{
+    g_StartClock = SelfProfileClock();
+}
+
+void PrintSelfProfile(uint64_t instructionCount)
+{
+    const SelfProfileClock endClock;
+
+    const auto totalTicks = endClock.timestamp - g_StartClock.timestamp;
+    const auto totalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(endClock.time - g_StartClock.time).count();
+    const double nsPerTick = totalTicks == 0 ? 0.0 : static_cast<double>(totalNs) / totalTicks;
+
+    SelfProfileCounter execute = { 0, 0 };
+    for (const auto& counter: g_SelfProfileOpCodeCounters)
+    {
+        execute.ticks += counter.ticks;
+        execute.count += counter.count;
+    }
+
+    SelfProfileCounter other = { totalTicks - execute.ticks, 0 };
+    for (const auto& counter: g_SelfProfileCategoryCounters)
+    {
+        other.ticks -= std::min(other.ticks, counter.ticks);
+    }
+
+    std::printf("Self profile: %" PRIu64 " instructions, %.3f sec\n", instructionCount, totalNs / 1e9);
+    std::printf("  %-16s %10s %8s %14s %10s\n", "Category", "ns/insn", "Percent", "Count", "ns/count");
+
+    for (int i = 0; i < SelfProfileCategoryCount; i++)
+    {
+        PrintLine(SelfProfileCategoryNames[i], g_SelfProfileCategoryCounters[i], nsPerTick, instructionCount, totalTicks);
+    }
+    PrintLine("Execute", execute, nsPerTick, instructionCount, totalTicks);
+    PrintLine("Other", other, nsPerTick, instructionCount, totalTicks);
+
+    std::vector<int> opCodes;
+    for (int i = 0; i < SelfProfileOpCodeCount; i++)
+    {
+        if (g_SelfProfileOpCodeCounters[i].count > 0)
+        {
+            opCodes.push_back(i);
+        }
+    }
+
+    std::sort(opCodes.begin(), opCodes.end(), [](int lhs, int rhs)
+    {
+        return g_SelfProfileOpCodeCounters[lhs].ticks > g_SelfProfileOpCodeCounters[rhs].ticks;
+    });
+
+    std::printf("  %-16s %10s %8s %14s %10s\n", "Execute OpCode", "ns/insn", "Percent", "Count", "ns/count");
+
+    for (const auto i: opCodes)
+    {
+        PrintLine(GetString(static_cast<OpCode>(i)), g_SelfProfileOpCodeCounters[i], nsPerTick, instructionCount, totalTicks);
+    }
+}
+
+}}
+
+#endif
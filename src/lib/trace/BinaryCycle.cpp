@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstring>
 #include <rafi/trace.h>
 
@@ -21,19 +22,237 @@
 
 namespace rafi { namespace trace {
 
-std::unique_ptr<BinaryCycle> BinaryCycle::Parse(const void* buffer, size_t bufferSize)
+void BinaryCycle::Parse(const void* buffer, size_t bufferSize, const BinaryCycle* pPrevious)
 {
-    auto p = std::make_unique<BinaryCycle>();
+    if (pPrevious == this)
+    {
+        throw TraceException("argument 'pPrevious' must not be the cycle to be parsed.");
+    }
+
+    m_pBuffer = buffer;
+    m_BufferSize = bufferSize;
+    m_Size = 0;
+
+    m_pNodeBasic = nullptr;
+    m_pNodeIntReg32 = nullptr;
+    m_pNodeIntReg64 = nullptr;
+    m_pNodeFpReg = nullptr;
+    m_pNodeIo = nullptr;
+
+    m_pPrevious = pPrevious;
+    m_IntRegDelta = false;
+    m_FpRegDelta = false;
 
-    p->m_pBuffer = buffer;
-    p->m_BufferSize = bufferSize;
+    m_OpEvents.Clear();
+    m_MemoryEvents.Clear();
+    m_TrapEvents.Clear();
 
-    while (!p->m_Break)
+    m_Break = false;
+
+    while (!m_Break)
     {
-        p->m_Size += p->ParseNode(reinterpret_cast<const uint8_t*>(buffer) + p->m_Size, bufferSize - p->m_Size);
+        m_Size += ParseNode(reinterpret_cast<const uint8_t*>(buffer) + m_Size, bufferSize - m_Size);
     }
 
-    return p;
+    // Previous cycle may be overwritten after parsing.
+    m_pPrevious = nullptr;
+}
+
+size_t BinaryCycle::Scan(const void* buffer, size_t bufferSize, bool* pOutHasDelta)
+{
+    const auto p = reinterpret_cast<const uint8_t*>(buffer);
+
+    size_t offset = 0;
+    *pOutHasDelta = false;
+
+    for (;;)
+    {
+        if (bufferSize - offset < sizeof(NodeHeader))
+        {
+            throw TraceException("Broken data @ BinaryCycle\n");
+        }
+
+        NodeHeader header;
+        std::memcpy(&header, p + offset, sizeof(header));
+
+        const auto size = sizeof(NodeHeader) + header.nodeSize;
+        if (bufferSize - offset < size)
+        {
+            throw TraceException("Broken data @ BinaryCycle\n");
+        }
+
+        offset += size;
+
+        if (header.nodeId == NodeId_ID || header.nodeId == NodeId_FD)
+        {
+            *pOutHasDelta = true;
+        }
+        else if (header.nodeId == NodeId_BR)
+        {
+            return offset;
+        }
+    }
+}
+
+size_t BinaryCycle::AddToBatch(const void* buffer, size_t bufferSize, CycleBatch* pBatch, bool* pOutHasDelta)
+{
+    const auto p = reinterpret_cast<const uint8_t*>(buffer);
+
+    size_t offset = 0;
+    size_t index = 0;
+    bool hasBasic = false;
+    *pOutHasDelta = false;
+
+    for (;;)
+    {
+        if (bufferSize - offset < sizeof(NodeHeader))
+        {
+            throw TraceException("Broken data @ BinaryCycle\n");
+        }
+
+        NodeHeader header;
+        std::memcpy(&header, p + offset, sizeof(header));
+
+        const auto size = sizeof(NodeHeader) + header.nodeSize;
+        if (bufferSize - offset < size)
+        {
+            throw TraceException("Broken data @ BinaryCycle\n");
+        }
+
+        const auto pNode = p + offset + sizeof(NodeHeader);
+        offset += size;
+
+        if (header.nodeId == NodeId_BR)
+        {
+            return offset;
+        }
+        else if (header.nodeId == NodeId_BA)
+        {
+            NodeBasic basic;
+            std::memcpy(&basic, pNode, sizeof(basic));
+
+            index = pBatch->AddCycle(basic.cycle, basic.pc);
+            hasBasic = true;
+            continue;
+        }
+        else if (!hasBasic)
+        {
+            throw TraceException("Detect node before Basic node\n");
+        }
+
+        switch (header.nodeId)
+        {
+        case NodeId_IN:
+            pBatch->SetFlag(index, CycleBatchFlag_IntReg);
+            break;
+        case NodeId_ID:
+            pBatch->SetFlag(index, CycleBatchFlag_IntReg);
+            *pOutHasDelta = true;
+            break;
+        case NodeId_FP:
+            pBatch->SetFlag(index, CycleBatchFlag_FpReg);
+            break;
+        case NodeId_FD:
+            pBatch->SetFlag(index, CycleBatchFlag_FpReg);
+            *pOutHasDelta = true;
+            break;
+        case NodeId_IO:
+        {
+            NodeIo io;
+            std::memcpy(&io, pNode, sizeof(io));
+            pBatch->SetIo(index, io);
+            break;
+        }
+        case NodeId_OP:
+        {
+            OpEvent event;
+            std::memcpy(&event, pNode, sizeof(event));
+            pBatch->SetOp(index, event);
+            break;
+        }
+        case NodeId_TR:
+            pBatch->SetFlag(index, CycleBatchFlag_Trap);
+            break;
+        case NodeId_MA:
+        {
+            MemoryEvent event;
+            std::memcpy(&event, pNode, sizeof(event));
+            pBatch->AddMemoryEvent(index, event);
+            break;
+        }
+        default:
+            throw TraceException("Unknown node id\n");
+        }
+    }
+}
+
+size_t BinaryCycle::AddToSummary(const void* buffer, size_t bufferSize, TraceFileSummary* pSummary)
+{
+    const auto p = reinterpret_cast<const uint8_t*>(buffer);
+
+    size_t offset = 0;
+
+    for (;;)
+    {
+        if (bufferSize - offset < sizeof(NodeHeader))
+        {
+            throw TraceException("Broken data @ BinaryCycle\n");
+        }
+
+        NodeHeader header;
+        std::memcpy(&header, p + offset, sizeof(header));
+
+        const auto size = sizeof(NodeHeader) + header.nodeSize;
+        if (bufferSize - offset < size)
+        {
+            throw TraceException("Broken data @ BinaryCycle\n");
+        }
+
+        const auto pNode = p + offset + sizeof(NodeHeader);
+        offset += size;
+
+        switch (header.nodeId)
+        {
+        case NodeId_BR:
+            return offset;
+        case NodeId_BA:
+        {
+            NodeBasic basic;
+            std::memcpy(&basic, pNode, sizeof(basic));
+
+            pSummary->pcMin = std::min(pSummary->pcMin, basic.pc);
+            pSummary->pcMax = std::max(pSummary->pcMax, basic.pc);
+            break;
+        }
+        case NodeId_IO:
+        {
+            NodeIo io;
+            std::memcpy(&io, pNode, sizeof(io));
+
+            pSummary->hostIo = io.hostIo;
+            pSummary->hasHostIo = true;
+            break;
+        }
+        case NodeId_OP:
+            pSummary->opCount++;
+            break;
+        case NodeId_TR:
+            pSummary->trapCount++;
+            break;
+        case NodeId_MA:
+        {
+            MemoryEvent event;
+            std::memcpy(&event, pNode, sizeof(event));
+
+            pSummary->memoryEventCount++;
+            pSummary->paddrMin = std::min(pSummary->paddrMin, event.paddr);
+            pSummary->paddrMax = std::max(pSummary->paddrMax, event.paddr + std::max<uint64_t>(event.size, 1) - 1);
+            break;
+        }
+        default:
+            break;
+        }
+    }
 }
 
 BinaryCycle::BinaryCycle()
@@ -61,12 +280,12 @@ uint64_t BinaryCycle::GetPc() const
 
 bool BinaryCycle::IsIntRegExist() const
 {
-    return (m_pNodeIntReg32 != nullptr) || (m_pNodeIntReg64 != nullptr);
+    return (m_pNodeIntReg32 != nullptr) || (m_pNodeIntReg64 != nullptr) || m_IntRegDelta;
 }
 
 bool BinaryCycle::IsFpRegExist() const
 {
-    return m_pNodeFpReg;
+    return m_pNodeFpReg || m_FpRegDelta;
 }
 
 bool BinaryCycle::IsIoExist() const
@@ -76,17 +295,17 @@ bool BinaryCycle::IsIoExist() const
 
 size_t BinaryCycle::GetOpEventCount() const
 {
-    return m_OpEvents.size();
+    return m_OpEvents.GetCount();
 }
 
 size_t BinaryCycle::GetMemoryEventCount() const
 {
-    return m_MemoryEvents.size();
+    return m_MemoryEvents.GetCount();
 }
 
 size_t BinaryCycle::GetTrapEventCount() const
 {
-    return m_TrapEvents.size();
+    return m_TrapEvents.GetCount();
 }
 
 uint64_t BinaryCycle::GetIntReg(size_t index) const
@@ -99,6 +318,10 @@ uint64_t BinaryCycle::GetIntReg(size_t index) const
     {
         return m_pNodeIntReg64->regs[index];
     }
+    else if (m_IntRegDelta)
+    {
+        return m_IntRegs[index];
+    }
     else
     {
         RAFI_NOT_IMPLEMENTED;
@@ -107,6 +330,11 @@ uint64_t BinaryCycle::GetIntReg(size_t index) const
 
 uint64_t BinaryCycle::GetFpReg(size_t index) const
 {
+    if (m_FpRegDelta)
+    {
+        return m_FpRegs[index];
+    }
+
     return m_pNodeFpReg->regs[index].u64.value;
 }
 
@@ -117,17 +345,54 @@ void BinaryCycle::CopyIo(NodeIo* pOutState) const
 
 void BinaryCycle::CopyOpEvent(OpEvent* pOutEvent, size_t index) const
 {
-    std::memcpy(pOutEvent, m_OpEvents[index], sizeof(OpEvent));
+    std::memcpy(pOutEvent, GetNodeData(m_OpEvents.Get(index)), sizeof(OpEvent));
 }
 
 void BinaryCycle::CopyMemoryEvent(MemoryEvent* pOutEvent, size_t index) const
 {
-    std::memcpy(pOutEvent, m_MemoryEvents[index], sizeof(MemoryEvent));
+    std::memcpy(pOutEvent, GetNodeData(m_MemoryEvents.Get(index)), sizeof(MemoryEvent));
 }
 
 void BinaryCycle::CopyTrapEvent(TrapEvent* pOutEvent, size_t index) const
 {
-    std::memcpy(pOutEvent, m_TrapEvents[index], sizeof(TrapEvent));
+    std::memcpy(pOutEvent, GetNodeData(m_TrapEvents.Get(index)), sizeof(TrapEvent));
+}
+
+void BinaryCycle::CopyIntRegs(uint64_t* pOutRegs) const
+{
+    if (m_pNodeIntReg32 != nullptr)
+    {
+        for (int i = 0; i < IntRegCount; i++)
+        {
+            pOutRegs[i] = m_pNodeIntReg32->regs[i];
+        }
+    }
+    else if (m_pNodeIntReg64 != nullptr)
+    {
+        std::memcpy(pOutRegs, m_pNodeIntReg64->regs, sizeof(m_pNodeIntReg64->regs));
+    }
+    else if (m_IntRegDelta)
+    {
+        std::memcpy(pOutRegs, m_IntRegs, sizeof(m_IntRegs));
+    }
+    else
+    {
+        RAFI_NOT_IMPLEMENTED;
+    }
+}
+
+void BinaryCycle::CopyFpRegs(uint64_t* pOutRegs) const
+{
+    static_assert(sizeof(NodeFpReg) == sizeof(m_FpRegs), "FpRegUnion must be 64-bit.");
+
+    if (m_FpRegDelta)
+    {
+        std::memcpy(pOutRegs, m_FpRegs, sizeof(m_FpRegs));
+    }
+    else
+    {
+        std::memcpy(pOutRegs, m_pNodeFpReg->regs, sizeof(NodeFpReg));
+    }
 }
 
 size_t BinaryCycle::GetSize() const
@@ -135,6 +400,11 @@ size_t BinaryCycle::GetSize() const
     return m_Size;
 }
 
+const void* BinaryCycle::GetNodeData(uint32_t offset) const
+{
+    return reinterpret_cast<const uint8_t*>(m_pBuffer) + offset;
+}
+
 size_t BinaryCycle::ParseNode(const void* buffer, size_t bufferSize)
 {
     if (bufferSize < sizeof(NodeHeader))
@@ -179,17 +449,37 @@ size_t BinaryCycle::ParseNode(const void* buffer, size_t bufferSize)
             RAFI_NOT_IMPLEMENTED;
         }
         break;
+    case NodeId_ID:
+        if (!m_pNodeBasic)
+        {
+            throw TraceException("Detect IntReg delta node before Basic node\n");
+        }
+        if (m_pPrevious == nullptr || !m_pPrevious->IsIntRegExist())
+        {
+            throw TraceException("Detect IntReg delta node without IntReg of previous cycle\n");
+        }
+        ApplyDelta(m_IntRegs, &pHeader[1], pHeader->nodeSize, m_pNodeBasic->xlen == XLEN::XLEN32 ? sizeof(uint32_t) : sizeof(uint64_t), false);
+        m_IntRegDelta = true;
+        break;
+    case NodeId_FD:
+        if (m_pPrevious == nullptr || !m_pPrevious->IsFpRegExist())
+        {
+            throw TraceException("Detect FpReg delta node without FpReg of previous cycle\n");
+        }
+        ApplyDelta(m_FpRegs, &pHeader[1], pHeader->nodeSize, sizeof(uint64_t), true);
+        m_FpRegDelta = true;
+        break;
     case NodeId_IO:
         m_pNodeIo = reinterpret_cast<const NodeIo*>(&pHeader[1]);
         break;
     case NodeId_MA:
-        m_MemoryEvents.push_back(reinterpret_cast<const MemoryEvent*>(&pHeader[1]));
+        m_MemoryEvents.Add(static_cast<uint32_t>(m_Size + sizeof(NodeHeader)));
         break;
     case NodeId_OP:
-        m_OpEvents.push_back(reinterpret_cast<const OpEvent*>(&pHeader[1]));
+        m_OpEvents.Add(static_cast<uint32_t>(m_Size + sizeof(NodeHeader)));
         break;
     case NodeId_TR:
-        m_TrapEvents.push_back(reinterpret_cast<const TrapEvent*>(&pHeader[1]));
+        m_TrapEvents.Add(static_cast<uint32_t>(m_Size + sizeof(NodeHeader)));
         break;
     default:
         throw TraceException("Unknown node id\n");
@@ -198,4 +488,53 @@ size_t BinaryCycle::ParseNode(const void* buffer, size_t bufferSize)
     return size;
 }
 
+void BinaryCycle::ApplyDelta(uint64_t* pOutRegs, const void* pNode, size_t nodeSize, size_t regSize, bool isFp)
+{
+    const auto regCount = isFp ? FpRegCount : IntRegCount;
+
+    for (int i = 0; i < regCount; i++)
+    {
+        pOutRegs[i] = isFp ? m_pPrevious->GetFpReg(i) : m_pPrevious->GetIntReg(i);
+    }
+
+    NodeRegDelta delta;
+
+    if (nodeSize < sizeof(delta))
+    {
+        throw TraceException("Broken data @ BinaryCycle\n");
+    }
+
+    std::memcpy(&delta, pNode, sizeof(delta));
+
+    auto pValue = reinterpret_cast<const uint8_t*>(pNode) + sizeof(delta);
+    size_t offset = sizeof(delta);
+
+    for (int i = 0; i < regCount; i++)
+    {
+        if ((delta.mask & (1u << i)) == 0)
+        {
+            continue;
+        }
+
+        if (offset + regSize > nodeSize)
+        {
+            throw TraceException("Broken data @ BinaryCycle\n");
+        }
+
+        if (regSize == sizeof(uint32_t))
+        {
+            uint32_t value;
+            std::memcpy(&value, pValue, sizeof(value));
+            pOutRegs[i] = value;
+        }
+        else
+        {
+            std::memcpy(&pOutRegs[i], pValue, sizeof(uint64_t));
+        }
+
+        pValue += regSize;
+        offset += regSize;
+    }
+}
+
 }}
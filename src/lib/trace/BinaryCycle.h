@@ -16,17 +16,76 @@
 
 #pragma once
 
-#include <memory>
+#include <cstdint>
 #include <vector>
 
 #include <rafi/trace.h>
 
 namespace rafi { namespace trace {
 
+// Offsets of event nodes from the beginning of cycle.
+// Most cycles have a few events, so offsets are stored inline and spilled to a vector which is kept across Clear().
+class BinaryCycleEventList final
+{
+public:
+    void Clear()
+    {
+        m_Count = 0;
+        m_ExtraOffsets.clear();
+    }
+
+    void Add(uint32_t offset)
+    {
+        if (m_Count < InlineCount)
+        {
+            m_InlineOffsets[m_Count] = offset;
+        }
+        else
+        {
+            m_ExtraOffsets.push_back(offset);
+        }
+
+        m_Count++;
+    }
+
+    uint32_t Get(size_t index) const
+    {
+        return index < InlineCount ? m_InlineOffsets[index] : m_ExtraOffsets[index - InlineCount];
+    }
+
+    size_t GetCount() const
+    {
+        return m_Count;
+    }
+
+private:
+    static const size_t InlineCount = 8;
+
+    uint32_t m_InlineOffsets[InlineCount];
+    std::vector<uint32_t> m_ExtraOffsets;
+    size_t m_Count{ 0 };
+};
+
+// View of a cycle in trace buffer. Nodes are not copied, so the buffer must outlive the view.
+// A view is reused for many cycles by Parse(), which does not allocate memory in most cases.
 class BinaryCycle : public ICycle
 {
 public:
-    static std::unique_ptr<BinaryCycle> Parse(const void* buffer, size_t bufferSize);
+    // pPrevious is the cycle just before, which is needed to reconstruct registers from delta nodes.
+    // pPrevious must not be this view; readers keep two views and use them alternately.
+    void Parse(const void* buffer, size_t bufferSize, const BinaryCycle* pPrevious = nullptr);
+
+    // Returns size of the cycle at buffer by walking node headers only, which is much faster than Parse().
+    // pOutHasDelta is set to true if the cycle has delta nodes, i.e. the cycle can not be parsed without the previous cycle.
+    static size_t Scan(const void* buffer, size_t bufferSize, bool* pOutHasDelta);
+
+    // Appends the cycle at buffer to pBatch by walking nodes, and returns size of the cycle.
+    // Register nodes are not decoded, so the cycle may have delta nodes; pOutHasDelta is set as Scan() does.
+    static size_t AddToBatch(const void* buffer, size_t bufferSize, CycleBatch* pBatch, bool* pOutHasDelta);
+
+    // Folds the cycle at buffer into pSummary by walking nodes, and returns size of the cycle.
+    // Cycle range of the summary is not touched because it is the position of cycles, which only the writer knows.
+    static size_t AddToSummary(const void* buffer, size_t bufferSize, TraceFileSummary* pSummary);
 
     BinaryCycle();
     virtual ~BinaryCycle() override;
@@ -51,10 +110,15 @@ public:
     virtual void CopyMemoryEvent(MemoryEvent* pOutEvent, size_t index) const override;
     virtual void CopyTrapEvent(TrapEvent* pOutEvent, size_t index) const override;
 
+    virtual void CopyIntRegs(uint64_t* pOutRegs) const override;
+    virtual void CopyFpRegs(uint64_t* pOutRegs) const override;
+
     size_t GetSize() const;
 
 private:
+    const void* GetNodeData(uint32_t offset) const;
     size_t ParseNode(const void* buffer, size_t bufferSize);
+    void ApplyDelta(uint64_t* pOutRegs, const void* pNode, size_t nodeSize, size_t regSize, bool isFp);
 
     const void* m_pBuffer{ nullptr };
     size_t m_BufferSize{ 0 };
@@ -66,9 +130,16 @@ private:
     const NodeFpReg* m_pNodeFpReg{ nullptr };
     const NodeIo* m_pNodeIo{ nullptr };
 
-    std::vector<const OpEvent*> m_OpEvents;
-    std::vector<const MemoryEvent*> m_MemoryEvents;
-    std::vector<const TrapEvent*> m_TrapEvents;
+    // Registers reconstructed from delta nodes
+    const BinaryCycle* m_pPrevious{ nullptr };
+    uint64_t m_IntRegs[IntRegCount];
+    uint64_t m_FpRegs[FpRegCount];
+    bool m_IntRegDelta{ false };
+    bool m_FpRegDelta{ false };
+
+    BinaryCycleEventList m_OpEvents;
+    BinaryCycleEventList m_MemoryEvents;
+    BinaryCycleEventList m_TrapEvents;
 
     bool m_Break{ false };
 };
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <cstdlib>
 #include <cstring>
 
 #include <rafi/trace.h>
@@ -27,18 +28,35 @@ namespace {
 class BinaryCycleBuilderImpl final
 {
 public:
-    BinaryCycleBuilderImpl(uint32_t cycle, const XLEN& xlen, uint64_t pc)
+    ~BinaryCycleBuilderImpl()
+    {
+        free(m_pOwnBuffer);
+    }
+
+    void Reset(uint32_t cycle, const XLEN& xlen, uint64_t pc)
     {
-        m_pBuffer = malloc(DefaultBufferSize);
-        m_BufferSize = DefaultBufferSize;
+        if (m_pOwnBuffer == nullptr)
+        {
+            m_pOwnBuffer = malloc(DefaultBufferSize);
+            m_OwnBufferSize = DefaultBufferSize;
+        }
+
+        m_pBuffer = m_pOwnBuffer;
+        m_BufferSize = m_OwnBufferSize;
+        m_DataSize = 0;
 
         NodeBasic node{ cycle, xlen, pc };
         Add(node);
     }
 
-    ~BinaryCycleBuilderImpl()
+    void Reset(void* pBuffer, size_t bufferSize, uint32_t cycle, const XLEN& xlen, uint64_t pc)
     {
-        free(m_pBuffer);
+        m_pBuffer = pBuffer;
+        m_BufferSize = bufferSize;
+        m_DataSize = 0;
+
+        NodeBasic node{ cycle, xlen, pc };
+        Add(node);
     }
 
     void Add(const NodeIntReg32& node)
@@ -76,6 +94,21 @@ public:
         AddData(NodeId_MA, &node, sizeof(node));
     }
 
+    void AddDelta(const NodeIntReg32& node, const NodeIntReg32& base)
+    {
+        AddDeltaData<sizeof(uint32_t)>(NodeId_ID, node.regs, base.regs, IntRegCount);
+    }
+
+    void AddDelta(const NodeIntReg64& node, const NodeIntReg64& base)
+    {
+        AddDeltaData<sizeof(uint64_t)>(NodeId_ID, node.regs, base.regs, IntRegCount);
+    }
+
+    void AddDelta(const NodeFpReg& node, const NodeFpReg& base)
+    {
+        AddDeltaData<sizeof(FpRegUnion)>(NodeId_FD, node.regs, base.regs, FpRegCount);
+    }
+
     void Break()
     {
         AddData(NodeId_BR, nullptr, 0);
@@ -99,11 +132,38 @@ private:
         AddData(NodeId_BA, &node, sizeof(node));
     }
 
+    template <size_t RegSize>
+    void AddDeltaData(uint16_t nodeId, const void* pValues, const void* pBase, int regCount)
+    {
+        static_assert(IntRegCount <= 32 && FpRegCount <= 32, "NodeRegDelta::mask is too narrow.");
+
+        uint8_t payload[sizeof(NodeRegDelta) + RegSize * 32];
+
+        NodeRegDelta delta{ 0, 0 };
+        size_t size = sizeof(delta);
+
+        for (int i = 0; i < regCount; i++)
+        {
+            const auto pValue = reinterpret_cast<const uint8_t*>(pValues) + i * RegSize;
+
+            if (std::memcmp(pValue, reinterpret_cast<const uint8_t*>(pBase) + i * RegSize, RegSize) != 0)
+            {
+                delta.mask |= 1u << i;
+                std::memcpy(&payload[size], pValue, RegSize);
+                size += RegSize;
+            }
+        }
+
+        std::memcpy(payload, &delta, sizeof(delta));
+
+        AddData(nodeId, payload, size);
+    }
+
     void AddData(uint16_t nodeId, const void* pNode, size_t nodeSize)
     {
         if (m_DataSize + sizeof(NodeHeader) + nodeSize > m_BufferSize)
         {
-            throw TraceException("Buffer overflow @ BinaryCycleBuilderImpl.\n");
+            Grow(m_DataSize + sizeof(NodeHeader) + nodeSize);
         }
 
         if (nodeSize > UINT32_MAX)
@@ -123,14 +183,50 @@ private:
         }
     }
 
+    void Grow(size_t requiredSize)
+    {
+        if (m_pOwnBuffer == nullptr || m_pBuffer != m_pOwnBuffer)
+        {
+            throw TraceException("Buffer overflow @ BinaryCycleBuilderImpl.\n");
+        }
+
+        auto newSize = m_OwnBufferSize;
+        while (newSize < requiredSize)
+        {
+            newSize *= 2;
+        }
+
+        auto pNewBuffer = realloc(m_pOwnBuffer, newSize);
+        if (pNewBuffer == nullptr)
+        {
+            throw TraceException("Failed to grow buffer @ BinaryCycleBuilderImpl.\n");
+        }
+
+        m_pOwnBuffer = pNewBuffer;
+        m_OwnBufferSize = newSize;
+        m_pBuffer = m_pOwnBuffer;
+        m_BufferSize = m_OwnBufferSize;
+    }
+
+    // Buffer to which current cycle is written
     void* m_pBuffer{ nullptr };
     size_t m_BufferSize{ 0 };
     size_t m_DataSize{ 0 };
+
+    // Buffer owned by the builder, which is kept over Reset() to be reused
+    void* m_pOwnBuffer{ nullptr };
+    size_t m_OwnBufferSize{ 0 };
 };
 
+BinaryCycleBuilder::BinaryCycleBuilder()
+{
+    m_pImpl = new BinaryCycleBuilderImpl();
+}
+
 BinaryCycleBuilder::BinaryCycleBuilder(uint32_t cycle, const XLEN& xlen, uint64_t pc)
 {
-    m_pImpl = new BinaryCycleBuilderImpl(cycle, xlen, pc);
+    m_pImpl = new BinaryCycleBuilderImpl();
+    m_pImpl->Reset(cycle, xlen, pc);
 }
 
 BinaryCycleBuilder::~BinaryCycleBuilder()
@@ -138,6 +234,16 @@ BinaryCycleBuilder::~BinaryCycleBuilder()
     delete m_pImpl;
 }
 
+void BinaryCycleBuilder::Reset(uint32_t cycle, const XLEN& xlen, uint64_t pc)
+{
+    m_pImpl->Reset(cycle, xlen, pc);
+}
+
+void BinaryCycleBuilder::Reset(void* pBuffer, size_t bufferSize, uint32_t cycle, const XLEN& xlen, uint64_t pc)
+{
+    m_pImpl->Reset(pBuffer, bufferSize, cycle, xlen, pc);
+}
+
 void BinaryCycleBuilder::Add(const NodeIntReg32& value)
 {
     m_pImpl->Add(value);
@@ -173,6 +279,21 @@ void BinaryCycleBuilder::Add(const MemoryEvent& value)
     m_pImpl->Add(value);
 }
 
+void BinaryCycleBuilder::AddDelta(const NodeIntReg32& value, const NodeIntReg32& base)
+{
+    m_pImpl->AddDelta(value, base);
+}
+
+void BinaryCycleBuilder::AddDelta(const NodeIntReg64& value, const NodeIntReg64& base)
+{
+    m_pImpl->AddDelta(value, base);
+}
+
+void BinaryCycleBuilder::AddDelta(const NodeFpReg& value, const NodeFpReg& base)
+{
+    m_pImpl->AddDelta(value, base);
+}
+
 void BinaryCycleBuilder::Break()
 {
     m_pImpl->Break();
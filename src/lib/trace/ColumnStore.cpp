@@ -0,0 +1,717 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <rafi/trace.h>
+
+#include "CompressedTrace.h"
+#include "MappedFile.h"
+
+namespace rafi { namespace trace {
+
+namespace {
+    // Returns physical address of the last byte accessed by a memory event.
+    uint64_t GetLastAddress(uint64_t paddr, uint32_t size)
+    {
+        return paddr + std::max<uint64_t>(size, 1) - 1;
+    }
+
+    void EncodePosting(std::vector<uint8_t>* pOut, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            pOut->push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        pOut->push_back(static_cast<uint8_t>(value));
+    }
+
+    void DecodePosting(std::vector<uint64_t>* pOut, const uint8_t* p, size_t size, uint32_t count)
+    {
+        size_t offset = 0;
+        uint64_t row = 0;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint64_t delta = 0;
+            int shift = 0;
+
+            for (;;)
+            {
+                if (offset >= size || shift >= 64)
+                {
+                    throw TraceException("Broken posting list @ ColumnStoreReader.\n");
+                }
+
+                const auto byte = p[offset++];
+                delta |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                shift += 7;
+
+                if ((byte & 0x80) == 0)
+                {
+                    break;
+                }
+            }
+
+            row += delta;
+            pOut->push_back(row);
+        }
+    }
+}
+
+class ColumnStoreWriterImpl final
+{
+public:
+    ColumnStoreWriterImpl(const char* path, uint32_t blockCycleCount)
+        : m_Path(path)
+        , m_BlockCycleCount(blockCycleCount)
+    {
+        if (blockCycleCount == 0)
+        {
+            throw TraceException("argument 'blockCycleCount' is out-of-range.");
+        }
+
+        m_pFile = std::fopen(path, "wb");
+        if (m_pFile == nullptr)
+        {
+            throw FileOpenFailureException(path);
+        }
+
+        ColumnStoreHeader header;
+        std::memcpy(header.magic, ColumnStoreMagic, sizeof(header.magic));
+        header.version = ColumnStoreVersion;
+        header.blockCycleCount = blockCycleCount;
+
+        std::fwrite(&header, sizeof(header), 1, m_pFile);
+        m_Offset = sizeof(header);
+    }
+
+    ~ColumnStoreWriterImpl()
+    {
+        if (m_pFile == nullptr)
+        {
+            return;
+        }
+
+        // Store is left without footer by an error in Write(), so it is not readable in any case.
+        if (m_Broken)
+        {
+            Discard();
+            return;
+        }
+
+        try
+        {
+            Close();
+        }
+        catch (const TraceException& e)
+        {
+            e.PrintMessage();
+        }
+    }
+
+    void Close()
+    {
+        if (m_pFile == nullptr)
+        {
+            return;
+        }
+
+        try
+        {
+            if (m_Broken)
+            {
+                throw TraceException("Columnar trace store is broken by a previous error.\n");
+            }
+
+            ColumnStoreFooter footer;
+            std::memset(&footer, 0, sizeof(footer));
+
+            if (m_Block.GetCycleCount() > 0)
+            {
+                FlushBlock();
+            }
+
+            const auto pcEntries = WritePostings(m_PcIndex);
+            const auto pageEntries = WritePostings(m_PageIndex);
+
+            footer.pcIndexOffset = m_Offset;
+            footer.pcKeyCount = pcEntries.size();
+            WriteData(pcEntries.data(), pcEntries.size() * sizeof(ColumnStoreIndexEntry));
+
+            footer.pageIndexOffset = m_Offset;
+            footer.pageKeyCount = pageEntries.size();
+            WriteData(pageEntries.data(), pageEntries.size() * sizeof(ColumnStoreIndexEntry));
+
+            footer.rowCount = m_Row;
+            footer.memoryEventRowCount = m_MemoryEventRow;
+            footer.blockOffset = m_Offset;
+            footer.blockCount = m_Blocks.size();
+            std::memcpy(footer.magic, ColumnStoreMagic, sizeof(footer.magic));
+
+            WriteData(m_Blocks.data(), m_Blocks.size() * sizeof(ColumnStoreBlockEntry));
+            WriteData(&footer, sizeof(footer));
+        }
+        catch (const TraceException&)
+        {
+            Discard();
+            throw;
+        }
+
+        const auto result = std::fclose(m_pFile);
+        m_pFile = nullptr;
+
+        if (result != 0)
+        {
+            std::remove(m_Path.c_str());
+            throw TraceException("Failed to write columnar trace store.\n");
+        }
+    }
+
+    void Write(const CycleBatch& batch)
+    {
+        if (m_pFile == nullptr)
+        {
+            throw TraceException("Columnar trace store is already closed.\n");
+        }
+
+        try
+        {
+            WriteImpl(batch);
+        }
+        catch (const TraceException&)
+        {
+            m_Broken = true;
+            throw;
+        }
+    }
+
+private:
+    void WriteImpl(const CycleBatch& batch)
+    {
+        size_t memIndex = 0;
+
+        for (size_t i = 0; i < batch.GetCycleCount(); i++)
+        {
+            const auto index = m_Block.AddCycle(batch.cycle[i], batch.pc[i]);
+            m_Block.insn[index] = batch.insn[i];
+            m_Block.priv[index] = batch.priv[i];
+            m_Block.hostIo[index] = batch.hostIo[i];
+            m_Block.flags[index] = batch.flags[i];
+
+            AddPosting(&m_PcIndex, batch.pc[i], m_Row);
+
+            for (; memIndex < batch.GetMemoryEventCount() && batch.memCycleIndex[memIndex] == i; memIndex++)
+            {
+                MemoryEvent event;
+                event.accessType = batch.memAccessType[memIndex];
+                event.size = batch.memSize[memIndex];
+                event.value = batch.memValue[memIndex];
+                event.vaddr = batch.memVaddr[memIndex];
+                event.paddr = batch.memPaddr[memIndex];
+
+                m_Block.AddMemoryEvent(index, event);
+
+                // Misaligned access may cross a page boundary, and then it is indexed under both pages.
+                const auto firstPage = event.paddr >> ColumnStorePageShift;
+                const auto lastPage = GetLastAddress(event.paddr, event.size) >> ColumnStorePageShift;
+
+                AddPosting(&m_PageIndex, firstPage, m_MemoryEventRow);
+                if (lastPage != firstPage)
+                {
+                    AddPosting(&m_PageIndex, lastPage, m_MemoryEventRow);
+                }
+
+                m_MemoryEventRow++;
+            }
+
+            m_Row++;
+
+            if (m_Block.GetCycleCount() == m_BlockCycleCount)
+            {
+                FlushBlock();
+            }
+        }
+    }
+
+    // Removes the incomplete store so that it is not mistaken for a valid one.
+    void Discard()
+    {
+        std::fclose(m_pFile);
+        m_pFile = nullptr;
+
+        std::remove(m_Path.c_str());
+    }
+
+    struct Posting
+    {
+        uint64_t lastRow;
+        uint32_t rowCount;
+        std::vector<uint8_t> data;
+    };
+
+    using PostingMap = std::unordered_map<uint64_t, Posting>;
+
+    void AddPosting(PostingMap* pIndex, uint64_t key, uint64_t row)
+    {
+        auto& posting = (*pIndex)[key];
+
+        if (posting.rowCount == UINT32_MAX)
+        {
+            throw TraceException("Too many rows for a key @ ColumnStoreWriter.\n");
+        }
+
+        EncodePosting(&posting.data, posting.rowCount == 0 ? row : row - posting.lastRow);
+        posting.lastRow = row;
+        posting.rowCount++;
+    }
+
+    std::vector<ColumnStoreIndexEntry> WritePostings(const PostingMap& index)
+    {
+        std::vector<uint64_t> keys;
+        keys.reserve(index.size());
+
+        for (const auto& pair : index)
+        {
+            keys.push_back(pair.first);
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<ColumnStoreIndexEntry> entries;
+        entries.reserve(keys.size());
+
+        for (const auto key : keys)
+        {
+            const auto& posting = index.at(key);
+
+            if (posting.data.size() > UINT32_MAX)
+            {
+                throw TraceException("Posting list is too large @ ColumnStoreWriter.\n");
+            }
+
+            ColumnStoreIndexEntry entry;
+            entry.key = key;
+            entry.offset = m_Offset;
+            entry.rowCount = posting.rowCount;
+            entry.size = static_cast<uint32_t>(posting.data.size());
+            entries.push_back(entry);
+
+            WriteData(posting.data.data(), posting.data.size());
+        }
+
+        return entries;
+    }
+
+    void FlushBlock()
+    {
+        ColumnStoreBlockEntry entry;
+        std::memset(&entry, 0, sizeof(entry));
+
+        entry.firstRow = m_Row - m_Block.GetCycleCount();
+        entry.firstMemoryEventRow = m_MemoryEventRow - m_Block.GetMemoryEventCount();
+        entry.cycleCount = static_cast<uint32_t>(m_Block.GetCycleCount());
+        entry.memoryEventCount = static_cast<uint32_t>(m_Block.GetMemoryEventCount());
+
+        const auto pc = std::minmax_element(m_Block.pc.begin(), m_Block.pc.end());
+        entry.pcMin = *pc.first;
+        entry.pcMax = *pc.second;
+
+        if (entry.memoryEventCount > 0)
+        {
+            entry.paddrMin = UINT64_MAX;
+
+            for (size_t i = 0; i < m_Block.GetMemoryEventCount(); i++)
+            {
+                entry.paddrMin = std::min(entry.paddrMin, m_Block.memPaddr[i]);
+                entry.paddrMax = std::max(entry.paddrMax, GetLastAddress(m_Block.memPaddr[i], m_Block.memSize[i]));
+            }
+        }
+
+        // Deltas of pc are small in most cases, so they are compressed much better than pc itself.
+        m_PcDelta.resize(m_Block.pc.size());
+        for (size_t i = 0; i < m_Block.pc.size(); i++)
+        {
+            m_PcDelta[i] = m_Block.pc[i] - (i == 0 ? 0 : m_Block.pc[i - 1]);
+        }
+
+        WriteColumn(&entry.columns[ColumnId_Cycle], m_Block.cycle);
+        WriteColumn(&entry.columns[ColumnId_Pc], m_PcDelta);
+        WriteColumn(&entry.columns[ColumnId_Insn], m_Block.insn);
+        WriteColumn(&entry.columns[ColumnId_Priv], m_Block.priv);
+        WriteColumn(&entry.columns[ColumnId_HostIo], m_Block.hostIo);
+        WriteColumn(&entry.columns[ColumnId_Flags], m_Block.flags);
+        WriteColumn(&entry.columns[ColumnId_MemCycleIndex], m_Block.memCycleIndex);
+        WriteColumn(&entry.columns[ColumnId_MemAccessType], m_Block.memAccessType);
+        WriteColumn(&entry.columns[ColumnId_MemSize], m_Block.memSize);
+        WriteColumn(&entry.columns[ColumnId_MemValue], m_Block.memValue);
+        WriteColumn(&entry.columns[ColumnId_MemVaddr], m_Block.memVaddr);
+        WriteColumn(&entry.columns[ColumnId_MemPaddr], m_Block.memPaddr);
+
+        m_Blocks.push_back(entry);
+        m_Block.Clear();
+    }
+
+    template <typename T>
+    void WriteColumn(ColumnStoreColumnEntry* pEntry, const std::vector<T>& column)
+    {
+        const auto rawSize = column.size() * sizeof(T);
+
+        pEntry->offset = m_Offset;
+        pEntry->rawSize = static_cast<uint32_t>(rawSize);
+        pEntry->compressedSize = 0;
+
+        if (rawSize == 0)
+        {
+            return;
+        }
+
+        CompressBlock(&m_Compressed, column.data(), rawSize);
+        pEntry->compressedSize = static_cast<uint32_t>(m_Compressed.size());
+
+        WriteData(m_Compressed.data(), m_Compressed.size());
+    }
+
+    void WriteData(const void* pData, size_t size)
+    {
+        if (size > 0 && std::fwrite(pData, size, 1, m_pFile) != 1)
+        {
+            throw TraceException("Failed to write columnar trace store.\n");
+        }
+
+        m_Offset += size;
+    }
+
+    std::string m_Path;
+    std::FILE* m_pFile{ nullptr };
+    uint64_t m_Offset{ 0 };
+    bool m_Broken{ false };
+
+    uint32_t m_BlockCycleCount;
+    uint64_t m_Row{ 0 };
+    uint64_t m_MemoryEventRow{ 0 };
+
+    CycleBatch m_Block;
+    std::vector<uint64_t> m_PcDelta;
+    std::vector<char> m_Compressed;
+    std::vector<ColumnStoreBlockEntry> m_Blocks;
+
+    PostingMap m_PcIndex;
+    PostingMap m_PageIndex;
+};
+
+class ColumnStoreReaderImpl final
+{
+public:
+    explicit ColumnStoreReaderImpl(const char* path)
+        : m_File(path)
+    {
+        const auto p = reinterpret_cast<const uint8_t*>(m_File.GetData());
+        const auto size = m_File.GetSize();
+
+        ColumnStoreHeader header;
+
+        if (size < sizeof(header) + sizeof(m_Footer))
+        {
+            throw TraceException("Columnar trace store is too small.");
+        }
+
+        std::memcpy(&header, p, sizeof(header));
+        std::memcpy(&m_Footer, p + size - sizeof(m_Footer), sizeof(m_Footer));
+
+        if (std::memcmp(header.magic, ColumnStoreMagic, sizeof(header.magic)) != 0 || header.version != ColumnStoreVersion
+            || std::memcmp(m_Footer.magic, ColumnStoreMagic, sizeof(m_Footer.magic)) != 0)
+        {
+            throw TraceException("Invalid columnar trace store header.");
+        }
+
+        const auto footerOffset = size - sizeof(m_Footer);
+
+        CopyEntries(&m_PcIndex, m_Footer.pcIndexOffset, m_Footer.pcKeyCount, footerOffset);
+        CopyEntries(&m_PageIndex, m_Footer.pageIndexOffset, m_Footer.pageKeyCount, footerOffset);
+        CopyEntries(&m_Blocks, m_Footer.blockOffset, m_Footer.blockCount, footerOffset);
+    }
+
+    uint64_t GetRowCount() const
+    {
+        return m_Footer.rowCount;
+    }
+
+    uint64_t GetMemoryEventRowCount() const
+    {
+        return m_Footer.memoryEventRowCount;
+    }
+
+    size_t GetBlockCount() const
+    {
+        return m_Blocks.size();
+    }
+
+    const ColumnStoreBlockEntry& GetBlock(size_t index) const
+    {
+        return m_Blocks.at(index);
+    }
+
+    size_t FindBlock(uint64_t row) const
+    {
+        if (row >= m_Footer.rowCount)
+        {
+            throw TraceException("argument 'row' is out-of-range.", static_cast<int64_t>(row));
+        }
+
+        const auto it = std::upper_bound(m_Blocks.begin(), m_Blocks.end(), row, [](uint64_t value, const ColumnStoreBlockEntry& entry)
+        {
+            return value < entry.firstRow;
+        });
+
+        return static_cast<size_t>(it - m_Blocks.begin()) - 1;
+    }
+
+    size_t FindBlockByMemoryEventRow(uint64_t memoryEventRow) const
+    {
+        if (memoryEventRow >= m_Footer.memoryEventRowCount)
+        {
+            throw TraceException("argument 'memoryEventRow' is out-of-range.", static_cast<int64_t>(memoryEventRow));
+        }
+
+        // Blocks without memory events have the same firstMemoryEventRow as the next block, so take the last one.
+        const auto it = std::upper_bound(m_Blocks.begin(), m_Blocks.end(), memoryEventRow, [](uint64_t value, const ColumnStoreBlockEntry& entry)
+        {
+            return value < entry.firstMemoryEventRow;
+        });
+
+        return static_cast<size_t>(it - m_Blocks.begin()) - 1;
+    }
+
+    void ReadBlock(CycleBatch* pOutBatch, size_t index, uint32_t columnMask) const
+    {
+        const auto& entry = m_Blocks.at(index);
+
+        pOutBatch->Clear();
+
+        if (columnMask & GetColumnMask(ColumnId_Cycle))
+        {
+            ReadColumn(&pOutBatch->cycle, entry.columns[ColumnId_Cycle], entry.cycleCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_Pc))
+        {
+            ReadColumn(&pOutBatch->pc, entry.columns[ColumnId_Pc], entry.cycleCount);
+
+            for (size_t i = 1; i < pOutBatch->pc.size(); i++)
+            {
+                pOutBatch->pc[i] += pOutBatch->pc[i - 1];
+            }
+        }
+        if (columnMask & GetColumnMask(ColumnId_Insn))
+        {
+            ReadColumn(&pOutBatch->insn, entry.columns[ColumnId_Insn], entry.cycleCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_Priv))
+        {
+            ReadColumn(&pOutBatch->priv, entry.columns[ColumnId_Priv], entry.cycleCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_HostIo))
+        {
+            ReadColumn(&pOutBatch->hostIo, entry.columns[ColumnId_HostIo], entry.cycleCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_Flags))
+        {
+            ReadColumn(&pOutBatch->flags, entry.columns[ColumnId_Flags], entry.cycleCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_MemCycleIndex))
+        {
+            ReadColumn(&pOutBatch->memCycleIndex, entry.columns[ColumnId_MemCycleIndex], entry.memoryEventCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_MemAccessType))
+        {
+            ReadColumn(&pOutBatch->memAccessType, entry.columns[ColumnId_MemAccessType], entry.memoryEventCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_MemSize))
+        {
+            ReadColumn(&pOutBatch->memSize, entry.columns[ColumnId_MemSize], entry.memoryEventCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_MemValue))
+        {
+            ReadColumn(&pOutBatch->memValue, entry.columns[ColumnId_MemValue], entry.memoryEventCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_MemVaddr))
+        {
+            ReadColumn(&pOutBatch->memVaddr, entry.columns[ColumnId_MemVaddr], entry.memoryEventCount);
+        }
+        if (columnMask & GetColumnMask(ColumnId_MemPaddr))
+        {
+            ReadColumn(&pOutBatch->memPaddr, entry.columns[ColumnId_MemPaddr], entry.memoryEventCount);
+        }
+    }
+
+    void FindPc(std::vector<uint64_t>* pOutRows, uint64_t pc) const
+    {
+        FindKey(pOutRows, m_PcIndex, pc);
+    }
+
+    void FindPage(std::vector<uint64_t>* pOutMemoryEventRows, uint64_t page) const
+    {
+        FindKey(pOutMemoryEventRows, m_PageIndex, page);
+    }
+
+private:
+    template <typename T>
+    void CopyEntries(std::vector<T>* pOut, uint64_t offset, uint64_t count, uint64_t end) const
+    {
+        if (offset > end || count > (end - offset) / sizeof(T))
+        {
+            throw TraceException("Broken index @ ColumnStoreReader.\n");
+        }
+
+        pOut->resize(static_cast<size_t>(count));
+
+        if (count > 0)
+        {
+            std::memcpy(pOut->data(), reinterpret_cast<const uint8_t*>(m_File.GetData()) + offset, static_cast<size_t>(count) * sizeof(T));
+        }
+    }
+
+    template <typename T>
+    void ReadColumn(std::vector<T>* pOut, const ColumnStoreColumnEntry& entry, uint32_t count) const
+    {
+        if (entry.rawSize != static_cast<uint64_t>(count) * sizeof(T) || entry.offset + entry.compressedSize > m_Footer.pcIndexOffset)
+        {
+            throw TraceException("Broken column @ ColumnStoreReader.\n");
+        }
+
+        pOut->resize(count);
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        std::vector<char> raw;
+        DecompressBlock(&raw, reinterpret_cast<const uint8_t*>(m_File.GetData()) + entry.offset, entry.compressedSize, entry.rawSize);
+        std::memcpy(pOut->data(), raw.data(), entry.rawSize);
+    }
+
+    void FindKey(std::vector<uint64_t>* pOutRows, const std::vector<ColumnStoreIndexEntry>& index, uint64_t key) const
+    {
+        const auto it = std::lower_bound(index.begin(), index.end(), key, [](const ColumnStoreIndexEntry& entry, uint64_t value)
+        {
+            return entry.key < value;
+        });
+
+        if (it == index.end() || it->key != key)
+        {
+            return;
+        }
+
+        if (it->offset + it->size > m_File.GetSize())
+        {
+            throw TraceException("Broken index @ ColumnStoreReader.\n");
+        }
+
+        pOutRows->reserve(pOutRows->size() + it->rowCount);
+        DecodePosting(pOutRows, reinterpret_cast<const uint8_t*>(m_File.GetData()) + it->offset, it->size, it->rowCount);
+    }
+
+    MappedFile m_File;
+    ColumnStoreFooter m_Footer;
+
+    std::vector<ColumnStoreIndexEntry> m_PcIndex;
+    std::vector<ColumnStoreIndexEntry> m_PageIndex;
+    std::vector<ColumnStoreBlockEntry> m_Blocks;
+};
+
+ColumnStoreWriter::ColumnStoreWriter(const char* path, uint32_t blockCycleCount)
+{
+    m_pImpl = new ColumnStoreWriterImpl(path, blockCycleCount);
+}
+
+ColumnStoreWriter::~ColumnStoreWriter()
+{
+    delete m_pImpl;
+}
+
+void ColumnStoreWriter::Write(const CycleBatch& batch)
+{
+    m_pImpl->Write(batch);
+}
+
+void ColumnStoreWriter::Close()
+{
+    m_pImpl->Close();
+}
+
+ColumnStoreReader::ColumnStoreReader(const char* path)
+{
+    m_pImpl = new ColumnStoreReaderImpl(path);
+}
+
+ColumnStoreReader::~ColumnStoreReader()
+{
+    delete m_pImpl;
+}
+
+uint64_t ColumnStoreReader::GetRowCount() const
+{
+    return m_pImpl->GetRowCount();
+}
+
+uint64_t ColumnStoreReader::GetMemoryEventRowCount() const
+{
+    return m_pImpl->GetMemoryEventRowCount();
+}
+
+size_t ColumnStoreReader::GetBlockCount() const
+{
+    return m_pImpl->GetBlockCount();
+}
+
+const ColumnStoreBlockEntry& ColumnStoreReader::GetBlock(size_t index) const
+{
+    return m_pImpl->GetBlock(index);
+}
+
+size_t ColumnStoreReader::FindBlock(uint64_t row) const
+{
+    return m_pImpl->FindBlock(row);
+}
+
+size_t ColumnStoreReader::FindBlockByMemoryEventRow(uint64_t memoryEventRow) const
+{
+    return m_pImpl->FindBlockByMemoryEventRow(memoryEventRow);
+}
+
+void ColumnStoreReader::ReadBlock(CycleBatch* pOutBatch, size_t index, uint32_t columnMask) const
+{
+    m_pImpl->ReadBlock(pOutBatch, index, columnMask);
+}
+
+void ColumnStoreReader::FindPc(std::vector<uint64_t>* pOutRows, uint64_t pc) const
+{
+    m_pImpl->FindPc(pOutRows, pc);
+}
+
+void ColumnStoreReader::FindPage(std::vector<uint64_t>* pOutMemoryEventRows, uint64_t page) const
+{
+    m_pImpl->FindPage(pOutMemoryEventRows, page);
+}
+
+}}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <climits>
+
+#include <zlib.h>
+
+#include <rafi/trace.h>
+
+#include "CompressedTrace.h"
+
+namespace rafi { namespace trace {
+
+namespace {
+    // Trace is written while emulation is running, so speed is preferred to ratio.
+    const int CompressionLevel = Z_BEST_SPEED;
+}
+
+void CompressBlock(std::vector<char>* pOut, const void* pRaw, size_t rawSize)
+{
+    if (rawSize > UINT32_MAX)
+    {
+        throw TraceException("Block is too large @ CompressBlock.\n");
+    }
+
+    auto size = compressBound(static_cast<uLong>(rawSize));
+    pOut->resize(size);
+
+    const auto result = compress2(reinterpret_cast<Bytef*>(pOut->data()), &size, reinterpret_cast<const Bytef*>(pRaw), static_cast<uLong>(rawSize), CompressionLevel);
+    if (result != Z_OK)
+    {
+        throw TraceException("Failed to compress block.\n");
+    }
+
+    pOut->resize(size);
+}
+
+void DecompressBlock(std::vector<char>* pOut, const void* pCompressed, size_t compressedSize, size_t rawSize)
+{
+    pOut->resize(rawSize);
+
+    uLongf size = static_cast<uLongf>(rawSize);
+
+    const auto result = uncompress(reinterpret_cast<Bytef*>(pOut->data()), &size, reinterpret_cast<const Bytef*>(pCompressed), static_cast<uLong>(compressedSize));
+    if (result != Z_OK || size != rawSize)
+    {
+        throw TraceException("Failed to decompress block.\n");
+    }
+}
+
+}}
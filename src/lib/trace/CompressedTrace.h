@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rafi { namespace trace {
+
+// Layout of compressed trace file (.tcz)
+//   CompressedTraceHeader
+//   compressed blocks (each one is zlib stream of whole cycles in the same format as .tbin)
+//   CompressedTraceBlockEntry x blockCount
+//   CompressedTraceFooter
+// Each block is decoded independently, so a block begins with full register nodes if delta nodes are used.
+
+const char CompressedTraceMagic[8] = { 'R', 'A', 'F', 'I', 'T', 'C', 'Z', '\0' };
+const uint32_t CompressedTraceVersion = 1;
+
+struct CompressedTraceHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct CompressedTraceBlockEntry
+{
+    uint64_t offset;
+    uint64_t firstCycle;
+    uint32_t cycleCount;
+    uint32_t compressedSize;
+    uint32_t rawSize;
+    uint32_t reserved;
+};
+
+struct CompressedTraceFooter
+{
+    uint64_t indexOffset;
+    uint64_t blockCount;
+    char magic[8];
+};
+
+void CompressBlock(std::vector<char>* pOut, const void* pRaw, size_t rawSize);
+void DecompressBlock(std::vector<char>* pOut, const void* pCompressed, size_t compressedSize, size_t rawSize);
+
+}}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rafi/trace.h>
+
+namespace rafi { namespace trace {
+
+void CycleBatch::Clear()
+{
+    cycle.clear();
+    pc.clear();
+    insn.clear();
+    priv.clear();
+    hostIo.clear();
+    flags.clear();
+
+    memCycleIndex.clear();
+    memAccessType.clear();
+    memSize.clear();
+    memValue.clear();
+    memVaddr.clear();
+    memPaddr.clear();
+}
+
+size_t CycleBatch::AddCycle(uint32_t cycleValue, uint64_t pcValue)
+{
+    cycle.push_back(cycleValue);
+    pc.push_back(pcValue);
+    insn.push_back(0);
+    priv.push_back(PrivilegeLevel::Machine);
+    hostIo.push_back(0);
+    flags.push_back(0);
+
+    return cycle.size() - 1;
+}
+
+void CycleBatch::SetOp(size_t index, const OpEvent& event)
+{
+    // Keep the first op event if a cycle has many.
+    if ((flags[index] & CycleBatchFlag_Op) != 0)
+    {
+        return;
+    }
+
+    insn[index] = event.insn;
+    priv[index] = event.priv;
+    flags[index] |= CycleBatchFlag_Op;
+}
+
+void CycleBatch::SetIo(size_t index, const NodeIo& io)
+{
+    hostIo[index] = io.hostIo;
+    flags[index] |= CycleBatchFlag_Io;
+}
+
+void CycleBatch::SetFlag(size_t index, uint8_t flag)
+{
+    flags[index] |= flag;
+}
+
+void CycleBatch::AddMemoryEvent(size_t index, const MemoryEvent& event)
+{
+    memCycleIndex.push_back(static_cast<uint32_t>(index));
+    memAccessType.push_back(event.accessType);
+    memSize.push_back(event.size);
+    memValue.push_back(event.value);
+    memVaddr.push_back(event.vaddr);
+    memPaddr.push_back(event.paddr);
+}
+
+// Generic implementation through ICycle, which is used by readers of text and gdb traces.
+size_t ITraceReader::ReadBatch(CycleBatch* pBatch, size_t maxCycleCount)
+{
+    size_t count = 0;
+
+    for (; count < maxCycleCount && !IsEnd(); count++)
+    {
+        const auto pCycle = GetCycle();
+        const auto index = pBatch->AddCycle(pCycle->GetCycle(), pCycle->GetPc());
+
+        if (pCycle->GetOpEventCount() > 0)
+        {
+            OpEvent event;
+            pCycle->CopyOpEvent(&event, 0);
+            pBatch->SetOp(index, event);
+        }
+        if (pCycle->GetTrapEventCount() > 0)
+        {
+            pBatch->SetFlag(index, CycleBatchFlag_Trap);
+        }
+        if (pCycle->IsIntRegExist())
+        {
+            pBatch->SetFlag(index, CycleBatchFlag_IntReg);
+        }
+        if (pCycle->IsFpRegExist())
+        {
+            pBatch->SetFlag(index, CycleBatchFlag_FpReg);
+        }
+        if (pCycle->IsIoExist())
+        {
+            NodeIo io;
+            pCycle->CopyIo(&io);
+            pBatch->SetIo(index, io);
+        }
+
+        for (size_t i = 0; i < pCycle->GetMemoryEventCount(); i++)
+        {
+            MemoryEvent event;
+            pCycle->CopyMemoryEvent(&event, i);
+            pBatch->AddMemoryEvent(index, event);
+        }
+
+        Next();
+    }
+
+    return count;
+}
+
+}}
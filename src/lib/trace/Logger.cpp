@@ -14,14 +14,26 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <memory>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include <rafi/trace.h>
 
+#include "SpscRing.h"
+
 namespace rafi { namespace trace {
 
+// Logging is pipelined over three threads to keep the emulation thread free from encoding and file I/O.
+//   emulation thread: copies raw state and events of a cycle into a CycleRecord slot of SpscRing.
+//   encoder thread: builds binary cycles from CycleRecords directly in the write buffer of TraceIndexWriter.
+//   writer thread (in TraceIndexWriter): writes a chunk of cycles to file while the encoder fills the other one.
+// If the file system can not keep up, both buffers fill up and the emulation thread waits for a free slot.
 class LoggerImpl final
 {
 public:
@@ -32,12 +44,40 @@ public:
     {
         if (m_Config.enabled)
         {
-            m_pTraceWriter = new TraceIndexWriter(m_Config.path.c_str());
+            // Half of the memory budget is for pending cycles, and the other half is for file write buffers.
+            const auto ringCapacity = std::max(m_Config.bufferSize / 2 / sizeof(CycleRecord), MinRingCapacity);
+
+            if (m_Config.enableCompression)
+            {
+                // Each compression worker holds a raw and a compressed block.
+                const auto threadCount = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+                const auto blockSize = std::min(TraceCompressedWriter::DefaultBlockSize, m_Config.bufferSize / 2 / 2 / (threadCount + 1));
+                const auto path = m_Config.path + ".tcz";
+
+                m_pTraceWriter = new TraceCompressedWriter(path.c_str(), blockSize, threadCount);
+            }
+            else
+            {
+                m_pTraceWriter = new TraceIndexWriter(m_Config.path.c_str(), m_Config.bufferSize / 2);
+            }
+            m_pRing = new SpscRing<CycleRecord>(ringCapacity);
+            m_EncoderThread = std::thread([this] { EncoderThreadMain(); });
         }
     }
 
     ~LoggerImpl()
     {
+        if (m_EncoderThread.joinable())
+        {
+            m_Stop.store(true, std::memory_order_release);
+            m_EncoderThread.join();
+        }
+
+        if (m_pRing != nullptr)
+        {
+            delete m_pRing;
+        }
+
         if (m_pTraceWriter != nullptr)
         {
             delete m_pTraceWriter;
@@ -51,7 +91,19 @@ public:
             return;
         }
 
-        m_pCurrentCycle = new BinaryCycleBuilder(cycle, m_XLEN, pc);
+        RingBackoff backoff;
+
+        while ((m_pCurrentCycle = m_pRing->GetBack()) == nullptr)
+        {
+            CheckEncoderError();
+            backoff.Wait();
+        }
+
+        m_pCurrentCycle->cycle = cycle;
+        m_pCurrentCycle->pc = pc;
+        m_pCurrentCycle->stateRecorded = false;
+        m_pCurrentCycle->eventCount = 0;
+        m_pCurrentCycle->extraEvents.clear();
     }
 
     void RecordState()
@@ -65,15 +117,11 @@ public:
         {
             if (m_XLEN == XLEN::XLEN32)
             {
-                NodeIntReg32 node;
-                m_pLoggerTarget->CopyIntReg(&node);
-                m_pCurrentCycle->Add(node);
+                m_pLoggerTarget->CopyIntReg(&m_pCurrentCycle->intReg.rv32);
             }
             else if (m_XLEN == XLEN::XLEN64)
             {
-                NodeIntReg64 node;
-                m_pLoggerTarget->CopyIntReg(&node);
-                m_pCurrentCycle->Add(node);
+                m_pLoggerTarget->CopyIntReg(&m_pCurrentCycle->intReg.rv64);
             }
             else
             {
@@ -83,16 +131,15 @@ public:
 
         if (m_Config.enableDumpFpReg)
         {
-            NodeFpReg node;
-            m_pLoggerTarget->CopyFpReg(&node);
-            m_pCurrentCycle->Add(node);
+            m_pLoggerTarget->CopyFpReg(&m_pCurrentCycle->fpReg);
         }
 
         if (m_Config.enableDumpHostIo)
         {
-            NodeIo node = { m_pLoggerTarget->GetHostIoValue(), 0 };
-            m_pCurrentCycle->Add(node);
+            m_pCurrentCycle->io = { m_pLoggerTarget->GetHostIoValue(), 0 };
         }
+
+        m_pCurrentCycle->stateRecorded = true;
     }
 
     void RecordEvent()
@@ -102,45 +149,265 @@ public:
             return;
         }
 
-        for (const auto event: m_pLoggerTarget->GetEventList())
+        for (const auto& event: m_pLoggerTarget->GetEventList())
+        {
+            if (m_pCurrentCycle->eventCount < InlineEventCount)
+            {
+                m_pCurrentCycle->events[m_pCurrentCycle->eventCount] = event;
+            }
+            else
+            {
+                m_pCurrentCycle->extraEvents.push_back(event);
+            }
+
+            m_pCurrentCycle->eventCount++;
+        }
+    }
+
+    void EndCycle()
+    {
+        if (!m_Config.enabled)
+        {
+            return;
+        }
+
+        m_pRing->PushBack();
+        m_pCurrentCycle = nullptr;
+
+        CheckEncoderError();
+    }
+
+private:
+    static const size_t InlineEventCount = 8;
+    static constexpr size_t MinRingCapacity = 256;
+
+    // Raw contents of a cycle. Nodes are encoded by the encoder thread.
+    struct CycleRecord
+    {
+        int cycle;
+        uint64_t pc;
+        bool stateRecorded;
+
+        union
+        {
+            NodeIntReg32 rv32;
+            NodeIntReg64 rv64;
+        } intReg;
+
+        NodeFpReg fpReg;
+        NodeIo io;
+
+        // Events which do not fit in events[] go to extraEvents, whose capacity is kept over reuse of the slot.
+        size_t eventCount;
+        Event events[InlineEventCount];
+        std::vector<Event> extraEvents;
+
+        const Event& GetEvent(size_t index) const
+        {
+            return index < InlineEventCount ? events[index] : extraEvents[index - InlineEventCount];
+        }
+    };
+
+    void EncoderThreadMain()
+    {
+        RingBackoff backoff;
+
+        try
+        {
+            for (;;)
+            {
+                const auto pRecord = m_pRing->GetFront();
+
+                if (pRecord == nullptr)
+                {
+                    // Records pushed before m_Stop is set must be encoded, so check the ring again after m_Stop.
+                    if (m_Stop.load(std::memory_order_acquire) && m_pRing->GetFront() == nullptr)
+                    {
+                        return;
+                    }
+
+                    backoff.Wait();
+                    continue;
+                }
+
+                backoff.Reset();
+
+                Encode(*pRecord);
+                m_pRing->PopFront();
+            }
+        }
+        catch (...)
+        {
+            m_EncoderError = std::current_exception();
+            m_EncoderFailed.store(true, std::memory_order_release);
+        }
+    }
+
+    size_t GetEncodedSize(const CycleRecord& record) const
+    {
+        auto size = BinaryCycleBuilder::GetEncodedNodeSize(sizeof(NodeBasic)) + BinaryCycleBuilder::GetEncodedNodeSize(0);
+
+        // Delta node of registers is larger than full node in the worst case.
+        const auto regOverhead = m_Config.enableRegDelta ? sizeof(NodeRegDelta) : 0;
+
+        if (record.stateRecorded)
+        {
+            if (m_Config.enableDumpIntReg)
+            {
+                size += BinaryCycleBuilder::GetEncodedNodeSize(regOverhead + (m_XLEN == XLEN::XLEN32 ? sizeof(NodeIntReg32) : sizeof(NodeIntReg64)));
+            }
+            if (m_Config.enableDumpFpReg)
+            {
+                size += BinaryCycleBuilder::GetEncodedNodeSize(regOverhead + sizeof(NodeFpReg));
+            }
+            if (m_Config.enableDumpHostIo)
+            {
+                size += BinaryCycleBuilder::GetEncodedNodeSize(sizeof(NodeIo));
+            }
+        }
+
+        for (size_t i = 0; i < record.eventCount; i++)
         {
+            const auto& event = record.GetEvent(i);
+
             if (std::holds_alternative<trace::OpEvent>(event))
             {
-                m_pCurrentCycle->Add(std::get<trace::OpEvent>(event));
+                size += BinaryCycleBuilder::GetEncodedNodeSize(sizeof(OpEvent));
             }
             if (std::holds_alternative<trace::TrapEvent>(event))
             {
-                m_pCurrentCycle->Add(std::get<trace::TrapEvent>(event));
+                size += BinaryCycleBuilder::GetEncodedNodeSize(sizeof(TrapEvent));
             }
             if (std::holds_alternative<trace::MemoryEvent>(event))
             {
-                m_pCurrentCycle->Add(std::get<trace::MemoryEvent>(event));
+                size += BinaryCycleBuilder::GetEncodedNodeSize(sizeof(MemoryEvent));
             }
         }
+
+        return size;
     }
 
-    void EndCycle()
+    void Encode(const CycleRecord& record)
     {
-        if (!m_Config.enabled)
+        const auto size = GetEncodedSize(record);
+
+        m_Builder.Reset(m_pTraceWriter->Reserve(size), size, record.cycle, m_XLEN, record.pc);
+
+        // Readers reconstruct registers from delta nodes cycle by cycle from the beginning of a segment.
+        const bool keyframe = !m_Config.enableRegDelta
+            || !m_PreviousStateValid
+            || m_CyclesSinceKeyframe >= m_Config.keyframeInterval
+            || m_pTraceWriter->IsSegmentEmpty();
+
+        if (record.stateRecorded)
         {
-            return;
+            if (m_Config.enableDumpIntReg)
+            {
+                if (m_XLEN == XLEN::XLEN32)
+                {
+                    if (keyframe)
+                    {
+                        m_Builder.Add(record.intReg.rv32);
+                    }
+                    else
+                    {
+                        m_Builder.AddDelta(record.intReg.rv32, m_PreviousIntReg.rv32);
+                    }
+                }
+                else
+                {
+                    if (keyframe)
+                    {
+                        m_Builder.Add(record.intReg.rv64);
+                    }
+                    else
+                    {
+                        m_Builder.AddDelta(record.intReg.rv64, m_PreviousIntReg.rv64);
+                    }
+                }
+            }
+
+            if (m_Config.enableDumpFpReg)
+            {
+                if (keyframe)
+                {
+                    m_Builder.Add(record.fpReg);
+                }
+                else
+                {
+                    m_Builder.AddDelta(record.fpReg, m_PreviousFpReg);
+                }
+            }
+
+            if (m_Config.enableDumpHostIo)
+            {
+                m_Builder.Add(record.io);
+            }
         }
 
-        m_pCurrentCycle->Break();
+        for (size_t i = 0; i < record.eventCount; i++)
+        {
+            const auto& event = record.GetEvent(i);
 
-        m_pTraceWriter->Write(m_pCurrentCycle->GetData(), m_pCurrentCycle->GetDataSize());
+            if (std::holds_alternative<trace::OpEvent>(event))
+            {
+                m_Builder.Add(std::get<trace::OpEvent>(event));
+            }
+            if (std::holds_alternative<trace::TrapEvent>(event))
+            {
+                m_Builder.Add(std::get<trace::TrapEvent>(event));
+            }
+            if (std::holds_alternative<trace::MemoryEvent>(event))
+            {
+                m_Builder.Add(std::get<trace::MemoryEvent>(event));
+            }
+        }
 
-        delete m_pCurrentCycle;
-        m_pCurrentCycle = nullptr;
+        m_Builder.Break();
+
+        m_pTraceWriter->Commit(m_Builder.GetDataSize());
+
+        if (m_Config.enableRegDelta)
+        {
+            m_PreviousStateValid = record.stateRecorded;
+            m_CyclesSinceKeyframe = keyframe ? 1 : m_CyclesSinceKeyframe + 1;
+
+            if (record.stateRecorded)
+            {
+                m_PreviousIntReg = record.intReg;
+                m_PreviousFpReg = record.fpReg;
+            }
+        }
+    }
+
+    // Rethrows an exception of the encoder thread (e.g. failure to open data file) on the emulation thread.
+    void CheckEncoderError()
+    {
+        if (m_EncoderFailed.load(std::memory_order_acquire))
+        {
+            std::rethrow_exception(m_EncoderError);
+        }
     }
 
-private:
     XLEN m_XLEN;
     const trace::LoggerConfig& m_Config;
     const trace::ILoggerTarget* m_pLoggerTarget {nullptr};
 
-    trace::ITraceWriter* m_pTraceWriter {nullptr};
-    trace::BinaryCycleBuilder* m_pCurrentCycle {nullptr};
+    trace::IBufferedTraceWriter* m_pTraceWriter {nullptr};
+    SpscRing<CycleRecord>* m_pRing {nullptr};
+    CycleRecord* m_pCurrentCycle {nullptr};
+
+    // Used only by the encoder thread
+    BinaryCycleBuilder m_Builder;
+    decltype(CycleRecord::intReg) m_PreviousIntReg;
+    NodeFpReg m_PreviousFpReg;
+    bool m_PreviousStateValid {false};
+    int m_CyclesSinceKeyframe {0};
+
+    std::thread m_EncoderThread;
+    std::atomic<bool> m_Stop {false};
+    std::atomic<bool> m_EncoderFailed {false};
+    std::exception_ptr m_EncoderError;
 };
 
 Logger::Logger(XLEN xlen, const trace::LoggerConfig& config, const trace::ILoggerTarget* pSystem)
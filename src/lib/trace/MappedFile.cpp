@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <rafi/trace.h>
+
+#include "MappedFile.h"
+
+namespace rafi { namespace trace {
+
+namespace {
+    // Size of the head of file which is prefetched on open.
+    const size_t InitialReadAheadSize = 4 * 1024 * 1024;
+}
+
+#if defined(WIN32)
+
+MappedFile::MappedFile(const char* path)
+{
+    m_hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_hFile == INVALID_HANDLE_VALUE)
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_hFile, &fileSize) || static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+    {
+        CloseHandle(m_hFile);
+        throw FileOpenFailureException(path);
+    }
+
+    m_Size = static_cast<size_t>(fileSize.QuadPart);
+    if (m_Size == 0)
+    {
+        return;
+    }
+
+    m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_hMapping != nullptr)
+    {
+        m_pData = MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+    }
+
+    if (m_pData == nullptr)
+    {
+        if (m_hMapping != nullptr)
+        {
+            CloseHandle(m_hMapping);
+        }
+        CloseHandle(m_hFile);
+        throw FileOpenFailureException(path);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_pData != nullptr)
+    {
+        UnmapViewOfFile(m_pData);
+    }
+    if (m_hMapping != nullptr)
+    {
+        CloseHandle(m_hMapping);
+    }
+    CloseHandle(m_hFile);
+}
+
+void MappedFile::WillNeed(size_t, size_t) const
+{
+}
+
+size_t MappedFile::GetFileSize(const char* path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    const auto size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    if (size > SIZE_MAX)
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    return static_cast<size_t>(size);
+}
+
+#else
+
+MappedFile::MappedFile(const char* path)
+{
+    m_Fd = open(path, O_RDONLY);
+    if (m_Fd < 0)
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    struct stat st;
+    if (fstat(m_Fd, &st) != 0 || static_cast<uintmax_t>(st.st_size) > SIZE_MAX)
+    {
+        close(m_Fd);
+        throw FileOpenFailureException(path);
+    }
+
+    m_Size = static_cast<size_t>(st.st_size);
+    if (m_Size == 0)
+    {
+        return;
+    }
+
+    auto pData = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_Fd, 0);
+    if (pData == MAP_FAILED)
+    {
+        close(m_Fd);
+        throw FileOpenFailureException(path);
+    }
+
+    m_pData = pData;
+
+    // Traces are mostly read from head to tail. Let the kernel read ahead aggressively and drop pages behind.
+    madvise(m_pData, m_Size, MADV_SEQUENTIAL);
+    WillNeed(0, InitialReadAheadSize);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_pData != nullptr)
+    {
+        munmap(m_pData, m_Size);
+    }
+    close(m_Fd);
+}
+
+void MappedFile::WillNeed(size_t offset, size_t size) const
+{
+    if (m_pData == nullptr || offset >= m_Size)
+    {
+        return;
+    }
+
+    // madvise requires page aligned address.
+    const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const auto begin = offset / pageSize * pageSize;
+    const auto end = size < m_Size - offset ? offset + size : m_Size;
+
+    madvise(static_cast<char*>(m_pData) + begin, end - begin, MADV_WILLNEED);
+}
+
+size_t MappedFile::GetFileSize(const char* path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0 || static_cast<uintmax_t>(st.st_size) > SIZE_MAX)
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    return static_cast<size_t>(st.st_size);
+}
+
+#endif
+
+const void* MappedFile::GetData() const
+{
+    return m_pData;
+}
+
+size_t MappedFile::GetSize() const
+{
+    return m_Size;
+}
+
+}}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace rafi { namespace trace {
+
+// Read-only memory mapping of a whole file.
+// Pages are read on demand, so opening a file is constant time and resident memory is proportional to pages touched.
+class MappedFile final
+{
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+    explicit MappedFile(const char* path);
+    ~MappedFile();
+
+    // Returns the size of the file without opening or mapping it.
+    static size_t GetFileSize(const char* path);
+
+    // Returns nullptr if the file is empty.
+    const void* GetData() const;
+    size_t GetSize() const;
+
+    // Hints that the specified range is accessed soon. Ignored on platforms without madvise.
+    void WillNeed(size_t offset, size_t size) const;
+
+private:
+    void* m_pData{ nullptr };
+    size_t m_Size{ 0 };
+
+#if defined(WIN32)
+    void* m_hFile;
+    void* m_hMapping{ nullptr };
+#else
+    int m_Fd;
+#endif
+};
+
+}}
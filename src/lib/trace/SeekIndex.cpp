@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <rafi/trace.h>
+
+#include "BinaryCycle.h"
+#include "MappedFile.h"
+#include "SeekIndex.h"
+
+namespace rafi { namespace trace {
+
+std::string SeekIndex::GetPath(const char* indexPath)
+{
+    const std::string path(indexPath);
+
+    if (IsTraceIndexPath(path))
+    {
+        return path.substr(0, path.size() - std::strlen(".tidx")) + ".tseek";
+    }
+    else
+    {
+        return path + ".tseek";
+    }
+}
+
+bool SeekIndex::IsDue(uint64_t cycle) const
+{
+    return m_Entries.empty() || cycle >= m_Entries.back().cycle + SeekIndexInterval;
+}
+
+void SeekIndex::Add(uint64_t cycle, uint32_t fileIndex, uint64_t offset)
+{
+    m_Entries.push_back(SeekIndexEntry { cycle, fileIndex, 0, offset });
+}
+
+void SeekIndex::AddDataFile(const char* path, uint64_t firstCycle, uint32_t fileIndex)
+{
+    const MappedFile file(path);
+
+    const auto p = static_cast<const uint8_t*>(file.GetData());
+    auto cycle = firstCycle;
+
+    for (size_t offset = 0; offset < file.GetSize(); cycle++)
+    {
+        bool hasDelta;
+        const auto size = BinaryCycle::Scan(p + offset, file.GetSize() - offset, &hasDelta);
+
+        if (!hasDelta && IsDue(cycle))
+        {
+            Add(cycle, fileIndex, offset);
+        }
+
+        offset += size;
+    }
+}
+
+const SeekIndexEntry* SeekIndex::Find(uint64_t cycle) const
+{
+    const auto it = std::upper_bound(m_Entries.begin(), m_Entries.end(), cycle,
+        [](uint64_t value, const SeekIndexEntry& entry) { return value < entry.cycle; });
+
+    return it == m_Entries.begin() ? nullptr : &*(it - 1);
+}
+
+bool SeekIndex::Load(const char* path, uint64_t totalCycleCount, const std::vector<uint64_t>& fileSizes)
+{
+    auto fp = std::fopen(path, "rb");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+
+    SeekIndexHeader header;
+
+    const auto valid = std::fread(&header, sizeof(header), 1, fp) == 1
+        && std::memcmp(header.magic, SeekIndexMagic, sizeof(SeekIndexMagic)) == 0
+        && header.version == SeekIndexVersion
+        && header.totalCycleCount == totalCycleCount
+        && header.fileCount == fileSizes.size()
+        && header.entryCount <= totalCycleCount;
+
+    if (!valid)
+    {
+        std::fclose(fp);
+        return false;
+    }
+
+    std::vector<uint64_t> savedFileSizes(fileSizes.size());
+
+    const auto sizeMatched = savedFileSizes.empty()
+        || (std::fread(savedFileSizes.data(), sizeof(uint64_t) * savedFileSizes.size(), 1, fp) == 1 && savedFileSizes == fileSizes);
+
+    if (!sizeMatched)
+    {
+        std::fclose(fp);
+        return false;
+    }
+
+    m_Entries.resize(static_cast<size_t>(header.entryCount));
+
+    const auto n = m_Entries.empty() ? 1 : std::fread(m_Entries.data(), sizeof(SeekIndexEntry) * m_Entries.size(), 1, fp);
+    std::fclose(fp);
+
+    const auto broken = n != 1 || std::any_of(m_Entries.begin(), m_Entries.end(),
+        [&](const SeekIndexEntry& entry) { return entry.fileIndex >= fileSizes.size() || entry.offset >= fileSizes[entry.fileIndex] || entry.cycle >= totalCycleCount; });
+
+    if (broken)
+    {
+        m_Entries.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void SeekIndex::Save(const char* path, uint64_t totalCycleCount, const std::vector<uint64_t>& fileSizes) const
+{
+    auto fp = std::fopen(path, "wb");
+    if (fp == nullptr)
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    SeekIndexHeader header;
+
+    std::memcpy(header.magic, SeekIndexMagic, sizeof(SeekIndexMagic));
+    header.version = SeekIndexVersion;
+    header.interval = SeekIndexInterval;
+    header.entryCount = m_Entries.size();
+    header.totalCycleCount = totalCycleCount;
+    header.fileCount = fileSizes.size();
+
+    std::fwrite(&header, sizeof(header), 1, fp);
+    if (!fileSizes.empty())
+    {
+        std::fwrite(fileSizes.data(), sizeof(uint64_t) * fileSizes.size(), 1, fp);
+    }
+    if (!m_Entries.empty())
+    {
+        std::fwrite(m_Entries.data(), sizeof(SeekIndexEntry) * m_Entries.size(), 1, fp);
+    }
+
+    std::fclose(fp);
+}
+
+}}
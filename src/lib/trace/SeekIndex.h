@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rafi { namespace trace {
+
+// Layout of seek index file (.tseek), which is placed next to .tidx
+//   SeekIndexHeader
+//   uint64_t x fileCount (size of each data file)
+//   SeekIndexEntry x entryCount
+// An entry is recorded at most every SeekIndexInterval cycles, and only at cycles without delta nodes
+// so that the reader can start parsing there. totalCycleCount and data file sizes are compared with the trace
+// to detect stale index, e.g. of a trace regenerated with the same cycle counts by a writer without seek index.
+
+const char SeekIndexMagic[8] = { 'R', 'A', 'F', 'I', 'T', 'S', 'K', '\0' };
+const uint32_t SeekIndexVersion = 2;
+const uint32_t SeekIndexInterval = 4096;
+
+struct SeekIndexHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t interval;
+    uint64_t entryCount;
+    uint64_t totalCycleCount;
+    uint64_t fileCount;
+};
+
+struct SeekIndexEntry
+{
+    uint64_t cycle;
+    uint32_t fileIndex;
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+class SeekIndex final
+{
+public:
+    // Returns path of seek index for the specified .tidx path.
+    static std::string GetPath(const char* indexPath);
+
+    // Returns true if an entry should be recorded at the specified cycle.
+    bool IsDue(uint64_t cycle) const;
+
+    void Add(uint64_t cycle, uint32_t fileIndex, uint64_t offset);
+
+    // Records entries of a data file by walking node headers of its cycles.
+    void AddDataFile(const char* path, uint64_t firstCycle, uint32_t fileIndex);
+
+    // Returns the last entry at or before the specified cycle, or nullptr if there is none.
+    const SeekIndexEntry* Find(uint64_t cycle) const;
+
+    // Returns false if the file does not exist or it does not match totalCycleCount and fileSizes.
+    bool Load(const char* path, uint64_t totalCycleCount, const std::vector<uint64_t>& fileSizes);
+    void Save(const char* path, uint64_t totalCycleCount, const std::vector<uint64_t>& fileSizes) const;
+
+private:
+    std::vector<SeekIndexEntry> m_Entries;
+};
+
+}}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace rafi { namespace trace {
+
+// Lock-free ring buffer for a single producer thread and a single consumer thread.
+// Producer fills the slot returned by GetBack() in place and publishes it by PushBack().
+// Consumer reads the slot returned by GetFront() in place and frees it by PopFront().
+template <typename T>
+class SpscRing final
+{
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+public:
+    explicit SpscRing(size_t capacity)
+        : m_Slots(capacity)
+    {
+    }
+
+    size_t GetCapacity() const
+    {
+        return m_Slots.size();
+    }
+
+    // Returns nullptr if the ring is full.
+    T* GetBack()
+    {
+        const auto tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_Head.load(std::memory_order_acquire) == m_Slots.size())
+        {
+            return nullptr;
+        }
+
+        return &m_Slots[tail % m_Slots.size()];
+    }
+
+    void PushBack()
+    {
+        m_Tail.store(m_Tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Returns nullptr if the ring is empty.
+    const T* GetFront() const
+    {
+        const auto head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_Tail.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return &m_Slots[head % m_Slots.size()];
+    }
+
+    void PopFront()
+    {
+        m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> m_Slots;
+
+    // Indices grow monotonically and are wrapped on access. Each one is written by only one side.
+    alignas(64) std::atomic<size_t> m_Head {0};
+    alignas(64) std::atomic<size_t> m_Tail {0};
+};
+
+// Waiting strategy for the side which finds SpscRing full or empty.
+// Yields a while to catch up with a busy peer, and then sleeps for a growing period not to burn an idle core.
+class RingBackoff final
+{
+public:
+    void Wait()
+    {
+        if (m_Count < SpinCount)
+        {
+            m_Count++;
+            std::this_thread::yield();
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(m_SleepMicroseconds));
+
+        if (m_SleepMicroseconds < MaxSleepMicroseconds)
+        {
+            m_SleepMicroseconds *= 2;
+        }
+    }
+
+    void Reset()
+    {
+        m_Count = 0;
+        m_SleepMicroseconds = MinSleepMicroseconds;
+    }
+
+private:
+    static const int SpinCount = 64;
+    static const int MinSleepMicroseconds = 16;
+    static const int MaxSleepMicroseconds = 1024;
+
+    int m_Count {0};
+    int m_SleepMicroseconds {MinSleepMicroseconds};
+};
+
+}}
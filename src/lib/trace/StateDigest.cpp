@@ -0,0 +1,170 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <rafi/trace.h>
+
+namespace rafi { namespace trace {
+
+namespace {
+    const uint64_t DigestSeed = 0x9e3779b97f4a7c15;
+
+    // One round of splitmix64 finalizer, which is enough to make a single bit flip change the whole digest.
+    uint64_t Mix(uint64_t hash, uint64_t value)
+    {
+        hash ^= value;
+        hash *= 0xbf58476d1ce4e5b9;
+        hash ^= hash >> 31;
+        return hash;
+    }
+}
+
+void StateDigest::UpdateMemory(uint64_t address, const void* pPage, size_t size)
+{
+    const auto p = static_cast<const uint8_t*>(pPage);
+
+    auto hash = Mix(DigestSeed, address);
+
+    for (size_t offset = 0; offset < size; offset += sizeof(uint64_t))
+    {
+        uint64_t value = 0;
+        std::memcpy(&value, &p[offset], std::min(sizeof(uint64_t), size - offset));
+
+        hash = Mix(hash, value);
+    }
+
+    m_MemoryHash = Mix(m_MemoryHash, hash);
+}
+
+uint64_t StateDigest::Compute(XLEN xlen, const ILoggerTarget& target) const
+{
+    auto hash = Mix(DigestSeed, target.GetPc());
+
+    if (xlen == XLEN::XLEN32)
+    {
+        NodeIntReg32 intReg;
+        target.CopyIntReg(&intReg);
+
+        for (const auto value: intReg.regs)
+        {
+            hash = Mix(hash, value);
+        }
+    }
+    else
+    {
+        NodeIntReg64 intReg;
+        target.CopyIntReg(&intReg);
+
+        for (const auto value: intReg.regs)
+        {
+            hash = Mix(hash, value);
+        }
+    }
+
+    NodeFpReg fpReg;
+    target.CopyFpReg(&fpReg);
+
+    for (const auto& reg: fpReg.regs)
+    {
+        hash = Mix(hash, reg.u64.value);
+    }
+
+    return Mix(hash, m_MemoryHash);
+}
+
+StateDigestWriter::StateDigestWriter(const char* path, uint32_t interval)
+{
+    m_pFile = std::fopen(path, "wb");
+    if (m_pFile == nullptr)
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    StateDigestHeader header;
+
+    std::memcpy(header.magic, StateDigestMagic, sizeof(StateDigestMagic));
+    header.version = StateDigestVersion;
+    header.interval = interval;
+
+    std::fwrite(&header, sizeof(header), 1, m_pFile);
+    std::fflush(m_pFile);
+}
+
+StateDigestWriter::~StateDigestWriter()
+{
+    std::fclose(m_pFile);
+}
+
+void StateDigestWriter::Write(uint64_t cycle, uint64_t digest)
+{
+    const StateDigestEntry entry { cycle, digest };
+
+    std::fwrite(&entry, sizeof(entry), 1, m_pFile);
+
+    // Entries are written at most once per interval, so flushing each of them is cheap.
+    std::fflush(m_pFile);
+}
+
+StateDigestReader::StateDigestReader(const char* path)
+{
+    auto fp = std::fopen(path, "rb");
+    if (fp == nullptr)
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    StateDigestHeader header;
+
+    const auto valid = std::fread(&header, sizeof(header), 1, fp) == 1
+        && std::memcmp(header.magic, StateDigestMagic, sizeof(StateDigestMagic)) == 0
+        && header.version == StateDigestVersion
+        && header.interval > 0;
+
+    if (!valid)
+    {
+        std::fclose(fp);
+        throw TraceException("Invalid state digest file header.");
+    }
+
+    m_Interval = header.interval;
+
+    StateDigestEntry entry;
+    while (std::fread(&entry, sizeof(entry), 1, fp) == 1)
+    {
+        m_Entries.push_back(entry);
+    }
+
+    std::fclose(fp);
+}
+
+uint32_t StateDigestReader::GetInterval() const
+{
+    return m_Interval;
+}
+
+size_t StateDigestReader::GetCount() const
+{
+    return m_Entries.size();
+}
+
+const StateDigestEntry& StateDigestReader::Get(size_t index) const
+{
+    return m_Entries[index];
+}
+
+}}
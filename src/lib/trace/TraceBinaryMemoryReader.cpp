@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 
@@ -32,17 +33,12 @@ public:
     {
         CheckBufferSize();
 
-        m_pCycle = BinaryCycle::Parse(m_pBuffer, m_BufferSize);
-    }
-
-    ~TraceBinaryMemoryReaderImpl()
-    {
-        m_pCycle = nullptr;
+        ParseCycle(nullptr);
     }
 
     const ICycle* GetCycle() const
     {
-        return m_pCycle.get();
+        return m_pCycle;
     }
 
     bool IsEnd() const
@@ -58,7 +54,7 @@ public:
 
         if (!IsEnd())
         {
-            m_pCycle = BinaryCycle::Parse(reinterpret_cast<const uint8_t*>(m_pBuffer) + m_Offset, m_BufferSize - m_Offset);
+            ParseCycle(m_pCycle);
         }
         else
         {
@@ -66,7 +62,139 @@ public:
         }
     }
 
+    void Next(uint32_t cycle)
+    {
+        if (cycle == 0)
+        {
+            return;
+        }
+
+        // Skip cycles by walking node headers. Cycles with delta nodes depend on previous cycles,
+        // so parsing restarts from the last skipped cycle without delta nodes, or from current cycle if there is none.
+        const auto p = reinterpret_cast<const uint8_t*>(m_pBuffer);
+
+        auto offset = m_Offset + m_pCycle->GetSize();
+        auto restartOffset = m_Offset;
+        uint32_t restartIndex = 0;
+
+        for (uint32_t i = 1; i <= cycle; i++)
+        {
+            if (offset == m_BufferSize)
+            {
+                if (i != cycle)
+                {
+                    throw TraceException("Failed to skip specified cycles in TraceBinaryMemoryReaderImpl::Next()");
+                }
+
+                m_Offset = m_BufferSize;
+                m_pCycle = nullptr;
+                return;
+            }
+
+            bool hasDelta;
+            const auto size = BinaryCycle::Scan(p + offset, m_BufferSize - offset, &hasDelta);
+
+            if (!hasDelta)
+            {
+                restartOffset = offset;
+                restartIndex = i;
+            }
+
+            offset += size;
+        }
+
+        if (restartIndex > 0)
+        {
+            MoveToOffset(restartOffset);
+        }
+
+        for (uint32_t i = restartIndex; i < cycle; i++)
+        {
+            Next();
+        }
+    }
+
+    size_t ReadBatch(CycleBatch* pBatch, size_t maxCycleCount)
+    {
+        if (IsEnd())
+        {
+            return 0;
+        }
+
+        const auto p = reinterpret_cast<const uint8_t*>(m_pBuffer);
+        const auto maxCount = std::min(maxCycleCount, static_cast<size_t>(UINT32_MAX));
+
+        // Track the restart point as Next(uint32_t) does, so that cycles are not walked twice.
+        auto offset = m_Offset;
+        auto restartOffset = m_Offset;
+        size_t restartIndex = 0;
+        size_t count = 0;
+
+        for (; count < maxCount && offset < m_BufferSize; count++)
+        {
+            bool hasDelta;
+            const auto size = BinaryCycle::AddToBatch(p + offset, m_BufferSize - offset, pBatch, &hasDelta);
+
+            if (count > 0 && !hasDelta)
+            {
+                restartOffset = offset;
+                restartIndex = count;
+            }
+
+            offset += size;
+        }
+
+        if (offset == m_BufferSize)
+        {
+            m_Offset = m_BufferSize;
+            m_pCycle = nullptr;
+            return count;
+        }
+
+        // Registers are reconstructed only for the cycle where the reader stops.
+        bool hasDelta;
+        BinaryCycle::Scan(p + offset, m_BufferSize - offset, &hasDelta);
+
+        if (!hasDelta)
+        {
+            MoveToOffset(offset);
+            return count;
+        }
+
+        if (restartIndex > 0)
+        {
+            MoveToOffset(restartOffset);
+        }
+
+        for (size_t i = restartIndex; i < count; i++)
+        {
+            Next();
+        }
+
+        return count;
+    }
+
+    void MoveToOffset(size_t offset)
+    {
+        if (offset >= m_BufferSize)
+        {
+            throw TraceException("argument 'offset' is out-of-range.", static_cast<int64_t>(offset));
+        }
+
+        m_Offset = offset;
+        ParseCycle(nullptr);
+    }
+
 private:
+    // Parses the cycle at m_Offset into the view which is not used by pPrevious.
+    void ParseCycle(const BinaryCycle* pPrevious)
+    {
+        auto pCycle = pPrevious == &m_Cycles[0] ? &m_Cycles[1] : &m_Cycles[0];
+
+        pCycle->Parse(reinterpret_cast<const uint8_t*>(m_pBuffer) + m_Offset, m_BufferSize - m_Offset, pPrevious);
+        m_pCycle = pCycle;
+    }
+
     void CheckBufferSize() const
     {
         if (m_BufferSize < sizeof(NodeHeader))
@@ -86,7 +214,10 @@ private:
     const void* m_pBuffer{ nullptr };
     size_t m_BufferSize{ 0 };
     size_t m_Offset{ 0 };
-    std::unique_ptr<BinaryCycle> m_pCycle{ nullptr };
+
+    // Views are reused alternately, so that the previous cycle is available for delta nodes without allocation.
+    BinaryCycle m_Cycles[2];
+    BinaryCycle* m_pCycle{ nullptr };
 };
 
 TraceBinaryMemoryReader::TraceBinaryMemoryReader(const void* buffer, size_t bufferSize)
@@ -116,10 +247,17 @@ void TraceBinaryMemoryReader::Next()
 
 void TraceBinaryMemoryReader::Next(uint32_t cycle)
 {
-    for (uint32_t i = 0; i < cycle; i++)
-    {
-        Next();
-    }
+    m_pImpl->Next(cycle);
+}
+
+size_t TraceBinaryMemoryReader::ReadBatch(CycleBatch* pBatch, size_t maxCycleCount)
+{
+    return m_pImpl->ReadBatch(pBatch, maxCycleCount);
+}
+
+void TraceBinaryMemoryReader::MoveToOffset(size_t offset)
+{
+    m_pImpl->MoveToOffset(offset);
 }
 
 }}
@@ -14,86 +14,31 @@
  * limitations under the License.
  */
 
-#include <cstdlib>
-
-#include <rafi/trace.h>
-
-#include "BinaryCycle.h"
-
-#if defined(__GNUC__)
-#include <experimental/filesystem>
-#else
-#include <filesystem>
-#endif
-
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 
 #include <rafi/trace.h>
 
-#if defined(__GNUC__)
-namespace fs = std::experimental::filesystem;
-#else
-namespace fs = std::filesystem;
-#endif
+#include "MappedFile.h"
 
 namespace rafi { namespace trace {
 
+namespace {
+    // Size of the range which is prefetched after MoveToOffset().
+    const size_t SeekReadAheadSize = 4 * 1024 * 1024;
+}
+
 class TraceBinaryReaderImpl final
 {
 public:
+    // The file is mapped and cycles are parsed in place, so nothing is read until it is touched.
     TraceBinaryReaderImpl(const char* path)
+        : m_File(path)
     {
-        uintmax_t fileSize;
-
-        try
-        {
-            fileSize = fs::file_size(path);
-        }
-        catch (fs::filesystem_error&)
-        {
-            throw FileOpenFailureException(path);
-        }
-
-    #if UINTMAX_MAX > SIZE_MAX
-        if (fileSize > SIZE_MAX)
-        {
-            throw FileOpenFailureException(path);
-        }
-    #endif
-
-        if (fileSize > 0)
-        {
-            m_pBuffer = malloc(fileSize);
-            if (m_pBuffer == nullptr)
-            {
-                throw TraceException("Failed to allocate memory.\n");
-            }
-            m_BufferSize = fileSize;
-
-            auto fp = std::fopen(path, "rb");
-
-            auto n = std::fread(m_pBuffer, m_BufferSize, 1, fp);
-            if (n != 1)
-            {
-                throw TraceException("Failed to read file.\n");
-            }
-
-            std::fclose(fp);
-
-            m_pImpl = new TraceBinaryMemoryReader(m_pBuffer, m_BufferSize);
-        }
-    }
-
-    ~TraceBinaryReaderImpl()
-    {
-        if (m_pImpl != nullptr)
+        if (m_File.GetSize() > 0)
         {
-            delete m_pImpl;
-        }
-        if (m_pBuffer != nullptr)
-        {
-            free(m_pBuffer);
+            m_pImpl = std::make_unique<TraceBinaryMemoryReader>(m_File.GetData(), m_File.GetSize());
         }
     }
 
@@ -112,11 +57,26 @@ public:
         m_pImpl->Next();
     }
 
+    void Next(uint32_t cycle)
+    {
+        m_pImpl->Next(cycle);
+    }
+
+    size_t ReadBatch(CycleBatch* pBatch, size_t maxCycleCount)
+    {
+        return m_pImpl == nullptr ? 0 : m_pImpl->ReadBatch(pBatch, maxCycleCount);
+    }
+
+    void MoveToOffset(size_t offset)
+    {
+        m_File.WillNeed(offset, SeekReadAheadSize);
+        m_pImpl->MoveToOffset(offset);
+    }
+
 private:
-    void* m_pBuffer{ nullptr };
-    size_t m_BufferSize{ 0 };
+    MappedFile m_File;
 
-    TraceBinaryMemoryReader* m_pImpl;
+    std::unique_ptr<TraceBinaryMemoryReader> m_pImpl;
 };
 
 TraceBinaryReader::TraceBinaryReader(const char* path)
@@ -146,10 +106,17 @@ void TraceBinaryReader::Next()
 
 void TraceBinaryReader::Next(uint32_t cycle)
 {
-    for (uint32_t i = 0; i < cycle; i++)
-    {
-        Next();
-    }
+    m_pImpl->Next(cycle);
+}
+
+size_t TraceBinaryReader::ReadBatch(CycleBatch* pBatch, size_t maxCycleCount)
+{
+    return m_pImpl->ReadBatch(pBatch, maxCycleCount);
+}
+
+void TraceBinaryReader::MoveToOffset(size_t offset)
+{
+    m_pImpl->MoveToOffset(offset);
 }
 
 }}
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <rafi/trace.h>
+
+#include "CompressedTrace.h"
+
+namespace rafi { namespace trace {
+
+class TraceCompressedReaderImpl final
+{
+public:
+    explicit TraceCompressedReaderImpl(const char* path)
+        : m_PrefetchCount(std::max(static_cast<size_t>(std::thread::hardware_concurrency()), MinPrefetchCount))
+    {
+        m_pFile = std::fopen(path, "rb");
+        if (m_pFile == nullptr)
+        {
+            throw FileOpenFailureException(path);
+        }
+
+        ParseIndex();
+
+        if (!m_Entries.empty())
+        {
+            LoadBlock(0);
+        }
+    }
+
+    ~TraceCompressedReaderImpl()
+    {
+        // Wait for workers before releasing the file.
+        m_Prefetches.clear();
+
+        std::fclose(m_pFile);
+    }
+
+    const ICycle* GetCycle() const
+    {
+        return m_pReader ? m_pReader->GetCycle() : nullptr;
+    }
+
+    bool IsEnd() const
+    {
+        return m_BlockIndex >= m_Entries.size();
+    }
+
+    void Next()
+    {
+        m_pReader->Next();
+        m_Cycle++;
+
+        if (!m_pReader->IsEnd())
+        {
+            return;
+        }
+
+        m_BlockIndex++;
+        if (m_BlockIndex == m_Entries.size())
+        {
+            m_pReader = nullptr;
+            return;
+        }
+
+        LoadBlock(m_BlockIndex);
+    }
+
+    void Next(uint32_t cycle)
+    {
+        const auto dstCycle = m_Cycle + cycle;
+
+        // Find the last block which begins at or before dstCycle.
+        const auto it = std::upper_bound(m_Entries.begin(), m_Entries.end(), dstCycle, [](uint64_t value, const CompressedTraceBlockEntry& entry)
+        {
+            return value < entry.firstCycle;
+        });
+
+        if (it == m_Entries.begin() || dstCycle >= (it - 1)->firstCycle + (it - 1)->cycleCount)
+        {
+            throw TraceException("Failed to skip specified cycles in TraceCompressedReaderImpl::Next()");
+        }
+
+        const auto blockIndex = static_cast<size_t>(it - m_Entries.begin() - 1);
+
+        if (blockIndex != m_BlockIndex)
+        {
+            m_BlockIndex = blockIndex;
+            m_Cycle = m_Entries[blockIndex].firstCycle;
+            LoadBlock(blockIndex);
+        }
+
+        while (m_Cycle < dstCycle)
+        {
+            m_pReader->Next();
+            m_Cycle++;
+        }
+    }
+
+    size_t ReadBatch(CycleBatch* pBatch, size_t maxCycleCount)
+    {
+        size_t count = 0;
+
+        while (count < maxCycleCount && !IsEnd())
+        {
+            const auto n = m_pReader->ReadBatch(pBatch, maxCycleCount - count);
+
+            count += n;
+            m_Cycle += n;
+
+            if (!m_pReader->IsEnd())
+            {
+                continue;
+            }
+
+            m_BlockIndex++;
+            if (m_BlockIndex == m_Entries.size())
+            {
+                m_pReader = nullptr;
+                break;
+            }
+
+            LoadBlock(m_BlockIndex);
+        }
+
+        return count;
+    }
+
+private:
+    static constexpr size_t MinPrefetchCount = 2;
+
+    struct Prefetch
+    {
+        size_t blockIndex;
+        std::future<std::vector<char>> raw;
+    };
+
+    void ParseIndex()
+    {
+        CompressedTraceHeader header;
+        CompressedTraceFooter footer;
+
+        if (std::fread(&header, sizeof(header), 1, m_pFile) != 1 || std::memcmp(header.magic, CompressedTraceMagic, sizeof(header.magic)) != 0)
+        {
+            throw TraceException("detect data corruption. (Invalid header of compressed trace)");
+        }
+        if (header.version != CompressedTraceVersion)
+        {
+            throw TraceException("Unsupported version of compressed trace.");
+        }
+
+        if (std::fseek(m_pFile, -static_cast<long>(sizeof(footer)), SEEK_END) != 0
+            || std::fread(&footer, sizeof(footer), 1, m_pFile) != 1
+            || std::memcmp(footer.magic, CompressedTraceMagic, sizeof(footer.magic)) != 0)
+        {
+            throw TraceException("detect data corruption. (Invalid footer of compressed trace)");
+        }
+
+        m_Entries.resize(static_cast<size_t>(footer.blockCount));
+
+        if (SeekFile(footer.indexOffset) != 0
+            || std::fread(m_Entries.data(), sizeof(CompressedTraceBlockEntry), m_Entries.size(), m_pFile) != m_Entries.size())
+        {
+            throw TraceException("detect data corruption. (Invalid block index of compressed trace)");
+        }
+    }
+
+    int SeekFile(uint64_t offset)
+    {
+#if defined(_MSC_VER)
+        return _fseeki64(m_pFile, static_cast<int64_t>(offset), SEEK_SET);
+#else
+        return fseeko(m_pFile, static_cast<off_t>(offset), SEEK_SET);
+#endif
+    }
+
+    // Reads compressed data on the caller thread and decompresses it on a worker thread.
+    std::future<std::vector<char>> StartDecompress(size_t blockIndex)
+    {
+        const auto& entry = m_Entries[blockIndex];
+
+        std::vector<char> compressed(entry.compressedSize);
+
+        if (SeekFile(entry.offset) != 0 || std::fread(compressed.data(), compressed.size(), 1, m_pFile) != 1)
+        {
+            throw TraceException("Failed to read compressed block.", static_cast<int64_t>(entry.offset));
+        }
+
+        return std::async(std::launch::async, [compressed = std::move(compressed), rawSize = entry.rawSize]()
+        {
+            std::vector<char> raw;
+            DecompressBlock(&raw, compressed.data(), compressed.size(), rawSize);
+            return raw;
+        });
+    }
+
+    void LoadBlock(size_t blockIndex)
+    {
+        // Prefetches are valid only for blocks following blockIndex (i.e. sequential read).
+        if (!m_Prefetches.empty() && m_Prefetches.front().blockIndex != blockIndex)
+        {
+            m_Prefetches.clear();
+        }
+
+        std::future<std::vector<char>> raw;
+
+        if (m_Prefetches.empty())
+        {
+            raw = StartDecompress(blockIndex);
+        }
+        else
+        {
+            raw = std::move(m_Prefetches.front().raw);
+            m_Prefetches.pop_front();
+        }
+
+        auto nextIndex = m_Prefetches.empty() ? blockIndex + 1 : m_Prefetches.back().blockIndex + 1;
+        while (m_Prefetches.size() < m_PrefetchCount && nextIndex < m_Entries.size())
+        {
+            m_Prefetches.push_back(Prefetch { nextIndex, StartDecompress(nextIndex) });
+            nextIndex++;
+        }
+
+        m_pReader = nullptr;
+        m_Raw = raw.get();
+        m_pReader = std::make_unique<TraceBinaryMemoryReader>(m_Raw.data(), m_Raw.size());
+    }
+
+    std::FILE* m_pFile{ nullptr };
+    std::vector<CompressedTraceBlockEntry> m_Entries;
+
+    size_t m_PrefetchCount;
+    std::deque<Prefetch> m_Prefetches;
+
+    size_t m_BlockIndex{ 0 };
+    uint64_t m_Cycle{ 0 };
+
+    std::vector<char> m_Raw;
+    std::unique_ptr<TraceBinaryMemoryReader> m_pReader;
+};
+
+TraceCompressedReader::TraceCompressedReader(const char* path)
+{
+    m_pImpl = new TraceCompressedReaderImpl(path);
+}
+
+TraceCompressedReader::~TraceCompressedReader()
+{
+    delete m_pImpl;
+}
+
+const ICycle* TraceCompressedReader::GetCycle() const
+{
+    return m_pImpl->GetCycle();
+}
+
+bool TraceCompressedReader::IsEnd() const
+{
+    return m_pImpl->IsEnd();
+}
+
+void TraceCompressedReader::Next()
+{
+    m_pImpl->Next();
+}
+
+void TraceCompressedReader::Next(uint32_t cycle)
+{
+    m_pImpl->Next(cycle);
+}
+
+size_t TraceCompressedReader::ReadBatch(CycleBatch* pBatch, size_t maxCycleCount)
+{
+    return m_pImpl->ReadBatch(pBatch, maxCycleCount);
+}
+
+}}
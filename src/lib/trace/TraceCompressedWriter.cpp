@@ -0,0 +1,265 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <rafi/trace.h>
+
+#include "CompressedTrace.h"
+
+namespace rafi { namespace trace {
+
+class TraceCompressedWriterImpl final
+{
+public:
+    TraceCompressedWriterImpl(const char* path, size_t blockSize, int threadCount)
+        : m_BlockSize(blockSize)
+        , m_MaxPendingBlockCount(std::max(threadCount, 1))
+        , m_Raw(blockSize)
+    {
+        m_pFile = std::fopen(path, "wb");
+        if (m_pFile == nullptr)
+        {
+            throw FileOpenFailureException(path);
+        }
+
+        CompressedTraceHeader header;
+        std::memcpy(header.magic, CompressedTraceMagic, sizeof(header.magic));
+        header.version = CompressedTraceVersion;
+        header.reserved = 0;
+
+        std::fwrite(&header, sizeof(header), 1, m_pFile);
+        m_Offset = sizeof(header);
+    }
+
+    ~TraceCompressedWriterImpl()
+    {
+        try
+        {
+            if (m_BlockCycleCount > 0)
+            {
+                SubmitBlock();
+            }
+
+            while (!m_PendingBlocks.empty())
+            {
+                WritePendingBlock();
+            }
+        }
+        catch (const TraceException& e)
+        {
+            e.PrintMessage();
+        }
+
+        CompressedTraceFooter footer;
+        footer.indexOffset = m_Offset;
+        footer.blockCount = m_Entries.size();
+        std::memcpy(footer.magic, CompressedTraceMagic, sizeof(footer.magic));
+
+        std::fwrite(m_Entries.data(), sizeof(CompressedTraceBlockEntry), m_Entries.size(), m_pFile);
+        std::fwrite(&footer, sizeof(footer), 1, m_pFile);
+        std::fclose(m_pFile);
+    }
+
+    void Write(void* buffer, int64_t bufferSize)
+    {
+        if (!(0 <= bufferSize && static_cast<uint64_t>(bufferSize) <= SIZE_MAX))
+        {
+            throw TraceException("argument 'size' is out-of-range.");
+        }
+
+        const auto size = static_cast<size_t>(bufferSize);
+
+        std::memcpy(Reserve(size), buffer, size);
+        Commit(size);
+    }
+
+    void* Reserve(size_t size)
+    {
+        if (m_BlockCycleCount > 0 && m_RawSize + size > m_BlockSize)
+        {
+            SubmitBlock();
+        }
+
+        // A cycle larger than block size makes a block by itself.
+        if (m_RawSize + size > m_Raw.size())
+        {
+            m_Raw.resize(m_RawSize + size);
+        }
+
+        m_ReservedSize = size;
+
+        return &m_Raw[m_RawSize];
+    }
+
+    void Commit(size_t size)
+    {
+        if (size > m_ReservedSize)
+        {
+            throw TraceException("argument 'size' is larger than reserved size.");
+        }
+
+        m_RawSize += size;
+        m_BlockCycleCount++;
+        m_ReservedSize = 0;
+    }
+
+    bool IsSegmentEmpty() const
+    {
+        return m_BlockCycleCount == 0;
+    }
+
+private:
+    struct CompressedBlock
+    {
+        std::vector<char> raw;
+        std::vector<char> compressed;
+    };
+
+    struct PendingBlock
+    {
+        uint64_t firstCycle;
+        uint32_t cycleCount;
+        size_t rawSize;
+        std::future<CompressedBlock> result;
+    };
+
+    void SubmitBlock()
+    {
+        if (m_RawSize > UINT32_MAX)
+        {
+            throw TraceException("Block is too large @ TraceCompressedWriter.\n");
+        }
+
+        PendingBlock block;
+        block.firstCycle = m_BlockFirstCycle;
+        block.cycleCount = m_BlockCycleCount;
+        block.rawSize = m_RawSize;
+        block.result = std::async(std::launch::async, [raw = std::move(m_Raw), rawSize = m_RawSize]() mutable
+        {
+            CompressedBlock result;
+            CompressBlock(&result.compressed, raw.data(), rawSize);
+            result.raw = std::move(raw);
+            return result;
+        });
+
+        m_PendingBlocks.push_back(std::move(block));
+
+        // Reuse raw buffers of written blocks.
+        if (m_FreeBuffers.empty())
+        {
+            m_Raw = std::vector<char>(m_BlockSize);
+        }
+        else
+        {
+            m_Raw = std::move(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+        }
+
+        m_BlockFirstCycle += m_BlockCycleCount;
+        m_BlockCycleCount = 0;
+        m_RawSize = 0;
+
+        // Wait for compression if all workers are busy.
+        while (m_PendingBlocks.size() > m_MaxPendingBlockCount)
+        {
+            WritePendingBlock();
+        }
+    }
+
+    // Writes the oldest pending block to keep blocks in order of cycles.
+    void WritePendingBlock()
+    {
+        auto& block = m_PendingBlocks.front();
+        auto result = block.result.get();
+
+        std::fwrite(result.compressed.data(), result.compressed.size(), 1, m_pFile);
+
+        CompressedTraceBlockEntry entry;
+        entry.offset = m_Offset;
+        entry.firstCycle = block.firstCycle;
+        entry.cycleCount = block.cycleCount;
+        entry.compressedSize = static_cast<uint32_t>(result.compressed.size());
+        entry.rawSize = static_cast<uint32_t>(block.rawSize);
+        entry.reserved = 0;
+
+        m_Entries.push_back(entry);
+        m_Offset += result.compressed.size();
+
+        m_FreeBuffers.push_back(std::move(result.raw));
+        m_PendingBlocks.pop_front();
+    }
+
+    std::FILE* m_pFile{ nullptr };
+    uint64_t m_Offset{ 0 };
+
+    size_t m_BlockSize;
+    size_t m_MaxPendingBlockCount;
+
+    // Block being filled
+    std::vector<char> m_Raw;
+    size_t m_RawSize{ 0 };
+    size_t m_ReservedSize{ 0 };
+    uint64_t m_BlockFirstCycle{ 0 };
+    uint32_t m_BlockCycleCount{ 0 };
+
+    std::deque<PendingBlock> m_PendingBlocks;
+    std::vector<std::vector<char>> m_FreeBuffers;
+    std::vector<CompressedTraceBlockEntry> m_Entries;
+};
+
+TraceCompressedWriter::TraceCompressedWriter(const char* path)
+{
+    m_pImpl = new TraceCompressedWriterImpl(path, DefaultBlockSize, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+TraceCompressedWriter::TraceCompressedWriter(const char* path, size_t blockSize, int threadCount)
+{
+    m_pImpl = new TraceCompressedWriterImpl(path, blockSize, threadCount);
+}
+
+TraceCompressedWriter::~TraceCompressedWriter()
+{
+    delete m_pImpl;
+}
+
+void TraceCompressedWriter::Write(void* buffer, int64_t size)
+{
+    m_pImpl->Write(buffer, size);
+}
+
+void* TraceCompressedWriter::Reserve(size_t size)
+{
+    return m_pImpl->Reserve(size);
+}
+
+void TraceCompressedWriter::Commit(size_t size)
+{
+    m_pImpl->Commit(size);
+}
+
+bool TraceCompressedWriter::IsSegmentEmpty() const
+{
+    return m_pImpl->IsSegmentEmpty();
+}
+
+}}
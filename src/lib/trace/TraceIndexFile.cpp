@@ -0,0 +1,185 @@
+/*
+ * Copyright 2018 Akifumi Fujita
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cinttypes>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <rafi/trace.h>
+
+namespace rafi { namespace trace {
+
+namespace {
+    // Fields which a summary must have. paddr and io are omitted if the data file has no such events.
+    const uint32_t SummaryField_Op = 1 << 0;
+    const uint32_t SummaryField_Trap = 1 << 1;
+    const uint32_t SummaryField_Mem = 1 << 2;
+    const uint32_t SummaryField_Cycle = 1 << 3;
+    const uint32_t SummaryField_Pc = 1 << 4;
+    const uint32_t SummaryField_Required = SummaryField_Op | SummaryField_Trap | SummaryField_Mem | SummaryField_Cycle | SummaryField_Pc;
+
+    bool ParseRange(uint64_t* pOutMin, uint64_t* pOutMax, const std::string& value)
+    {
+        const auto delimPos = value.find('-');
+        if (delimPos == std::string::npos)
+        {
+            return false;
+        }
+
+        *pOutMin = std::strtoull(value.substr(0, delimPos).c_str(), nullptr, 16);
+        *pOutMax = std::strtoull(value.substr(delimPos + 1).c_str(), nullptr, 16);
+        return true;
+    }
+
+    // Returns false if the field is malformed. Unknown fields are ignored for forward compatibility.
+    bool ParseSummaryField(TraceFileSummary* pSummary, uint32_t* pFieldMask, const std::string& field)
+    {
+        const auto delimPos = field.find('=');
+        if (delimPos == std::string::npos)
+        {
+            return false;
+        }
+
+        const auto key = field.substr(0, delimPos);
+        const auto value = field.substr(delimPos + 1);
+
+        if (key == "op")
+        {
+            pSummary->opCount = std::strtoull(value.c_str(), nullptr, 10);
+            *pFieldMask |= SummaryField_Op;
+        }
+        else if (key == "trap")
+        {
+            pSummary->trapCount = std::strtoull(value.c_str(), nullptr, 10);
+            *pFieldMask |= SummaryField_Trap;
+        }
+        else if (key == "mem")
+        {
+            pSummary->memoryEventCount = std::strtoull(value.c_str(), nullptr, 10);
+            *pFieldMask |= SummaryField_Mem;
+        }
+        else if (key == "cycle")
+        {
+            if (!ParseRange(&pSummary->firstCycle, &pSummary->lastCycle, value))
+            {
+                return false;
+            }
+
+            *pFieldMask |= SummaryField_Cycle;
+        }
+        else if (key == "pc")
+        {
+            if (!ParseRange(&pSummary->pcMin, &pSummary->pcMax, value))
+            {
+                return false;
+            }
+
+            *pFieldMask |= SummaryField_Pc;
+        }
+        else if (key == "paddr")
+        {
+            return ParseRange(&pSummary->paddrMin, &pSummary->paddrMax, value);
+        }
+        else if (key == "io")
+        {
+            pSummary->hostIo = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 16));
+            pSummary->hasHostIo = true;
+        }
+
+        return true;
+    }
+}
+
+std::vector<TraceIndexEntry> ReadTraceIndexFile(const char* path)
+{
+    auto f = std::ifstream(path);
+
+    if (f.fail())
+    {
+        throw FileOpenFailureException(path);
+    }
+
+    std::vector<TraceIndexEntry> entries;
+    std::string line;
+
+    while (std::getline(f, line))
+    {
+        std::istringstream ss(line);
+        TraceIndexEntry entry;
+
+        if (!(ss >> entry.path))
+        {
+            continue;
+        }
+
+        // A line without cycle count is a data file with no cycles.
+        if (!(ss >> entry.cycleCount))
+        {
+            entry.cycleCount = 0;
+            entries.push_back(entry);
+            continue;
+        }
+
+        std::string field;
+        bool valid = true;
+        uint32_t fieldMask = 0;
+
+        while (ss >> field)
+        {
+            valid = valid && ParseSummaryField(&entry.summary, &fieldMask, field);
+        }
+
+        // Data files without complete summary are never skipped by tools.
+        entry.hasSummary = valid && (fieldMask & SummaryField_Required) == SummaryField_Required;
+        if (!entry.hasSummary)
+        {
+            entry.summary = TraceFileSummary();
+        }
+
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+void WriteTraceIndexEntry(std::FILE* pFile, const TraceIndexEntry& entry)
+{
+    if (!entry.hasSummary)
+    {
+        std::fprintf(pFile, "%s %" PRIu64 "\n", entry.path.c_str(), entry.cycleCount);
+        return;
+    }
+
+    const auto& summary = entry.summary;
+
+    std::fprintf(pFile, "%s %" PRIu64 " op=%" PRIu64 " trap=%" PRIu64 " mem=%" PRIu64 " cycle=%" PRIx64 "-%" PRIx64 " pc=%" PRIx64 "-%" PRIx64,
+        entry.path.c_str(), entry.cycleCount, summary.opCount, summary.trapCount, summary.memoryEventCount,
+        summary.firstCycle, summary.lastCycle, summary.pcMin, summary.pcMax);
+
+    if (summary.memoryEventCount > 0)
+    {
+        std::fprintf(pFile, " paddr=%" PRIx64 "-%" PRIx64, summary.paddrMin, summary.paddrMax);
+    }
+    if (summary.hasHostIo)
+    {
+        std::fprintf(pFile, " io=%" PRIx32, summary.hostIo);
+    }
+
+    std::fprintf(pFile, "\n");
+}
+
+}}
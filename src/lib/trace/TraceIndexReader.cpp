@@ -14,19 +14,25 @@
  * limitations under the License.
  */
 
-#include <fstream>
+#include <deque>
+#include <future>
+#include <memory>
 #include <vector>
 
 #include <rafi/trace.h>
 
 #include "BinaryCycle.h"
+#include "MappedFile.h"
+#include "SeekIndex.h"
 
 namespace rafi { namespace trace {
 
 class TraceIndexReaderImpl final
 {
 public:
-    TraceIndexReaderImpl(const char* path)
+    TraceIndexReaderImpl(const char* path, int prefetchDepth)
+        : m_Path(path)
+        , m_PrefetchDepth(prefetchDepth)
     {
         ParseIndexFile(path);
         UpdateTraceBinary();
@@ -34,11 +40,8 @@ public:
 
     ~TraceIndexReaderImpl()
     {
-        if (m_pTraceBinary != nullptr)
-        {
-            delete m_pTraceBinary;
-            m_pTraceBinary = nullptr;
-        }
+        // Wait for workers before releasing entries.
+        m_Prefetches.clear();
     }
 
     const ICycle* GetCycle() const
@@ -72,83 +75,170 @@ public:
 
     void Next(uint32_t cycle)
     {
-        const auto dstCycle = m_Cycle + cycle;
+        const auto dstCycle = static_cast<uint64_t>(m_Cycle) + cycle;
 
-        int entryIndex = -1;
+        if (dstCycle >= m_TotalCycleCount)
+        {
+            throw TraceException("Failed to skip specified cycles in TraceIndexReaderImpl::Next()");
+        }
 
-        uint32_t skippedCycle = 0;
-        for (int i = 0; i < m_Entries.size(); i++)
+        if (!m_SeekIndexLoaded)
         {
-            if (skippedCycle + m_Entries[i].cycle > dstCycle)
+            LoadSeekIndex();
+        }
+
+        // Jump to the nearest entry only if it is ahead of current position.
+        const auto pEntry = m_SeekIndex.Find(dstCycle);
+        if (pEntry != nullptr && pEntry->cycle > m_Cycle)
+        {
+            if (m_EntryIndex != static_cast<int>(pEntry->fileIndex))
             {
-                entryIndex = i;
-                break;
+                m_EntryIndex = static_cast<int>(pEntry->fileIndex);
+                UpdateTraceBinary();
             }
 
-            skippedCycle += m_Entries[i].cycle;
+            m_pTraceBinary->MoveToOffset(static_cast<size_t>(pEntry->offset));
+            m_Cycle = static_cast<uint32_t>(pEntry->cycle);
         }
 
-        if (entryIndex < 0)
+        // Skip remaining cycles file by file
+        while (m_Cycle < dstCycle)
         {
-            throw TraceException("Failed to skip specified cycles in TraceIndexReaderImpl::Next()");
+            const auto& entry = m_Entries[m_EntryIndex];
+            const auto remaining = entry.firstCycle + entry.cycle - m_Cycle;
+
+            if (dstCycle - m_Cycle < remaining)
+            {
+                m_pTraceBinary->Next(static_cast<uint32_t>(dstCycle - m_Cycle));
+                m_Cycle = static_cast<uint32_t>(dstCycle);
+            }
+            else
+            {
+                m_Cycle += static_cast<uint32_t>(remaining);
+                m_EntryIndex++;
+                UpdateTraceBinary();
+            }
         }
+    }
 
-        m_EntryIndex = entryIndex;
-        m_Cycle = skippedCycle;
-        UpdateTraceBinary();
+    size_t ReadBatch(CycleBatch* pBatch, size_t maxCycleCount)
+    {
+        size_t count = 0;
 
-        for (uint32_t i = skippedCycle; i < dstCycle; i++)
+        while (count < maxCycleCount && !IsEnd())
         {
-            Next();
+            const auto n = m_pTraceBinary->ReadBatch(pBatch, maxCycleCount - count);
+
+            count += n;
+            m_Cycle += static_cast<uint32_t>(n);
+
+            if (!m_pTraceBinary->IsEnd())
+            {
+                continue;
+            }
+
+            m_EntryIndex++;
+            if (m_EntryIndex == m_Entries.size())
+            {
+                break;
+            }
+
+            UpdateTraceBinary();
         }
+
+        return count;
     }
 
 private:
     void ParseIndexFile(const char* path)
     {
-        auto f = std::ifstream(path);
-
-        if (f.fail())
+        for (const auto& indexEntry : ReadTraceIndexFile(path))
         {
-            throw FileOpenFailureException(path);
+            Entry entry;
+            entry.path = indexEntry.path;
+            entry.cycle = static_cast<uint32_t>(indexEntry.cycleCount);
+            entry.firstCycle = m_TotalCycleCount;
+            m_TotalCycleCount += entry.cycle;
+
+            m_Entries.push_back(entry);
         }
+    }
+
+    // Seek index is built from data files if it does not exist or it is stale (e.g. trace written by older version).
+    void LoadSeekIndex()
+    {
+        m_SeekIndexLoaded = true;
 
-        while (!f.eof())
+        const auto path = SeekIndex::GetPath(m_Path.c_str());
+
+        std::vector<uint64_t> fileSizes;
+        for (const auto& entry : m_Entries)
         {
-            Entry entry;
+            fileSizes.push_back(MappedFile::GetFileSize(entry.path.c_str()));
+        }
 
-            f >> entry.path;
-            if (entry.path.empty())
-            {
-                break;
-            }
+        if (m_SeekIndex.Load(path.c_str(), m_TotalCycleCount, fileSizes))
+        {
+            return;
+        }
 
-            if (!f.eof())
-            {
-                f >> entry.cycle;
-            }
-            else
-            {
-                entry.cycle = 0;
-            }
+        for (size_t i = 0; i < m_Entries.size(); i++)
+        {
+            m_SeekIndex.AddDataFile(m_Entries[i].path.c_str(), m_Entries[i].firstCycle, static_cast<uint32_t>(i));
+        }
 
-            m_Entries.push_back(entry);
+        try
+        {
+            m_SeekIndex.Save(path.c_str(), m_TotalCycleCount, fileSizes);
+        }
+        catch (const FileOpenFailureException&)
+        {
+            // Trace directory may be read-only. Index is built again next time.
         }
     }
 
+    // Opens data file on a worker thread, which maps the file and reads its head.
+    std::future<std::unique_ptr<TraceBinaryReader>> StartOpen(int entryIndex)
+    {
+        // Path is passed as pointer to m_Entries because FileOpenFailureException holds the pointer.
+        const auto path = m_Entries[entryIndex].path.c_str();
+
+        return std::async(std::launch::async, [path]()
+        {
+            return std::make_unique<TraceBinaryReader>(path);
+        });
+    }
+
     void UpdateTraceBinary()
     {
-        if (m_pTraceBinary != nullptr)
+        m_pTraceBinary = nullptr;
+
+        if (m_EntryIndex < 0 || m_EntryIndex >= static_cast<int>(m_Entries.size()))
+        {
+            return;
+        }
+
+        // Prefetches are valid only for files following m_EntryIndex (i.e. sequential read).
+        if (!m_Prefetches.empty() && m_Prefetches.front().entryIndex != m_EntryIndex)
         {
-            delete m_pTraceBinary;
-            m_pTraceBinary = nullptr;
+            m_Prefetches.clear();
         }
 
-        if (0 <= m_EntryIndex && m_EntryIndex < m_Entries.size())
+        if (m_Prefetches.empty())
         {
-            const auto path = m_Entries[m_EntryIndex].path;
+            m_pTraceBinary = std::make_unique<TraceBinaryReader>(m_Entries[m_EntryIndex].path.c_str());
+        }
+        else
+        {
+            m_pTraceBinary = m_Prefetches.front().reader.get();
+            m_Prefetches.pop_front();
+        }
 
-            m_pTraceBinary = new TraceBinaryReader(path.c_str());
+        auto nextIndex = m_Prefetches.empty() ? m_EntryIndex + 1 : m_Prefetches.back().entryIndex + 1;
+        while (static_cast<int>(m_Prefetches.size()) < m_PrefetchDepth && nextIndex < static_cast<int>(m_Entries.size()))
+        {
+            m_Prefetches.push_back(Prefetch { nextIndex, StartOpen(nextIndex) });
+            nextIndex++;
         }
     }
 
@@ -156,19 +246,39 @@ private:
     {
         std::string path;
         uint32_t cycle;
+        uint64_t firstCycle;
+    };
+
+    struct Prefetch
+    {
+        int entryIndex;
+        std::future<std::unique_ptr<TraceBinaryReader>> reader;
     };
 
+    std::string m_Path;
     std::vector<Entry> m_Entries;
+    uint64_t m_TotalCycleCount{ 0 };
+
+    SeekIndex m_SeekIndex;
+    bool m_SeekIndexLoaded{ false };
 
     int m_EntryIndex{ 0 }; // current index of m_Entries
     uint32_t m_Cycle{ 0 };
 
-    TraceBinaryReader* m_pTraceBinary{ nullptr };
+    std::unique_ptr<TraceBinaryReader> m_pTraceBinary;
+
+    int m_PrefetchDepth;
+    std::deque<Prefetch> m_Prefetches;
 };
 
 TraceIndexReader::TraceIndexReader(const char* path)
 {
-    m_pImpl = new TraceIndexReaderImpl(path);
+    m_pImpl = new TraceIndexReaderImpl(path, DefaultPrefetchDepth);
+}
+
+TraceIndexReader::TraceIndexReader(const char* path, int prefetchDepth)
+{
+    m_pImpl = new TraceIndexReaderImpl(path, prefetchDepth);
 }
 
 TraceIndexReader::~TraceIndexReader()
@@ -196,4 +306,9 @@ void TraceIndexReader::Next(uint32_t cycle)
     m_pImpl->Next(cycle);
 }
 
+size_t TraceIndexReader::ReadBatch(CycleBatch* pBatch, size_t maxCycleCount)
+{
+    return m_pImpl->ReadBatch(pBatch, maxCycleCount);
+}
+
 }}
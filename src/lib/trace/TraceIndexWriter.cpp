@@ -14,38 +14,88 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include <rafi/trace.h>
 
+#include "BinaryCycle.h"
+#include "SeekIndex.h"
+
 namespace rafi { namespace trace {
 
 class TraceIndexWriterImpl final
 {
 public:
-    explicit TraceIndexWriterImpl(const char* pathBase)
+    TraceIndexWriterImpl(const char* pathBase, size_t bufferSize)
         : m_PathBase(pathBase)
+        , m_ChunkCapacity(std::max(bufferSize / 2, MinChunkCapacity))
     {
         const auto path = std::string(pathBase) + ".tidx";
 
-        m_pData = (char*)std::malloc(MaxFileSize);
-
         m_pIndexFile = std::fopen(path.c_str(), "w");
         if (m_pIndexFile == nullptr)
         {
             throw FileOpenFailureException(path.c_str());
         }
+
+        for (auto& chunk: m_Chunks)
+        {
+            chunk.pData = static_cast<char*>(std::malloc(m_ChunkCapacity));
+        }
+
+        m_WriterThread = std::thread([this] { WriterThreadMain(); });
     }
 
     ~TraceIndexWriterImpl()
     {
-        FlushData();
+        if (m_Chunks[m_FrontChunk].size > 0)
+        {
+            CloseFile(&m_Chunks[m_FrontChunk]);
+
+            try
+            {
+                SubmitChunk();
+            }
+            catch (const FileOpenFailureException& e)
+            {
+                e.PrintMessage();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_ConditionVariable.notify_all();
+        m_WriterThread.join();
 
         std::fclose(m_pIndexFile);
 
-        std::free(m_pData);
+        if (!m_Failed)
+        {
+            const auto path = m_PathBase + ".tseek";
+
+            try
+            {
+                m_SeekIndex.Save(path.c_str(), m_CycleCount, m_DataFileSizes);
+            }
+            catch (const FileOpenFailureException& e)
+            {
+                e.PrintMessage();
+            }
+        }
+
+        for (auto& chunk: m_Chunks)
+        {
+            std::free(chunk.pData);
+        }
     }
 
     void Write(void* buffer, int64_t bufferSize)
@@ -59,68 +109,265 @@ public:
 
         const auto size = static_cast<size_t>(bufferSize);
 
+        std::memcpy(Reserve(size), buffer, size);
+        Commit(size);
+    }
+
+    void* Reserve(size_t size)
+    {
         if (size > MaxFileSize)
         {
             throw TraceException("argument 'size' is larger than MaxFileSize.");
         }
+        if (size > m_ChunkCapacity)
+        {
+            throw TraceException("argument 'size' is larger than writer buffer.");
+        }
 
-        if (m_DataSize + size > MaxFileSize)
+        // A cycle never straddles data files, so the split point is decided here rather than by the writer thread.
+        // Reserved size is used for the decision, which may close a data file slightly before MaxFileSize.
+        if (m_FileSize + size > MaxFileSize)
         {
-            FlushData();
+            CloseFile(&m_Chunks[m_FrontChunk]);
+            SubmitChunk();
+            m_FileSize = 0;
+            m_FileIndex++;
         }
+        else if (m_Chunks[m_FrontChunk].size + size > m_ChunkCapacity)
+        {
+            SubmitChunk();
+        }
+
+        auto& chunk = m_Chunks[m_FrontChunk];
+
+        m_ReservedSize = size;
+
+        return &chunk.pData[chunk.size];
+    }
 
-        std::memcpy(&m_pData[m_DataSize], buffer, size);
-        m_DataSize += size;
+    void Commit(size_t size)
+    {
+        if (size > m_ReservedSize)
+        {
+            throw TraceException("argument 'size' is larger than reserved size.");
+        }
+
+        auto& chunk = m_Chunks[m_FrontChunk];
+
+        if (m_SeekIndex.IsDue(m_CycleCount))
+        {
+            bool hasDelta;
+            BinaryCycle::Scan(&chunk.pData[chunk.size], size, &hasDelta);
+
+            if (!hasDelta)
+            {
+                m_SeekIndex.Add(m_CycleCount, m_FileIndex, m_FileSize);
+            }
+        }
+
+        // Cycle range is recorded as positions in the whole trace as the seek index does.
+        // Cycle number in basic nodes is not used because rafi-emu writes the cycle limit there.
+        if (m_FileSize == 0)
+        {
+            m_FileSummary.firstCycle = m_CycleCount;
+        }
+        m_FileSummary.lastCycle = m_CycleCount;
+
+        // Summary is made here while the cycle is still in cache, which is much cheaper than walking chunks again later.
+        if (!m_SummaryBroken)
+        {
+            try
+            {
+                BinaryCycle::AddToSummary(&chunk.pData[chunk.size], size, &m_FileSummary);
+            }
+            catch (const TraceException&)
+            {
+                // Data written by Write() may not be cycles. The data file is indexed without summary.
+                m_SummaryBroken = true;
+            }
+        }
+
+        chunk.size += size;
+        chunk.cycleCount++;
+
+        m_FileSize += size;
+        m_ReservedSize = 0;
         m_CycleCount++;
     }
 
+    bool IsSegmentEmpty() const
+    {
+        return m_FileSize == 0;
+    }
 
 private:
-    static const size_t MaxFileSize = 256 * 1024 * 1024;
+    static constexpr size_t MaxFileSize = 256 * 1024 * 1024;
+    static constexpr size_t MinChunkCapacity = 1024 * 1024;
+
+    struct Chunk
+    {
+        char* pData;
+        size_t size;
+        int cycleCount;
+        bool endOfFile;
+
+        // Valid only if endOfFile is true.
+        TraceFileSummary summary;
+        bool hasSummary;
+    };
+
+    // Marks the chunk as the last one of current data file, and hands the summary of the data file over to it.
+    void CloseFile(Chunk* pChunk)
+    {
+        pChunk->endOfFile = true;
+        pChunk->summary = m_FileSummary;
+        pChunk->hasSummary = !m_SummaryBroken;
 
-    void FlushData()
+        m_FileSummary = TraceFileSummary();
+        m_SummaryBroken = false;
+    }
+
+    // Hands the front chunk over to the writer thread and switches to the other one.
+    // Blocks while the writer thread is still busy with the other chunk.
+    void SubmitChunk()
     {
-        if (m_DataSize == 0)
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        m_ConditionVariable.wait(lock, [this] { return !m_Pending; });
+
+        if (m_Failed)
         {
-            return;
+            throw FileOpenFailureException(m_FailedPath.c_str());
         }
 
-        // Generate data file path
-        std::stringstream ss;
-        ss << m_PathBase << "." << m_DataFileCount << ".tbin";
+        m_Pending = true;
+        m_BackChunk = m_FrontChunk;
+        m_FrontChunk = 1 - m_FrontChunk;
 
-        const auto path = ss.str();
+        lock.unlock();
+        m_ConditionVariable.notify_all();
+    }
 
-        // Write data
-        auto fp = std::fopen(path.c_str(), "wb");
-        if (fp == nullptr)
+    void WriterThreadMain()
+    {
+        for (;;)
         {
-            throw FileOpenFailureException(path.c_str());
+            std::unique_lock<std::mutex> lock(m_Mutex);
+
+            m_ConditionVariable.wait(lock, [this] { return m_Pending || m_Stop; });
+
+            if (!m_Pending)
+            {
+                return;
+            }
+
+            auto& chunk = m_Chunks[m_BackChunk];
+            lock.unlock();
+
+            if (!m_Failed)
+            {
+                WriteChunk(chunk);
+            }
+
+            chunk.size = 0;
+            chunk.cycleCount = 0;
+            chunk.endOfFile = false;
+
+            lock.lock();
+            m_Pending = false;
+            lock.unlock();
+            m_ConditionVariable.notify_all();
+        }
+    }
+
+    void WriteChunk(const Chunk& chunk)
+    {
+        if (m_pDataFile == nullptr)
+        {
+            // Generate data file path
+            std::stringstream ss;
+            ss << m_PathBase << "." << m_DataFileCount << ".tbin";
+
+            m_DataFilePath = ss.str();
+
+            m_pDataFile = std::fopen(m_DataFilePath.c_str(), "wb");
+            if (m_pDataFile == nullptr)
+            {
+                m_FailedPath = m_DataFilePath;
+                m_Failed = true;
+                return;
+            }
         }
 
-        std::fwrite(m_pData, m_DataSize, 1, fp);
-        std::fclose(fp);
+        std::fwrite(chunk.pData, chunk.size, 1, m_pDataFile);
+        m_FileCycleCount += chunk.cycleCount;
+        m_DataFileSize += chunk.size;
+
+        if (chunk.endOfFile)
+        {
+            std::fclose(m_pDataFile);
+            m_pDataFile = nullptr;
+
+            // Write path and summary to index file
+            TraceIndexEntry entry;
+            entry.path = m_DataFilePath;
+            entry.cycleCount = static_cast<uint64_t>(m_FileCycleCount);
+            entry.hasSummary = chunk.hasSummary;
+            entry.summary = chunk.summary;
 
-        // Write path to index file
-        std::fprintf(m_pIndexFile, "%s %d\n", path.c_str(), m_CycleCount);
+            WriteTraceIndexEntry(m_pIndexFile, entry);
 
-        m_DataSize = 0;
-        m_CycleCount = 0;
-        m_DataFileCount++;
+            m_DataFileSizes.push_back(m_DataFileSize);
+
+            m_FileCycleCount = 0;
+            m_DataFileSize = 0;
+            m_DataFileCount++;
+        }
     }
 
     std::string m_PathBase;
     std::FILE* m_pIndexFile{ nullptr };
 
-    char* m_pData;
-    size_t m_DataSize{ 0 };
-    int m_CycleCount{ 0 };
+    // Owned by the thread calling Write()
+    Chunk m_Chunks[2] {};
+    size_t m_ChunkCapacity;
+    size_t m_FileSize{ 0 };
+    size_t m_ReservedSize{ 0 };
+    int m_FrontChunk{ 0 };
+    uint32_t m_FileIndex{ 0 };
+    uint64_t m_CycleCount{ 0 };
+    SeekIndex m_SeekIndex;
+    TraceFileSummary m_FileSummary;
+    bool m_SummaryBroken{ false };
+
+    // Owned by the writer thread
+    std::FILE* m_pDataFile{ nullptr };
+    std::string m_DataFilePath;
+    int m_FileCycleCount{ 0 };
     int m_DataFileCount{ 0 };
+    uint64_t m_DataFileSize{ 0 };
+    std::vector<uint64_t> m_DataFileSizes;
+
+    // Guarded by m_Mutex
+    int m_BackChunk{ 0 };
+    bool m_Pending{ false };
+    bool m_Stop{ false };
+    bool m_Failed{ false };
+    std::string m_FailedPath;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_ConditionVariable;
+    std::thread m_WriterThread;
 };
 
 TraceIndexWriter::TraceIndexWriter(const char* pathBase)
 {
-    m_pImpl = new TraceIndexWriterImpl(pathBase);
+    m_pImpl = new TraceIndexWriterImpl(pathBase, DefaultBufferSize);
+}
+
+TraceIndexWriter::TraceIndexWriter(const char* pathBase, size_t bufferSize)
+{
+    m_pImpl = new TraceIndexWriterImpl(pathBase, bufferSize);
 }
 
 TraceIndexWriter::~TraceIndexWriter()
@@ -133,4 +380,19 @@ void TraceIndexWriter::Write(void* buffer, int64_t size)
     m_pImpl->Write(buffer, size);
 }
 
+void* TraceIndexWriter::Reserve(size_t size)
+{
+    return m_pImpl->Reserve(size);
+}
+
+void TraceIndexWriter::Commit(size_t size)
+{
+    m_pImpl->Commit(size);
+}
+
+bool TraceIndexWriter::IsSegmentEmpty() const
+{
+    return m_pImpl->IsSegmentEmpty();
+}
+
 }}
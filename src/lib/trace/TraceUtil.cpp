@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include <rafi/trace.h>
 
 #include <boost/algorithm/string.hpp>
@@ -30,6 +33,10 @@ std::unique_ptr<trace::ITraceReader> MakeTraceReader(const std::string& path)
     {
         return std::make_unique<trace::TraceIndexReader>(path.c_str());
     }
+    else if (boost::algorithm::ends_with(path, ".tcz"))
+    {
+        return std::make_unique<trace::TraceCompressedReader>(path.c_str());
+    }
     else if (boost::algorithm::ends_with(path, ".gdb.log"))
     {
         return std::make_unique<trace::GdbTraceReader>(path.c_str());
@@ -55,4 +62,42 @@ std::unique_ptr<trace::ITracePrinter> MakeTracePrinter(PrinterType printerType,
     }
 }
 
+bool IsTraceIndexPath(const std::string& path)
+{
+    return boost::algorithm::ends_with(path, ".tidx");
+}
+
+void EnsureSeekIndex(const std::string& path)
+{
+    // Seek index is built on the first seek.
+    MakeTraceReader(path)->Next(0);
+}
+
+std::vector<CycleRange> SplitCycleRange(uint64_t begin, uint64_t end, const std::vector<uint64_t>& boundaries, uint64_t maxCycleCount)
+{
+    std::vector<CycleRange> ranges;
+
+    auto boundary = std::upper_bound(boundaries.begin(), boundaries.end(), begin);
+
+    while (begin < end)
+    {
+        auto rangeEnd = std::min(begin + maxCycleCount, end);
+
+        if (boundary != boundaries.end() && *boundary < rangeEnd)
+        {
+            rangeEnd = *boundary;
+        }
+
+        ranges.push_back(CycleRange { begin, rangeEnd });
+        begin = rangeEnd;
+
+        while (boundary != boundaries.end() && *boundary <= begin)
+        {
+            boundary++;
+        }
+    }
+
+    return ranges;
+}
+
 }}